@@ -0,0 +1,250 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "database.h"
+#include "storageestimator.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// A query of a workload: the attributes it reads together and how often
+	// it runs.
+	// =========================================================================
+	struct WorkloadQuery {
+
+		AttributeSet attributes;
+		double frequency = 1.0;
+
+	};
+
+	using Workload = std::vector<WorkloadQuery>;
+
+	// =========================================================================
+	// Cost model of a DecompositionAdvisor. A query pays "attribute_bytes"
+	// for every attribute of every row of every table it reads, and joins
+	// the tables into the largest one, paying "join_cost" for every row of
+	// every other table. Without statistics every table has one row, so
+	// costs are per row and every join costs "join_cost".
+	// =========================================================================
+	struct AdvisorCostModel {
+
+		double attribute_bytes = 8.0;		// Bytes per attribute per row.
+		double join_cost = 64.0;			// Cost of joining one row, in
+											// bytes.
+
+	};
+
+	// =========================================================================
+	// Decomposition recommended by a DecompositionAdvisor. Every table is
+	// the merge of one or more relations of the normalized relation table.
+	// =========================================================================
+	struct AdvisorRecommendation {
+
+		std::vector<std::vector<RelationTblIndex>>
+			groups;							// Relations merged into each
+											// table.
+		RelationTable relations;			// The merged tables.
+		double cost = 0.0;					// Workload cost of the tables.
+		double normalized_cost = 0.0;		// Workload cost of the
+											// normalized relation table.
+		std::size_t nodes_explored = 0;		// Search nodes visited.
+		bool budget_exhausted = false;		// Search stopped early; the
+											// tables are the best found.
+
+	};
+
+	// =========================================================================
+	// DecompositionAdvisor class that recommends how to merge, i.e.,
+	// selectively denormalize, the relations of a normalized Database so
+	// that a query workload runs with as few joins and as few bytes scanned
+	// as possible.
+	//
+	// Row counts come from the statistics of a StorageEstimator. A merged
+	// table holds one row per distinct value of the primary key that
+	// MergeRelations() gives it, and never fewer rows than its largest
+	// relation.
+	//
+	// Every grouping of the relations of a lossless decomposition is itself
+	// lossless, so the advisor searches the set partitions of
+	// "relation_table". Each query is answered by the cheapest set of tables
+	// that covers its attributes, i.e., the set minimizing bytes scanned
+	// plus join costs, which is found exactly with a small branch and
+	// bound. Partitions are enumerated as restricted growth strings,
+	// assigning one relation at a time to an existing table or to a new
+	// one, and a branch is pruned when a lower bound on its cost exceeds the
+	// best partition found. The bound lets every unassigned relation cover
+	// query attributes for free, never widen a table, and give a table no
+	// more rows than its largest relation, so it never overestimates.
+	// Branches are explored in parallel from a shared list of partition
+	// prefixes, and ties are broken towards fewer merges, so the result does
+	// not depend on the number of threads.
+	// =========================================================================
+	class DecompositionAdvisor {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_db":
+		//		Normalized Database whose relation table is advised on. Must
+		//		outlive the advisor.
+		//
+		// "_cost_model":
+		//		Costs of bytes scanned and of joins.
+		//
+		// "_search_budget":
+		//		Maximum number of search nodes visited. The best grouping
+		//		found within the budget is returned.
+		// =====================================================================
+		DecompositionAdvisor(const Database & _db,
+			AdvisorCostModel _cost_model = AdvisorCostModel(),
+			std::size_t _search_budget = 1 << 22);
+		~DecompositionAdvisor() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Adds a query to the workload.
+		//
+		// "attr_names":
+		//		Names of the attributes the query reads.
+		//
+		// "frequency":
+		//		How often the query runs, relative to the other queries.
+		//
+		// Throws std::invalid_argument if an attribute is unknown.
+		// =====================================================================
+		void AddQuery(const std::vector<std::string> & attr_names, double frequency);
+
+		// =====================================================================
+		// Searches for the cheapest grouping of the relations.
+		//
+		// "max_threads":
+		//		Maximum number of threads to spawn.
+		//
+		// Returns the recommended tables.
+		//
+		// Throws std::invalid_argument if the Database has no relations.
+		// =====================================================================
+		AdvisorRecommendation Advise(unsigned int max_threads = 1);
+
+		// =====================================================================
+		// Returns the workload.
+		// =====================================================================
+		const Workload & GetWorkload() const { return workload; };
+
+		// =====================================================================
+		// Reads a workload file. See ReadWorkload() for its format.
+		//
+		// "path":
+		//		Path of the workload file.
+		//
+		// Throws std::runtime_error if the file cannot be opened.
+		// =====================================================================
+		void LoadWorkload(const std::string & path);
+
+		// =====================================================================
+		// Prints a recommendation and the cost of every query under it.
+		//
+		// "recommendation":
+		//		Recommendation returned by Advise().
+		// =====================================================================
+		void Print(const AdvisorRecommendation & recommendation);
+
+		// =====================================================================
+		// Reads a workload. Every line holds a frequency followed by the
+		// comma-separated attributes of one query, e.g., "120 ssn,name".
+		// Empty lines and lines starting with '#' are skipped.
+		//
+		// "stream":
+		//		Stream to read until its end.
+		//
+		// Throws std::invalid_argument if a line is malformed or an
+		// attribute is unknown.
+		// =====================================================================
+		void ReadWorkload(std::istream & stream);
+
+		// =====================================================================
+		// Takes the row counts of the relations, and the distinct counts
+		// that merged tables are estimated from, from a StorageEstimator.
+		//
+		// "estimator":
+		//		StorageEstimator of the advised Database, with its
+		//		statistics loaded.
+		// =====================================================================
+		void SetStatistics(const StorageEstimator & estimator);
+
+	private:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		// Tables of a partial grouping: relation i is in table group_of[i].
+		struct Grouping {
+
+			std::vector<std::size_t> group_of;
+			std::vector<PackedAttributeSet> tables;
+			std::vector<std::size_t> widths;
+			std::vector<double> rows;		// Rows of the largest relation
+											// until EstimateRows().
+
+		};
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::vector<std::size_t> best_group_of;	// Best grouping so far.
+		double best_cost;					// Cost of best_group_of.
+		std::mutex best_mutex;				// Guards best_group_of and
+											// best_cost.
+		AdvisorCostModel cost_model;		// Costs of bytes and joins.
+		const Database & db;				// Advised database.
+		std::vector<double> distinct;		// Distinct values per attribute;
+											// 0 if unknown.
+		double global_rows;					// Rows of the global relation.
+		std::vector<PackedAttributeSet> key_closures;	// Closure of every
+														// primary key.
+		std::vector<PackedAttributeSet> keys;	// Packed primary keys.
+		double min_rows;					// Rows of the smallest relation.
+		std::atomic<std::size_t> nodes;		// Search nodes visited.
+		std::size_t num_words;				// Words per packed set.
+		std::vector<PackedAttributeSet> queries;	// Packed workload.
+		std::vector<double> relation_rows;	// Rows per relation; 1
+											// without statistics.
+		std::vector<PackedAttributeSet> relations;	// Packed relations.
+		std::size_t search_budget;			// Max search nodes.
+		std::vector<PackedAttributeSet> unassigned;	// Union of relations
+													// i.. for every i.
+		Workload workload;					// Queries to optimize for.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		void AddToTable(Grouping & grouping, std::size_t relation, std::size_t table);
+		double ComputeBound(const Grouping & grouping, std::size_t next);
+		double ComputeCoverCost(const PackedAttributeSet & uncovered, const Grouping & grouping, double scan_cost, double joined_rows, double largest_rows, double best);
+		double ComputeQueryCost(std::size_t query, const Grouping & grouping, const PackedAttributeSet & free);
+		double EstimateKeyRows(const PackedAttributeSet & key);
+		void EstimateRows(Grouping & grouping);
+		Relation MergeRelations(const std::vector<RelationTblIndex> & group);
+		void PrintAttrSet(const AttributeSet & attribute_set);
+		void Search(Grouping & grouping, std::size_t next);
+		void UpdateBest(const Grouping & grouping, double cost);
+
+	};
+
+}
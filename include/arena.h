@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Allocation counts of a normalization run. "allocations" and "bytes" 
+	// count every allocation served by the run's arenas, i.e., what would 
+	// otherwise have been individual heap allocations. "upstream_*" counts 
+	// the heap allocations the arenas actually made.
+	// =========================================================================
+	struct AllocationStats {
+
+		std::size_t allocations = 0;
+		std::size_t bytes = 0;
+		std::size_t upstream_allocations = 0;
+		std::size_t upstream_bytes = 0;
+
+		AllocationStats & operator+=(const AllocationStats & other);
+
+	};
+
+	// =========================================================================
+	// CountingResource class, a memory resource that forwards to an upstream
+	// resource and counts allocations. Not thread-safe; every thread uses 
+	// its own CountingResource.
+	// =========================================================================
+	class CountingResource : public std::pmr::memory_resource {
+
+	public:
+
+		CountingResource(std::pmr::memory_resource * _upstream) 
+			: upstream(_upstream) {};
+
+		std::size_t Allocations() const { return allocations; }
+		std::size_t Bytes() const { return bytes; }
+
+	private:
+
+		std::pmr::memory_resource * upstream;
+		std::size_t allocations = 0;
+		std::size_t bytes = 0;
+
+		void * do_allocate(std::size_t size, std::size_t alignment) override;
+		void do_deallocate(void * p, std::size_t size, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override;
+
+	};
+
+	// =========================================================================
+	// NormalizationArena class, a monotonic arena that normalization-time
+	// containers allocate from. Deallocation is a no-op and everything is 
+	// released at once when the arena is destroyed. Not thread-safe; in 
+	// multi-threaded mode every worker thread has its own arena.
+	// =========================================================================
+	class NormalizationArena {
+
+	public:
+
+		NormalizationArena();
+		NormalizationArena(const NormalizationArena &) = delete;
+		NormalizationArena & operator=(const NormalizationArena &) = delete;
+
+		std::pmr::memory_resource * Resource() { return &front; }
+		AllocationStats Stats() const;
+
+	private:
+
+		CountingResource upstream;			// Counts heap allocations.
+		std::pmr::monotonic_buffer_resource arena;
+		CountingResource front;				// Counts arena allocations.
+
+	};
+
+	// =========================================================================
+	// ScopedNormalizationResource class that makes a memory resource the 
+	// current normalization resource of the calling thread for its lifetime.
+	// =========================================================================
+	class ScopedNormalizationResource {
+
+	public:
+
+		ScopedNormalizationResource(std::pmr::memory_resource * resource);
+		~ScopedNormalizationResource();
+
+		ScopedNormalizationResource(const ScopedNormalizationResource &) = delete;
+		ScopedNormalizationResource & operator=(const ScopedNormalizationResource &) = delete;
+
+	private:
+
+		std::pmr::memory_resource * previous;
+
+	};
+
+	// =========================================================================
+	// Returns the calling thread's current normalization resource, or the 
+	// default resource if none is set.
+	// =========================================================================
+	std::pmr::memory_resource * CurrentNormalizationResource();
+
+}
@@ -18,7 +18,7 @@ namespace DbNormalizerCpp {
 	struct Attribute {
 
 		std::string name;
-		AttributeType type;
+		AttributeType type = String;
 		bool prime = false;
 
 	};
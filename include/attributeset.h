@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// HybridAttributeSet class that stores a set of attribute table indexes
+	// in roaring-style chunks, so that memory stays proportional to the size
+	// of the set however large the attribute table is, while subset and
+	// union tests run a word or a sorted run at a time.
+	//
+	// An index is split into a 16-bit chunk key (high bits) and a 16-bit
+	// low part. Chunks are kept sorted by key, and each chunk stores its low
+	// parts either as a sorted array, while it holds at most
+	// MAX_ARRAY_SIZE of them, or as a 65536-bit bitmap. A chunk switches to
+	// a bitmap when its array would grow past MAX_ARRAY_SIZE (where both
+	// take 8 KiB) and back when erasing brings it down again.
+	//
+	// The interface follows std::unordered_set, so the set is a drop-in
+	// AttributeSet, except that iteration is in ascending index order and
+	// iterators are invalidated by every insertion and erasure. It is
+	// allocator-aware: all of its chunks allocate from the memory resource
+	// it was constructed with.
+	// =========================================================================
+	class HybridAttributeSet {
+
+	public:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		using value_type = unsigned int;
+		using key_type = unsigned int;
+		using size_type = std::size_t;
+		using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+		class const_iterator;
+		using iterator = const_iterator;
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		HybridAttributeSet() : chunks(allocator_type()), num_values(0) {};
+
+		explicit HybridAttributeSet(const allocator_type & alloc)
+			: chunks(alloc), num_values(0) {};
+
+		template <typename InputIt>
+		HybridAttributeSet(InputIt first, InputIt last,
+			const allocator_type & alloc = {})
+			: chunks(alloc), num_values(0) {
+			insert(first, last);
+		};
+
+		HybridAttributeSet(std::initializer_list<value_type> values,
+			const allocator_type & alloc = {})
+			: chunks(alloc), num_values(0) {
+			insert(values.begin(), values.end());
+		};
+
+		HybridAttributeSet(const HybridAttributeSet & other)
+			: chunks(other.chunks, allocator_type()), num_values(other.num_values) {};
+
+		HybridAttributeSet(const HybridAttributeSet & other,
+			const allocator_type & alloc)
+			: chunks(other.chunks, alloc), num_values(other.num_values) {};
+
+		HybridAttributeSet(HybridAttributeSet && other) noexcept
+			: chunks(std::move(other.chunks)), num_values(other.num_values) {
+			other.num_values = 0;
+		};
+
+		HybridAttributeSet(HybridAttributeSet && other,
+			const allocator_type & alloc)
+			: chunks(std::move(other.chunks), alloc), num_values(other.num_values) {
+			other.chunks.clear();
+			other.num_values = 0;
+		};
+
+		HybridAttributeSet & operator=(const HybridAttributeSet & other) = default;
+		HybridAttributeSet & operator=(HybridAttributeSet && other) = default;
+
+		~HybridAttributeSet() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		const_iterator begin() const;
+		void clear() { chunks.clear(); num_values = 0; };
+		size_type count(value_type value) const { return Contains(value) ? 1 : 0; };
+		bool empty() const { return num_values == 0; };
+		const_iterator end() const;
+		size_type erase(value_type value);
+		const_iterator find(value_type value) const;
+		allocator_type get_allocator() const { return chunks.get_allocator(); };
+		std::pair<const_iterator, bool> insert(value_type value);
+		size_type size() const { return num_values; };
+
+		// =====================================================================
+		// Inserts every index in [first, last).
+		// =====================================================================
+		template <typename InputIt>
+		void insert(InputIt first, InputIt last) {
+			for (; first != last; ++first)
+				Insert(*first);
+		};
+
+		// =====================================================================
+		// Returns whether the set contains "value".
+		// =====================================================================
+		bool Contains(value_type value) const;
+
+		// =====================================================================
+		// Returns whether the set and "other" have at least one index in
+		// common. Compares chunk by chunk.
+		// =====================================================================
+		bool Intersects(const HybridAttributeSet & other) const;
+
+		// =====================================================================
+		// Returns whether every index in the set is also in "other".
+		// Compares chunk by chunk.
+		// =====================================================================
+		bool IsSubsetOf(const HybridAttributeSet & other) const;
+
+		// =====================================================================
+		// Returns the number of bytes allocated by the set.
+		// =====================================================================
+		size_type MemoryBytes() const;
+
+		// =====================================================================
+		// Inserts every index in "other". Merges chunk by chunk.
+		//
+		// Returns the number of indexes that were not already in the set.
+		// =====================================================================
+		size_type UnionWith(const HybridAttributeSet & other);
+
+		friend bool operator==(const HybridAttributeSet & a, const HybridAttributeSet & b);
+		friend bool operator!=(const HybridAttributeSet & a, const HybridAttributeSet & b) {
+			return !(a == b);
+		};
+
+	private:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		// =====================================================================
+		// Low parts of every index in the set with the same chunk key.
+		// Exactly one of "array" and "bitmap" is in use.
+		// =====================================================================
+		struct Chunk {
+
+			using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+			explicit Chunk(std::uint16_t _key, const allocator_type & alloc = {})
+				: key(_key), cardinality(0), array(alloc), bitmap(alloc) {};
+
+			Chunk(const Chunk & other, const allocator_type & alloc = {})
+				: key(other.key), cardinality(other.cardinality),
+				array(other.array, alloc), bitmap(other.bitmap, alloc) {};
+
+			Chunk(Chunk && other) = default;
+
+			Chunk(Chunk && other, const allocator_type & alloc)
+				: key(other.key), cardinality(other.cardinality),
+				array(std::move(other.array), alloc),
+				bitmap(std::move(other.bitmap), alloc) {};
+
+			Chunk & operator=(const Chunk & other) = default;
+			Chunk & operator=(Chunk && other) = default;
+
+			bool IsBitmap() const { return !bitmap.empty(); };
+
+			std::uint16_t key;
+			std::uint32_t cardinality;
+			std::pmr::vector<std::uint16_t> array;	// Sorted low parts.
+			std::pmr::vector<std::uint64_t> bitmap;	// BITMAP_WORDS words.
+
+		};
+
+	// =========================================================================
+	// Constants
+	// =========================================================================
+
+		static const std::size_t BITMAP_WORDS = 1024;	// 65536 bits.
+		static const std::size_t MAX_ARRAY_SIZE = 4096;	// Array <= bitmap.
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::pmr::vector<Chunk> chunks;		// Chunks sorted by key.
+		size_type num_values;				// Number of indexes.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		static bool ChunkContains(const Chunk & chunk, std::uint16_t low);
+		static bool ChunkIsSubsetOf(const Chunk & a, const Chunk & b);
+		static bool ChunksIntersect(const Chunk & a, const Chunk & b);
+		static void ToArray(Chunk & chunk);
+		static void ToBitmap(Chunk & chunk);
+		std::pmr::vector<Chunk>::const_iterator FindChunk(std::uint16_t key) const;
+		bool Insert(value_type value);
+
+	public:
+
+	// =========================================================================
+	// Iterators
+	// =========================================================================
+
+		// =====================================================================
+		// Iterates over the indexes of a HybridAttributeSet in ascending
+		// order.
+		// =====================================================================
+		class const_iterator {
+
+		public:
+
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = HybridAttributeSet::value_type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type *;
+			using reference = const value_type &;
+
+			const_iterator() : set(nullptr), chunk(0), position(0), value(0) {};
+
+			reference operator*() const { return value; };
+			pointer operator->() const { return &value; };
+
+			const_iterator & operator++() { Advance(position + 1); return *this; };
+			const_iterator operator++(int) { const_iterator old = *this; ++(*this); return old; };
+
+			bool operator==(const const_iterator & other) const {
+				return chunk == other.chunk && position == other.position;
+			};
+			bool operator!=(const const_iterator & other) const { return !(*this == other); };
+
+		private:
+
+			friend class HybridAttributeSet;
+
+			const_iterator(const HybridAttributeSet * _set, std::size_t _chunk,
+				std::uint32_t _position)
+				: set(_set), chunk(_chunk), position(0), value(0) {
+				Advance(_position);
+			};
+
+			void Advance(std::uint32_t next);
+
+			const HybridAttributeSet * set;
+			std::size_t chunk;				// Index into set->chunks.
+			std::uint32_t position;			// Array index or bit index.
+			value_type value;				// Index at the position.
+
+		};
+
+	};
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "budget.h"
+#include "types.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// BatchClosure class that computes the closures of many attribute sets
+	// at once with respect to the same functional dependencies.
+	//
+	// Queries are bit-sliced: they are processed in blocks of
+	// "BLOCK_SIZE", and every attribute holds "LANES" 64-bit words in which
+	// bit q says whether query q of the block contains the attribute. A
+	// functional dependency L -> R fires for the queries in the AND of the
+	// words of the attributes of L, and is applied by ORing them into the
+	// words of the attributes of R. One pass over the functional
+	// dependencies thus serves every query of the block, and passes repeat
+	// until no word changes. Every functional dependency remembers the
+	// queries it already fired for and never fires for them again.
+	//
+	// A BatchClosure only reads its state in Compute(), so several threads
+	// may share one.
+	// =========================================================================
+	class BatchClosure {
+
+	public:
+
+		// Words per attribute and queries per block.
+		static constexpr std::size_t LANES = 4;
+		static constexpr std::size_t BLOCK_SIZE = 64 * LANES;
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "func_dep_table":
+		//		Functional dependencies over the attributes.
+		//
+		// "_num_attributes":
+		//		Number of attributes. Every attribute table index in
+		//		"func_dep_table" and in the queries must be below it.
+		// =====================================================================
+		BatchClosure(const FuncDepTable & func_dep_table, std::size_t _num_attributes);
+		~BatchClosure() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Computes the closure of every attribute set.
+		//
+		// "attribute_sets":
+		//		Sets for which the closures will be computed.
+		//
+		// "resource":
+		//		Memory resource of the returned sets.
+		//
+		// "should_stop":
+		//		Called before every pass over the functional dependencies.
+		//		Once it returns true, the block being computed is dropped.
+		//
+		// Returns one closure per set, in the same order. Every closure
+		// includes its set. If stopped, only the closures of the blocks
+		// completed before are returned, so fewer closures than sets.
+		// =====================================================================
+		std::vector<AttributeSet> Compute(const std::vector<AttributeSet> &
+			attribute_sets, std::pmr::memory_resource * resource =
+			std::pmr::get_default_resource(), const StopPredicate &
+			should_stop = StopPredicate()) const;
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::vector<std::uint32_t> lhs_begin;	// Lhs of fd f is lhs_attrs
+		std::vector<AttributeTblIndex> lhs_attrs;	// [lhs_begin[f],
+												// lhs_begin[f + 1]).
+		std::size_t num_attributes;			// Number of attributes.
+		std::vector<std::uint32_t> rhs_begin;	// Same for the rhs.
+		std::vector<AttributeTblIndex> rhs_attrs;
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		bool ComputeBlock(std::vector<std::uint64_t> & slices, std::vector<std::uint64_t> & fired, const StopPredicate & should_stop) const;
+
+	};
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// NormalizationStatus enumeration whose values tell how a budgeted
+	// normalization run ended. Every value other than Complete means the
+	// run stopped early and left a partial relation table.
+	// =========================================================================
+	enum NormalizationStatus { Complete, DeadlineExceeded, MemoryExceeded, Cancelled };
+
+	// =========================================================================
+	// CancellationToken class that lets another thread cancel a
+	// normalization run. Copies share the same state, so the caller keeps a
+	// copy and passes another one in a NormalizationBudget.
+	// =========================================================================
+	class CancellationToken {
+
+	public:
+
+		CancellationToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {};
+
+		void Cancel() { cancelled->store(true); }
+		bool IsCancelled() const { return cancelled->load(); }
+
+	private:
+
+		std::shared_ptr<std::atomic<bool>> cancelled;
+
+	};
+
+	// =========================================================================
+	// Predicate that a long search calls between steps. Once it returns
+	// true, the search stops and returns its best partial result. May be
+	// empty, in which case the search never stops early.
+	// =========================================================================
+	using StopPredicate = std::function<bool()>;
+
+	// =========================================================================
+	// Progress of a normalization run, reported once the global relation's
+	// key and the prime attributes are found, and after every relation is
+	// normalized.
+	// =========================================================================
+	struct NormalizationProgress {
+
+		std::size_t relations_queued = 0;	// Relations queued so far.
+		std::size_t relations_done = 0;		// Relations normalized so far.
+		std::size_t keys_found = 0;			// Candidate keys found so far:
+											// of the global relation, by
+											// the prime attribute search,
+											// and of relations normalized.
+
+	};
+
+	// =========================================================================
+	// Limits of a normalization run. Limits are checked cooperatively:
+	// between every pass of the global relation's closure batches, at every
+	// step of the key and prime attribute searches of the global relation,
+	// and between relations. A run may overshoot by the time or memory it
+	// takes to normalize one relation per thread.
+	// =========================================================================
+	struct NormalizationBudget {
+
+		using Clock = std::chrono::steady_clock;
+
+		// Time by which the run stops. Unlimited by default.
+		Clock::time_point deadline = Clock::time_point::max();
+
+		// Heap bytes the run's arenas may request. 0 means unlimited.
+		std::size_t max_bytes = 0;
+
+		// Token that stops the run when cancelled.
+		CancellationToken cancellation;
+
+		// Called with the progress so far, from the normalizing threads
+		// but never concurrently. May be empty.
+		std::function<void(const NormalizationProgress &)> on_progress;
+
+	};
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "csvreader.h"
+#include "database.h"
+#include "iparser.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// CsvParser class whose use-case is to discover the functional 
+	// dependencies that hold in a .csv data file. The first row of the file
+	// names the attributes. Functional dependencies are discovered with the
+	// TANE algorithm, i.e., a level-wise search of the attribute lattice
+	// using stripped partitions. After parsing the file, a Database will be 
+	// returned initialized with a name, a universal set of attributes, and 
+	// the minimal, non-trivial functional dependencies that hold in the data.
+	//
+	// Memory can be bounded by a byte budget. Columns are then encoded in as
+	// many passes over the file as the budget requires, and the lattice
+	// search stops before a level whose partitions do not fit, as if
+	// "max_lhs_size" had been reached.
+	// =========================================================================
+	class CsvParser : public IParser {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_max_threads":
+		//		Maximum number of threads to spawn to compute partition 
+		//		products.
+		//
+		// "_max_lhs_size":
+		//		Maximum number of attributes on the lhs of a discovered 
+		//		functional dependency, or 0 for no limit.
+		//
+		// "_max_bytes":
+		//		Heap bytes that column codes, dictionaries, partitions, and
+		//		scratch tables may take at once, or 0 for no limit. Parse()
+		//		may overshoot it by one partition.
+		// =====================================================================
+		CsvParser(unsigned int _max_threads = 1, unsigned int _max_lhs_size = 0,
+			std::size_t _max_bytes = 0)
+			: max_bytes(_max_bytes), max_lhs_size(_max_lhs_size),
+			max_threads(_max_threads) {};
+		~CsvParser() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns the number of passes over the file the last call to
+		// Parse() made to encode the columns.
+		// =====================================================================
+		std::size_t ColumnPasses() const { return column_passes; };
+
+		// =====================================================================
+		// Returns whether the byte budget stopped the lattice search of the
+		// last call to Parse(). Functional dependencies with lhs larger
+		// than the last level searched are then missing.
+		// =====================================================================
+		bool LatticeTruncated() const { return lattice_truncated; };
+
+		// =====================================================================
+		// Opens a .csv file. The name of the file without its directory and
+		// extension is used as the name of the parsed Database.
+		// 
+		// "fileName":
+		//		Name of the file to open.
+		// =====================================================================
+		void Open(std::string fileName);
+
+		// =====================================================================
+		// Parses .csv file and creates a Database object.
+		//
+		// Returns a Database initialized with name, universal set of 
+		// attributes, and set of discovered functional dependencies.
+		//
+		// Throws std::runtime_error if the file is malformed, or if a
+		// single column does not fit in the byte budget.
+		// =====================================================================
+		Database Parse();
+
+	private:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		using AttributeMask = std::uint64_t;
+
+		// =====================================================================
+		// Stripped partition of the rows by the values of an attribute set.
+		// Equivalence classes of size 1 are stripped. Classes are stored 
+		// back to back in "rows", and class i is 
+		// [offsets[i], offsets[i + 1]).
+		// =====================================================================
+		struct StrippedPartition {
+
+			std::vector<RowIndex> rows;
+			std::vector<RowIndex> offsets = { 0 };
+
+			std::size_t NumClasses() const { return offsets.size() - 1; }
+
+			// ||p|| - |p|. Two attribute sets X and XA have the same error 
+			// iff X -> A holds.
+			std::size_t Error() const { return rows.size() - NumClasses(); }
+
+			// Heap bytes of the rows and offsets.
+			std::size_t Bytes() const { return (rows.capacity() + offsets.capacity()) * sizeof(RowIndex); }
+
+		};
+
+		// =====================================================================
+		// An attribute set in the lattice together with its stripped 
+		// partition and its set of rhs candidates, C+(X). Nodes of level 1
+		// share the partitions of "column_partitions".
+		// =====================================================================
+		struct LatticeNode {
+
+			std::shared_ptr<const StrippedPartition> partition;
+			AttributeMask rhs_candidates = 0;
+
+		};
+
+		using Level = std::unordered_map<AttributeMask, LatticeNode>;
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::size_t column_partition_bytes = 0;	// Bytes of
+											// column_partitions.
+
+		std::size_t column_passes = 0;		// Passes to encode the columns.
+
+		std::vector<std::shared_ptr<const StrippedPartition>>
+			column_partitions;				// Partition of every single 
+											// attribute, i.e., of level 1.
+
+		std::string db_name;				// Name of the parsed database.
+		bool lattice_truncated = false;		// Budget stopped the lattice.
+		std::size_t max_bytes;				// Max heap bytes, or 0.
+		unsigned int max_lhs_size;			// Max size of a discovered lhs.
+		unsigned int max_threads;			// Max threads for products.
+		std::size_t num_rows = 0;			// Number of data rows parsed.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		void AddFuncDep(Database & db, const std::vector<std::string> & attr_names, AttributeMask lhs, unsigned int rhs);
+		void ComputeDependencies(Database & db, const std::vector<std::string> & attr_names, Level & level, const Level & previous_level, std::size_t empty_set_error);
+		std::size_t EncodeColumns(CsvReader & reader, const std::vector<std::string> & attr_names, std::size_t first);
+		Level GenerateNextLevel(const Level & level, std::size_t held_bytes);
+		static std::size_t LevelBytes(const Level & level);
+		StrippedPartition MultiplyPartitions(const StrippedPartition & a, const StrippedPartition & b, std::vector<int> & scratch_table, std::vector<std::vector<RowIndex>> & scratch_classes);
+		StrippedPartition PartitionColumn(const std::vector<ValueCode> & column, std::size_t num_values);
+		void Prune(Database & db, const std::vector<std::string> & attr_names, Level & level, const Level & previous_level, std::size_t empty_set_error);
+		static std::vector<AttributeMask> SortedMasks(const Level & level);
+
+	};
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "types.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// CsvReader class that reads rows from a .csv stream one at a time. 
+	// Fields may be quoted with '"', in which case they may contain the
+	// delimiter, line breaks, and escaped quotes ("").
+	// =========================================================================
+	class CsvReader {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		CsvReader(std::istream & _stream, char _delimiter = ',');
+		~CsvReader() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Reads the next row.
+		//
+		// "fields":
+		//		Cleared and filled with the fields of the next row.
+		//
+		// Returns false if the end of the stream has been reached.
+		// =====================================================================
+		bool ReadRow(std::vector<std::string> & fields);
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		char delimiter;						// Field delimiter.
+		std::istream & stream;				// Stream rows are read from.
+
+	};
+
+	// =========================================================================
+	// ColumnDictionary class that dictionary-encodes the values of a column.
+	// Equal values always get equal codes, and codes are dense, i.e., the
+	// n-th distinct value gets code n - 1.
+	// =========================================================================
+	class ColumnDictionary {
+
+	public:
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns the code for "value", assigning the next code if "value" 
+		// has not been seen before.
+		// =====================================================================
+		ValueCode Encode(const std::string & value);
+
+		// =====================================================================
+		// Returns an estimate of the heap bytes of the distinct values and
+		// of the map entries that hold them.
+		// =====================================================================
+		std::size_t Bytes() const { return bytes; }
+
+		// =====================================================================
+		// Returns the number of distinct values seen.
+		// =====================================================================
+		std::size_t Size() const { return codes.size(); }
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::size_t bytes = 0;				// Estimated heap bytes.
+		std::unordered_map<std::string, ValueCode> codes;
+
+	};
+
+}
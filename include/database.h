@@ -1,9 +1,17 @@
 #pragma once
 
+#include <ostream>
 #include <string>
+#include <vector>
 
+#include "arena.h"
 #include "attribute.h"
+#include "batchclosure.h"
+#include "budget.h"
+#include "packedfuncdeps.h"
 #include "relation.h"
+#include "schemapartition.h"
+#include "tracer.h"
 #include "types.h"
 
 namespace DbNormalizerCpp {
@@ -13,7 +21,7 @@ namespace DbNormalizerCpp {
 	// form of the database. In other words, NormalForm::One means 1NF, 
 	// NormalForm::Bcnf means BCNF, etc.
 	// =========================================================================
-	enum NormalForm { One, Two, Three, Bcnf };
+	enum NormalForm { One, Two, Three, Bcnf, Four };
 
 	// =========================================================================
 	// Database class that represents a database as specified in the
@@ -23,6 +31,10 @@ namespace DbNormalizerCpp {
 	// =========================================================================
 	class Database {
 
+		friend class DifferentialOracle;
+		friend class RelationStream;
+		friend class ResultCache;
+
 	public:
 
 	// =========================================================================
@@ -36,20 +48,86 @@ namespace DbNormalizerCpp {
 	// Member functions
 	// =========================================================================
 
+		// =====================================================================
+		// Computes the closures of many sets of attributes with respect to
+		// the functional dependency table at once. Much faster than one
+		// closure at a time when there are many sets; see BatchClosure.
+		//
+		// "attribute_sets":
+		//		Sets of attributes for which the closures will be computed.
+		//
+		// Returns one closure per set, in the same order. Every closure
+		// includes its set.
+		// =====================================================================
+		std::vector<AttributeSet> ComputeClosuresOf(const std::vector<AttributeSet> & attribute_sets) const;
+
+		// =====================================================================
+		// Determines which functional dependencies are not preserved by the
+		// decomposition in "relation_table". Uses the restricted closure
+		// algorithm, i.e., for X -> Y, repeatedly grows Z = X by
+		// (Z n Ri)* n Ri for every relation Ri until Z stops changing. X -> Y
+		// is preserved iff Y is a subset of Z. Projections of the
+		// functional dependencies are never computed.
+		//
+		// "max_threads":
+		//		Maximum number of threads to spawn to check functional 
+		//		dependencies.
+		//
+		// Returns the indexes into the functional dependency table of all
+		// functional dependencies that are lost, in ascending order.
+		// =====================================================================
+		FuncDepTblIndexList FindLostFuncDeps(unsigned int max_threads = 1);
+
+		// =====================================================================
+		// Returns the allocation counts of the last normalization run.
+		// =====================================================================
+		const AllocationStats & GetAllocationStats() const { return allocation_stats; }
+
+		// =====================================================================
+		// Returns this database's attribute table.
+		// =====================================================================
+		const AttributeTable & GetAttributeTable() const { return attribute_table; }
+
+		// =====================================================================
+		// Returns this database's functional dependency table.
+		// =====================================================================
+		const FuncDepTable & GetFuncDepTable() const { return func_dep_table; }
+
+		// =====================================================================
+		// Returns this database's multivalued dependency table.
+		// =====================================================================
+		const MultiValuedDepTable & GetMultiValuedDepTable() const { return mvd_table; }
+
+		// =====================================================================
+		// Returns this database's name.
+		// =====================================================================
+		const std::string & GetName() const { return name; }
+
+		// =====================================================================
+		// Returns this database's relation table.
+		// =====================================================================
+		const RelationTable & GetRelationTable() const { return relation_table; }
+
 		// =====================================================================
 		// Inserts an attribute into this database.
 		//
 		// "attr_name":
 		//		The name of the attribute to insert.
 		//
+		// "type":
+		//		The type of the attribute's values.
+		//
 		// Side effects:
 		//		An attribute is inserted into private data member 
 		//		"attribute_table", increasing its size by 1.
 		// =====================================================================
-		void InsertAttribute(const std::string & attr_name);
+		void InsertAttribute(const std::string & attr_name, AttributeType type = String);
 
 		// =====================================================================
-		// Inserts functional dependency into this database.
+		// Inserts functional dependency into this database in canonical 
+		// form. Rhs attributes that are also in the lhs are dropped, and a
+		// functional dependency whose lhs is already in "func_dep_table" is
+		// merged into the existing entry, so every lhs is stored once.
 		// 
 		// "func_dep":
 		//		The functional dependency to insert.
@@ -60,17 +138,90 @@ namespace DbNormalizerCpp {
 		//
 		// Side effects:
 		//		A functional dependency is inserted into private data member
-		//		"func_dep_table", increasing its size by 1.
+		//		"func_dep_table" or merged into one of its entries. Nothing is
+		//		inserted if the functional dependency is trivial.
+		//
+		// Throws std::invalid_argument if an attribute is not in the 
+		// attribute table.
 		// =====================================================================
 		void InsertFuncDep(SimpleFuncDep & func_dep);
 
+		// =====================================================================
+		// Inserts multivalued dependency into this database.
+		// 
+		// "mvd":
+		//		The multivalued dependency to insert, i.e., the names of the
+		//		attributes on the lhs and rhs of lhs ->> rhs.
+		//
+		// Precondition: 
+		//		The attribute table is populated with the attributes referenced
+		//		in the mvd.
+		//
+		// Side effects:
+		//		A multivalued dependency is inserted into private data member
+		//		"mvd_table", increasing its size by 1.
+		// =====================================================================
+		void InsertMultiValuedDep(SimpleFuncDep & mvd);
+
+		// =====================================================================
+		// Normalizes database to 2NF or 4NF one independent component at a
+		// time. The schema is split into the connected components of its
+		// attribute/dependency hypergraph (see SchemaPartition), each
+		// component is normalized as a database of its own, and components
+		// are normalized in parallel. The relations of every component are
+		// merged into "relation_table", followed by a linking relation made
+		// of a candidate key of every component and of the attributes that
+		// appear in no dependency, which keeps the decomposition lossless.
+		//
+		// A schema with a single component, or a database that already has
+		// relations, is normalized as a whole instead.
+		//
+		// "target":
+		//		NormalForm::Two or NormalForm::Four.
+		//
+		// "max_threads":
+		//		Maximum number of threads to spawn. Components are handed to
+		//		up to "max_threads" workers, largest first, and leftover
+		//		threads are shared by the components' own normalization.
+		//
+		// Throws std::invalid_argument if "target" is neither 2NF nor 4NF.
+		// =====================================================================
+		void NormalizeComponents(NormalForm target, unsigned int max_threads = 1);
+
 		// =====================================================================
 		// Normalizes database to 2NF.
 		//
 		// "max_threads": 
-		//		Maximum number of threads to spawn to normalize to 2NF.
+		//		Maximum number of threads to spawn to normalize to 2NF. 0 is
+		//		treated as 1.
 		// =====================================================================
 		void NormalizeTo2nf(unsigned int max_threads = 1);
+
+		// =====================================================================
+		// Normalizes database to 2NF within a budget. When the deadline 
+		// passes, the memory budget is exceeded, or the run is cancelled,
+		// no more relations are normalized and "relation_table" holds the
+		// best partial result: the relations already in 2NF and the
+		// relations still queued, which together are a lossless 
+		// decomposition. Calling it again resumes from that partial result.
+		// The budget also stops the searches that run before any relation
+		// is queued: a global relation whose closure is cut short is
+		// dropped, so "relation_table" stays empty, while the key and
+		// prime attribute searches keep the best result found so far.
+		//
+		// "budget":
+		//		Deadline, memory budget, cancellation token, and progress
+		//		callback of the run.
+		//
+		// "max_threads": 
+		//		Maximum number of threads to spawn to normalize to 2NF. 0 is
+		//		treated as 1.
+		//
+		// Returns Complete if the database is in 2NF, or why the run
+		// stopped early.
+		// =====================================================================
+		NormalizationStatus NormalizeTo2nf(const NormalizationBudget & budget,
+			unsigned int max_threads = 1);
 			
 		// =====================================================================
 		// Normalizes database to 3NF.
@@ -80,11 +231,78 @@ namespace DbNormalizerCpp {
 		// =====================================================================
 		void NormalizeTo3nf(unsigned int max_threads = 1);
 
+		// =====================================================================
+		// Normalizes database to 4NF. Starts from the relations already in
+		// "relation_table", or from the global relation if there are none.
+		// A relation is decomposed on X ->> Y whenever X is not a superkey
+		// of it and Y is a block of the dependency basis of X that is not
+		// trivial within the relation. Functional dependencies X -> A take 
+		// part as X ->> A.
+		//
+		// "max_threads": 
+		//		Maximum number of threads to spawn to normalize to 4NF. 0 is
+		//		treated as 1.
+		// =====================================================================
+		void NormalizeTo4nf(unsigned int max_threads = 1);
+
+		// =====================================================================
+		// Normalizes database to 4NF within a budget. See the budgeted
+		// NormalizeTo2nf() for how a run stops early and resumes.
+		//
+		// "budget":
+		//		Deadline, memory budget, cancellation token, and progress
+		//		callback of the run.
+		//
+		// "max_threads": 
+		//		Maximum number of threads to spawn to normalize to 4NF. 0 is
+		//		treated as 1.
+		//
+		// Returns Complete if the database is in 4NF, or why the run
+		// stopped early.
+		// =====================================================================
+		NormalizationStatus NormalizeTo4nf(const NormalizationBudget & budget,
+			unsigned int max_threads = 1);
+
 		// =====================================================================
 		// Prints database.
 		// =====================================================================
 		void Print();
 
+		// =====================================================================
+		// Prints database to a stream.
+		//
+		// "stream":
+		//		Stream to print to.
+		// =====================================================================
+		void Print(std::ostream & stream);
+
+		// =====================================================================
+		// Prints one relation of this database, e.g., one handed out by a
+		// RelationStream.
+		//
+		// "stream":
+		//		Stream to print to.
+		//
+		// "relation":
+		//		Relation over this database's attributes.
+		// =====================================================================
+		void Print(std::ostream & stream, const Relation & relation);
+
+		// =====================================================================
+		// Prints the allocation counts of the last normalization run.
+		// =====================================================================
+		void PrintAllocationStats();
+
+		// =====================================================================
+		// Prints the functional dependencies that are not preserved by the
+		// decomposition in "relation_table".
+		//
+		// "max_threads":
+		//		Maximum number of threads to spawn to check functional 
+		//		dependencies.
+		// =====================================================================
+		void PrintLostFuncDeps(unsigned int max_threads = 1);
+
 		// =====================================================================
 		// Sets name of database.
 		//
@@ -93,12 +311,28 @@ namespace DbNormalizerCpp {
 		// =====================================================================
 		void SetName(const std::string & _name);
 
+		// =====================================================================
+		// Sets the tracer that records normalization events: the global 
+		// relation and its closure batches, prime attribute
+		// marking, every RelationToXnf() call, queue pushes and pops, and
+		// steals, i.e., a worker popping a relation queued by another 
+		// worker. Tracing costs one null check per event when disabled.
+		//
+		// "_tracer":
+		//		Tracer to record to, or null to disable tracing. Must outlive
+		//		every normalization run that records to it.
+		// =====================================================================
+		void SetTracer(Tracer * _tracer);
+
 	private:
 		
 	// =========================================================================
 	// Data members
 	// =========================================================================
 
+		AllocationStats allocation_stats;	// Allocation counts of the last
+											// normalization run.
+
 		AttributeIndexMap					// Map of attribute names to indexes
 			attribute_index_map;			// of attribute objects in												
 											// attribute_table.
@@ -107,6 +341,23 @@ namespace DbNormalizerCpp {
 
 		FuncDepTable func_dep_table;		// Collection of functional 
 											// dependencies.
+
+		LhsIndexMap lhs_index_map;			// Map of functional dependency 
+											// lhs to indexes in 
+											// func_dep_table.
+
+		MultiValuedDepTable mvd_table;		// Collection of multivalued
+											// dependencies.
+
+		PackedFuncDepTable					// func_dep_table packed for the
+			packed_func_dep_table;			// key and prime attribute
+											// searches, only while
+											// normalizing.
+
+		bool packed_func_dep_table_stale;	// func_dep_table or
+											// attribute_table changed since
+											// packed_func_dep_table was
+											// built.
 			
 		static const std::string			// Name of global relation.
 			GLOBAL_RELATION_NAME;					
@@ -121,41 +372,92 @@ namespace DbNormalizerCpp {
 		AttributeTblIndex table_index;		// Next available index into 
 											// attribute table.
 
+		Tracer * tracer;					// Records events, or null.
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		using RelationStep = RelationTable (Database::*)(Relation &);
+
+		// Closure of one functional dependency's lhs in the global relation.
+		struct GblClosureResult {
+			AttributeSetClosure closure;
+			bool is_candidate_key;
+		};
+
+		using GblClosureBuffer = std::pmr::vector<GblClosureResult>;
+
+		// State of one budgeted normalization run.
+		struct NormalizationRun {
+
+			NormalizationRun(const NormalizationBudget & _budget,
+				NormalizationArena & _arena)
+				: budget(_budget), arena(_arena) {};
+
+			const NormalizationBudget & budget;
+			NormalizationArena & arena;		// Arena of the queue.
+			std::size_t worker_bytes = 0;	// Heap bytes of worker arenas.
+			NormalizationProgress progress;
+			NormalizationStatus status = Complete;
+
+		};
+
 	// =========================================================================
 	// Member functions
 	// =========================================================================
 
-		void AppendToFuncDep(SimpleFuncDep & func_dep, AttributeSet & attribute_set, bool lhs);
-		void AssignPrimaryKey(Relation & relation);
+		void AppendToFuncDep(const SimpleFuncDep & func_dep, AttributeSet & attribute_set, bool lhs);
+		void AssignPrimaryKey(Relation & relation, const StopPredicate & should_stop = StopPredicate());
+		void BuildComponentDatabase(const SchemaPartition & partition, std::size_t component, const std::vector<AttributeTblIndex> & local_index, Database & component_db);
+		NormalizationStatus CheckBudget(const NormalizationRun & run, std::size_t extra_bytes = 0);
+		void CheckFuncDepPreservation(unsigned int first, unsigned int stride, std::vector<char> & preserved);
 		void ComputeAttributeSetClosure(FuncDepTblIndex fd_tbl_index, Relation & relation);
 		void ComputeClosure(Relation & relation);
+		void ComputeCandidateKey(Relation & relation);
+		AttributeSet ComputeClosureOf(const AttributeSet & attributes);
+		DependencyBasis ComputeDependencyBasis(const AttributeSet & attributes);
 		void ComputeFuncDepSetClosure(Relation & relation);
-		void ComputeGblAttributeSetClosure(FuncDepTblIndex fd_tbl_index, GlobalRelation & gbl_relation);
-		void ComputeGblFuncDepSetClosure(GlobalRelation & gbl_relation);
-		GlobalRelation GenerateGlobalRelation();
+		bool ComputeGblClosureRange(FuncDepTblIndex first, FuncDepTblIndex last, const GlobalRelation & gbl_relation, const BatchClosure & batch, GblClosureBuffer & buffer, const StopPredicate & should_stop);
+		NormalizationStatus ComputeGblFuncDepSetClosure(GlobalRelation & gbl_relation, unsigned int max_threads = 1, NormalizationRun * run = nullptr);
+		GlobalRelation GenerateGlobalRelation(unsigned int max_threads = 1, NormalizationRun * run = nullptr);
+		const PackedFuncDepTable & GetPackedFuncDepTable();
 		bool IsPartialPrimaryKey(AttributeSet & attributes, Relation & relation);
-		bool IsSubsetOf(AttributeSet & a, AttributeSet & b);
+		bool IsFuncDepPreserved(FuncDepTblIndex fd_tbl_index);
+		bool IsSubsetOf(const AttributeSet & a, const AttributeSet & b);
+		void KeepQueuedRelations(NormalizationQueue & normalization_queue);
 		AttributeTblIndex LookUpAttributeTblIndex(const std::string & attr_name);
-		void MarkPrimeAttributes();
-		RelationTable MultiThreaded2nf(NormalizationQueue & normalization_queue, unsigned int max_threads);
+		void MarkPrimeAttributes(NormalizationRun * run = nullptr);
+		void MergeComponentRelations(const Database & component_db, const SortedAttributeList & attributes, const FuncDepTblIndexList & func_deps, const AttributeSet & link_attributes);
+		void MultiThreaded2nf(NormalizationQueue & normalization_queue, unsigned int max_threads, NormalizationRun & run);
 		RelationTable MultiThreaded3nf(NormalizationQueue & normalization_queue, unsigned int max_threads);
-		void PrintName();
-		void PrintAttributeFromIndex(AttributeTblIndex index, bool verbose);
-		void PrintAttribute(const Attribute & attribute, bool verbose);
-		void PrintAttrSet(const AttributeSet & attribute_set);
-		void PrintFuncDep(const FuncDep & func_dep);
-		void PrintAttributeSetClosure(const AttributeSetClosure & attribute_set_closure);
-		void PrintFuncDepSetClosure(const FuncDepSetClosure & func_dep_set_closure);
-		void PrintAttrTable();
-		void PrintCandidateKeyList(const CandidateKeyList & ck_list);
-		void PrintRelation(const Relation & relation);
-		void PrintFuncDepTable();
-		void PrintRelationTable();
+		void MultiThreaded4nf(NormalizationQueue & normalization_queue, unsigned int max_threads, NormalizationRun & run);
+		void MultiThreadedNormalize(NormalizationQueue & normalization_queue, unsigned int max_threads, RelationStep relation_step, NormalizationRun & run);
+		void NameRelation(Relation & relation);
+		void PrintName(std::ostream & stream);
+		void PrintAttributeFromIndex(std::ostream & stream, AttributeTblIndex index, bool verbose);
+		void PrintAttribute(std::ostream & stream, const Attribute & attribute, bool verbose);
+		void PrintAttrSet(std::ostream & stream, const AttributeSet & attribute_set);
+		void PrintFuncDep(std::ostream & stream, const FuncDep & func_dep);
+		void PrintAttributeSetClosure(std::ostream & stream, const AttributeSetClosure & attribute_set_closure);
+		void PrintFuncDepSetClosure(std::ostream & stream, const FuncDepSetClosure & func_dep_set_closure);
+		void PrintAttrTable(std::ostream & stream);
+		void PrintCandidateKeyList(std::ostream & stream, const CandidateKeyList & ck_list);
+		void PrintRelation(std::ostream & stream, const Relation & relation);
+		void PrintFuncDepTable(std::ostream & stream);
+		void PrintMultiValuedDepTable(std::ostream & stream);
+		void PrintRelationTable(std::ostream & stream);
 		void QueuePreNormalizedRelations(NormalizationQueue & normalization_queue);
+		void RecordNormalizedRelation(NormalizationRun & run, const RelationTable & decomposed_relations);
+		void ReleasePackedFuncDepTable();
+		void ReportProgress(const NormalizationRun & run);
 		RelationTable RelationTo2nf(Relation & relation);
 		RelationTable RelationTo3nf(Relation & relation);
-		void SingleThreaded2nf(NormalizationQueue & normalization_queue);
+		RelationTable RelationTo4nf(Relation & relation);
+		void SingleThreaded2nf(NormalizationQueue & normalization_queue, NormalizationRun & run);
 		RelationTable SingleThreaded3nf(NormalizationQueue & normalization_queue);
+		void SingleThreaded4nf(NormalizationQueue & normalization_queue, NormalizationRun & run);
+		void SingleThreadedNormalize(NormalizationQueue & normalization_queue, RelationStep relation_step, NormalizationRun & run);
 
 };
 
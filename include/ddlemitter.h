@@ -0,0 +1,121 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Foreign key of a relation: "columns" of "relation" reference the
+	// primary key of "referenced", which consists of the same attributes.
+	// =========================================================================
+	struct DdlForeignKey {
+
+		RelationTblIndex relation = 0;
+		RelationTblIndex referenced = 0;
+		SortedAttributeList columns;
+
+	};
+
+	// =========================================================================
+	// Secondary index on "columns" of "relation".
+	// =========================================================================
+	struct DdlIndex {
+
+		RelationTblIndex relation = 0;
+		SortedAttributeList columns;
+
+	};
+
+	// =========================================================================
+	// DdlEmitter class that turns the relation table of a normalized
+	// Database into an SQL DDL script: a CREATE TABLE statement for every
+	// relation with its primary key and its other candidate keys as UNIQUE
+	// constraints, the foreign keys between the relations, and the
+	// secondary indexes their joins need.
+	//
+	// The access paths are derived from the decomposition itself. The
+	// attributes two relations share are the columns they are joined on
+	// when the decomposition is reassembled, so
+	//
+	//	*	a relation whose shared attributes contain the whole primary key
+	//		of the other relation gets a foreign key to it, unless both have
+	//		the same primary key, and
+	//	*	every relation gets an index on the attributes it shares with
+	//		each other relation, unless a key constraint already has them as
+	//		its leading columns.
+	//
+	// Foreign keys are added with ALTER TABLE after every table is created,
+	// so the statements need no particular order. The script uses standard
+	// SQL and quotes identifiers that are not plain SQL names.
+	// =========================================================================
+	class DdlEmitter {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// Derives the foreign keys and indexes of a Database.
+		//
+		// "_db":
+		//		Normalized Database whose relation table is emitted. Must
+		//		outlive the emitter.
+		// =====================================================================
+		DdlEmitter(const Database & _db);
+		~DdlEmitter() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Writes the DDL script.
+		//
+		// "stream":
+		//		Stream to write to.
+		// =====================================================================
+		void Emit(std::ostream & stream);
+
+		// =====================================================================
+		// Returns the foreign keys, ordered by relation and then by the
+		// referenced relation.
+		// =====================================================================
+		const std::vector<DdlForeignKey> & GetForeignKeys() const { return foreign_keys; };
+
+		// =====================================================================
+		// Returns the secondary indexes, ordered by relation and then by
+		// columns.
+		// =====================================================================
+		const std::vector<DdlIndex> & GetIndexes() const { return indexes; };
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		const Database & db;				// Emitted database.
+		std::vector<DdlForeignKey>
+			foreign_keys;					// Derived foreign keys.
+		std::vector<DdlIndex> indexes;		// Derived secondary indexes.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		std::string ColumnList(const SortedAttributeList & columns);
+		void DeriveAccessPaths();
+		void EmitCreateTable(std::ostream & stream, RelationTblIndex relation);
+		bool HasKeyPrefix(RelationTblIndex relation, const SortedAttributeList & columns);
+		std::string Identifier(const std::string & name);
+		std::string TypeName(AttributeType type);
+
+	};
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Result of comparing the functional dependencies of two databases, A
+	// and B. Attributes are matched by name, and functional dependencies
+	// are given by attribute names, since the attribute tables of A and B
+	// may differ.
+	// =========================================================================
+	struct FuncDepComparison {
+
+		std::vector<std::string> only_in_a;			// Attributes only in A.
+		std::vector<std::string> only_in_b;			// Attributes only in B.
+		std::vector<SimpleFuncDep> not_implied_by_a;// B's dependencies A misses.
+		std::vector<SimpleFuncDep> not_implied_by_b;// A's dependencies B misses.
+		std::size_t closures_computed = 0;
+
+		bool Equivalent() const {
+			return not_implied_by_a.empty() && not_implied_by_b.empty();
+		}
+
+	};
+
+	// =========================================================================
+	// FuncDepComparer class that checks whether the functional dependencies
+	// of two databases imply each other, i.e., have the same closure, and
+	// reports what differs in each direction.
+	//
+	// A functional dependency X -> Y of A is implied by B if Y is in the
+	// closure of X under B's functional dependencies. The closures of all
+	// lhs's are computed in one batch on up to "max_threads" threads, each
+	// with its own scratch buffers. Closures run in time linear in the size
+	// of the functional dependencies: every dependency counts the lhs
+	// attributes not yet in the closure and fires when the count reaches 0.
+	//
+	// The dependencies X -> A of A whose attribute A is not implied by B
+	// are then reduced to a nonredundant set: in order, one is dropped if B
+	// plus the ones still kept imply it. Adding the result to B makes B
+	// imply all of A, and no dependency of the result can be left out.
+	// Attributes of one database only are never implied by the other.
+	// =========================================================================
+	class FuncDepComparer {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_a":
+		//		First database, e.g., the old version of a schema. Must
+		//		outlive the FuncDepComparer.
+		//
+		// "_b":
+		//		Second database, e.g., the new version of a schema. Must
+		//		outlive the FuncDepComparer.
+		//
+		// "_max_threads":
+		//		Maximum number of threads to spawn to compute closures.
+		// =====================================================================
+		FuncDepComparer(const Database & _a, const Database & _b,
+			unsigned int _max_threads = 1);
+		~FuncDepComparer() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Compares the functional dependencies in both directions.
+		//
+		// Returns the comparison.
+		// =====================================================================
+		FuncDepComparison Compare();
+
+		// =====================================================================
+		// Prints a comparison.
+		//
+		// "comparison":
+		//		Comparison returned by Compare().
+		// =====================================================================
+		void Print(const FuncDepComparison & comparison);
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		const Database & a;					// First database.
+		const Database & b;					// Second database.
+		unsigned int max_threads;			// Max threads to spawn.
+		std::vector<std::string> names;		// Attributes of A, then the
+											// attributes of B only.
+		AttributeIndexMap name_index;		// Index of every name.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		std::vector<SimpleFuncDep> FindNotImplied(const Database & from, const Database & to, std::size_t & closures_computed);
+		void PrintAttrNames(const std::vector<std::string> & attr_names);
+		std::vector<AttributeTblIndex> Translate(const Database & db, const AttributeSet & attribute_set);
+
+	};
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <istream>
+#include <vector>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// A row that violates a functional dependency, together with the earlier
+	// row it conflicts with, i.e., a row with the same lhs values but 
+	// different rhs values. Rows are numbered from 1, not counting the 
+	// header row.
+	// =========================================================================
+	struct FuncDepViolation {
+
+		std::size_t row;
+		std::size_t conflicting_row;
+
+	};
+
+	// =========================================================================
+	// Result of validating one functional dependency against a data file.
+	// =========================================================================
+	struct FuncDepValidationResult {
+
+		FuncDepTblIndex fd_tbl_index;
+		std::size_t rows_checked = 0;
+		std::size_t violating_rows = 0;
+		std::vector<FuncDepViolation> violations;	// First violations only.
+
+		double ViolationRate() const {
+			return rows_checked == 0 ? 0.0 
+				: static_cast<double>(violating_rows) / rows_checked;
+		}
+
+	};
+
+	using FuncDepValidationResultList = std::vector<FuncDepValidationResult>;
+
+	// =========================================================================
+	// FuncDepValidator class that verifies that the functional dependencies
+	// declared in a Database hold in a .csv data file. The first row of the
+	// file names the columns, which must include every attribute referenced
+	// by a functional dependency.
+	//
+	// The file is streamed once and every functional dependency is checked 
+	// at the same time. Each referenced column is dictionary-encoded once 
+	// and the codes are shared by all functional dependencies. Each 
+	// functional dependency keeps a hash map from lhs codes to rhs codes, so 
+	// memory grows with the number of distinct lhs values rather than the
+	// number of rows.
+	// =========================================================================
+	class FuncDepValidator {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_db":
+		//		Database whose functional dependencies are validated. Must 
+		//		outlive the FuncDepValidator.
+		//
+		// "_max_threads":
+		//		Maximum number of threads to spawn to encode columns and check
+		//		functional dependencies.
+		//
+		// "_max_reported_violations":
+		//		Maximum number of violations recorded per functional 
+		//		dependency. All violations are counted regardless.
+		// =====================================================================
+		FuncDepValidator(const Database & _db, unsigned int _max_threads = 1,
+			std::size_t _max_reported_violations = 10)
+			: db(_db), max_reported_violations(_max_reported_violations),
+			max_threads(_max_threads) {};
+		~FuncDepValidator() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Prints validation results.
+		//
+		// "results":
+		//		Results returned by Validate().
+		// =====================================================================
+		void Print(const FuncDepValidationResultList & results);
+
+		// =====================================================================
+		// Validates every functional dependency against a .csv stream.
+		//
+		// "stream":
+		//		Stream that contains the .csv data.
+		//
+		// Returns one result per functional dependency, in functional 
+		// dependency table order.
+		// =====================================================================
+		FuncDepValidationResultList Validate(std::istream & stream);
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		const Database & db;				// Database to validate.
+		std::size_t max_reported_violations;// Max violations per result.
+		unsigned int max_threads;			// Max threads to spawn.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		void PrintAttrSet(const AttributeSet & attribute_set);
+
+	};
+
+}
@@ -3,6 +3,8 @@
 #include <fstream>
 #include <string>
 
+#include "tracer.h"
+
 namespace DbNormalizerCpp {
 
 	// =========================================================================
@@ -45,6 +47,15 @@ namespace DbNormalizerCpp {
 		// =====================================================================
 		virtual void Close() { fileStream.close(); }
 
+		// =====================================================================
+		// Sets the tracer that records the parse. The parsed Database
+		// records to the same tracer.
+		//
+		// "_tracer":
+		//		Tracer to record to, or null to disable tracing.
+		// =====================================================================
+		void SetTracer(Tracer * _tracer) { tracer = _tracer; }
+
 	protected:
 
 	// =========================================================================
@@ -55,6 +66,8 @@ namespace DbNormalizerCpp {
 											// contents of the data to be 
 											// parsed.
 
+		Tracer * tracer = nullptr;			// Records the parse, or null.
+
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// In-memory columnar table of a JoinSimulator. Every value is a 64-bit
+	// integer, and rows are stored column by column.
+	// =========================================================================
+	struct ColumnarTable {
+
+		std::string name;
+		SortedAttributeList attributes;		// Attribute of every column.
+		std::vector<std::vector<std::int64_t>>
+			columns;						// Values of every column.
+		std::size_t rows = 0;				// Rows of every column.
+
+		// Returns the bytes the values take.
+		std::size_t Bytes() const { return rows * columns.size() * sizeof(std::int64_t); };
+
+	};
+
+	// =========================================================================
+	// Scale of a JoinSimulator.
+	// =========================================================================
+	struct JoinSimulationConfig {
+
+		std::size_t rows = 100000;			// Rows generated before the
+											// functional dependencies are
+											// enforced.
+		std::size_t domain = 1000;			// Distinct values every
+											// attribute starts with.
+		unsigned int max_threads = 1;		// Threads of the joins.
+		std::uint64_t seed = 1;				// Seed of the row generator.
+
+	};
+
+	// =========================================================================
+	// Simulated table: the global relation or a relation of the relation
+	// table.
+	// =========================================================================
+	struct SimulatedTable {
+
+		std::string name;
+		std::size_t rows = 0;
+		std::size_t columns = 0;
+		std::size_t bytes = 0;				// Bytes of the values.
+		double seconds = 0.0;				// Time to materialize the table.
+
+	};
+
+	// =========================================================================
+	// One hash join of the reconstruction of the global relation.
+	// =========================================================================
+	struct SimulatedJoin {
+
+		std::string relation;				// Relation joined in.
+		std::string on;						// Join attributes' names.
+		std::size_t probe_rows = 0;			// Rows of the probe side.
+		std::size_t build_rows = 0;			// Rows of the build side.
+		std::size_t output_rows = 0;
+		std::size_t hash_table_bytes = 0;	// Bytes of the hashes, buckets
+											// and chains.
+		std::size_t output_bytes = 0;
+		double seconds = 0.0;
+
+	};
+
+	// =========================================================================
+	// Results of a JoinSimulator.
+	// =========================================================================
+	struct JoinSimulationReport {
+
+		SimulatedTable global;				// All attributes in one table.
+		std::vector<SimulatedTable>
+			relations;						// Every relation of the relation
+											// table.
+		std::vector<SimulatedJoin>
+			joins;							// Joins that reconstruct the
+											// global relation, in order.
+		std::size_t chase_passes = 0;		// Passes over the functional
+											// dependencies that enforced
+											// them on the generated rows.
+		std::size_t normalized_bytes = 0;	// Total bytes of "relations".
+		std::size_t peak_join_bytes = 0;	// Most bytes one join held: its
+											// inputs, hash table and output.
+		double join_seconds = 0.0;			// Total time of "joins".
+		std::size_t reconstructed_rows = 0;	// Rows of the last join.
+		bool reconstructed = false;			// Every relation was joined in.
+		bool matches = false;				// The reconstruction equals the
+											// global relation.
+
+	};
+
+	// =========================================================================
+	// JoinSimulator class that measures what a decomposition costs to read
+	// back. It generates synthetic rows that satisfy the functional
+	// dependency table, materializes the global relation and every relation
+	// of the relation table of a normalized Database as in-memory columnar
+	// tables, and reconstructs the global relation with hash joins.
+	//
+	// Rows start with random values from "domain" values per attribute. The
+	// functional dependencies are then enforced by a chase: for every
+	// functional dependency X -> Y, rows that agree on X are made to agree
+	// on Y, until no values change. Duplicate rows are removed, so the
+	// global relation may have fewer rows than generated. Every relation is
+	// the projection of the global relation onto its attributes.
+	//
+	// The reconstruction starts with the largest relation and joins in the
+	// relation sharing the most attributes with the result so far. Every
+	// join is a partitioned hash join on up to "max_threads" threads: the
+	// smaller side is hashed, its rows are split into one hash table
+	// partition per thread, and the larger side is probed in contiguous
+	// ranges, one per thread. The outputs are concatenated in range order,
+	// so the result does not depend on the number of threads.
+	// =========================================================================
+	class JoinSimulator {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_db":
+		//		Normalized Database whose relations are simulated. Must
+		//		outlive the simulator.
+		//
+		// "_config":
+		//		Rows, values per attribute, threads and seed.
+		//
+		// Throws std::invalid_argument if "_config" has no values per
+		// attribute or more rows than 32-bit row indexes can address.
+		// =====================================================================
+		JoinSimulator(const Database & _db, JoinSimulationConfig _config = JoinSimulationConfig());
+		~JoinSimulator() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Prints a report.
+		//
+		// "report":
+		//		Report returned by Simulate().
+		// =====================================================================
+		void Print(const JoinSimulationReport & report);
+
+		// =====================================================================
+		// Generates the rows, materializes the tables, and reconstructs the
+		// global relation.
+		//
+		// Returns the times, bytes and row counts of every table and join.
+		// =====================================================================
+		JoinSimulationReport Simulate();
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		JoinSimulationConfig config;		// Scale of the simulation.
+		const Database & db;				// Simulated database.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		ColumnarTable GenerateGlobal(std::size_t & chase_passes);
+		ColumnarTable HashJoin(const ColumnarTable & left, const ColumnarTable & right, SimulatedJoin & join);
+		ColumnarTable Project(const ColumnarTable & global, const Relation & relation);
+
+	};
+
+}
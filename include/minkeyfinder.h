@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "budget.h"
+#include "packedfuncdeps.h"
+#include "types.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// MinimumKeyFinder class that finds a candidate key of smallest size of
+	// a relation, i.e., of the projection of the functional dependencies
+	// onto its attributes, without enumerating every candidate key.
+	//
+	// Attributes of the relation are first classified by where they appear
+	// in the functional dependencies:
+	//		* Never on a rhs: nothing determines them, so they are in every
+	//		  key. These form the core.
+	//		* On a rhs but never on a lhs: they determine nothing else, so a
+	//		  smallest key only holds the ones the rest of the relation does
+	//		  not determine, which are added to the core with one closure.
+	//		* On both sides: searched.
+	//
+	// The core plus every both-sides attribute is a superkey. It is
+	// greedily reduced to a candidate key, which bounds the search. A
+	// depth-first branch and bound then adds both-sides attributes to the
+	// core in ascending order and prunes a branch when
+	//		* the key would not be smaller than the best one found,
+	//		* the branch's attributes plus every attribute still to be tried
+	//		  are not a superkey, or
+	//		* an attribute is already in the closure of the branch, since a
+	//		  candidate key never holds an attribute the rest of it
+	//		  determines.
+	// A superkey found this way is smaller than every key found before, so
+	// the last one is a smallest key once the search completes. All sets are
+	// packed into 64-bit words.
+	// =========================================================================
+	class MinimumKeyFinder {
+
+	public:
+
+		// Closures computed per Find() unless the constructor is given
+		// another budget.
+		static constexpr std::size_t DEFAULT_SEARCH_BUDGET = 1 << 16;
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_func_deps":
+		//		Packed functional dependencies over the attributes. Must
+		//		outlive the finder.
+		//
+		// "_search_budget":
+		//		Maximum number of closures computed per Find(). If the
+		//		budget runs out, Find() returns the smallest key found so
+		//		far, which is still a candidate key.
+		//
+		// "_should_stop":
+		//		Called before every closure of the search and of the
+		//		reduction to a key. Once it returns true, Find() stops and
+		//		returns the best superkey it holds, which may not be a
+		//		candidate key. May be empty.
+		// =====================================================================
+		MinimumKeyFinder(const PackedFuncDepTable & _func_deps,
+			std::size_t _search_budget = DEFAULT_SEARCH_BUDGET,
+			StopPredicate _should_stop = StopPredicate());
+		~MinimumKeyFinder() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns whether the search budget ran out in the last call to
+		// Find(), in which case the key returned may not be the smallest.
+		// =====================================================================
+		bool BudgetExhausted() const { return budget_exhausted; };
+
+		// =====================================================================
+		// Returns the number of closures computed in the last call to
+		// Find().
+		// =====================================================================
+		std::size_t ClosuresComputed() const { return closures_computed; };
+
+		// =====================================================================
+		// Returns whether the stop predicate stopped the last call to
+		// Find(), in which case the key returned is a superkey that may
+		// not be minimal.
+		// =====================================================================
+		bool Stopped() const { return stopped; };
+
+		// =====================================================================
+		// Finds a smallest candidate key of a relation.
+		//
+		// "attributes":
+		//		Attributes of the relation.
+		//
+		// Returns the key.
+		// =====================================================================
+		AttributeSet Find(const AttributeSet & attributes);
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		PackedAttributeSet best;			// Smallest key found.
+		std::size_t best_size;				// Attributes in best.
+		bool budget_exhausted;				// Budget ran out in Find().
+		std::vector<AttributeTblIndex> candidates;	// Searched attributes.
+		std::size_t closures_computed;		// Closures computed in Find().
+		const PackedFuncDepTable & func_deps;	// Packed functional
+											// dependencies.
+		std::size_t num_words;				// Words per packed set.
+		PackedAttributeSet relation;		// Attributes of the relation.
+		std::vector<PackedAttributeSet> remaining;	// Candidates from
+											// every index on.
+		std::size_t search_budget;			// Max closures per Find().
+		StopPredicate should_stop;			// Stops Find() early.
+		bool stopped;						// should_stop stopped Find().
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		PackedAttributeSet ComputeClosureOf(const PackedAttributeSet & attributes);
+		bool IsSuperkey(const PackedAttributeSet & attributes);
+		bool OutOfBudget();
+		void ReduceToKey(PackedAttributeSet & key);
+		void Search(PackedAttributeSet & x, std::size_t size, std::size_t next);
+
+	};
+
+}
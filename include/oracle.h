@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Result of comparing one optimized engine against its reference
+	// implementation over every generated schema.
+	// =========================================================================
+	struct OracleCaseResult {
+
+		std::string engine;
+		std::size_t cases = 0;
+		std::size_t mismatches = 0;
+		double reference_seconds = 0.0;
+		double optimized_seconds = 0.0;
+
+		double Speedup() const {
+			return optimized_seconds == 0.0 ? 0.0
+				: reference_seconds / optimized_seconds;
+		}
+
+	};
+
+	using OracleCaseResultList = std::vector<OracleCaseResult>;
+
+	// =========================================================================
+	// DifferentialOracle class that validates the optimized normalization
+	// engines against straightforward reference implementations on
+	// randomized schemas, and times both.
+	//
+	// The references are deliberately naive: closures are computed with
+	// ordered sets, a subset test per functional dependency and a fixed
+	// point over the whole functional dependency table, and candidate keys
+	// are found by enumerating every subset of the attributes. Schemas are
+	// therefore limited to a few attributes.
+	//
+	// Engines checked:
+	//		* "closure": ComputeClosureOf() on random attribute sets.
+	//		* "batch closure": ComputeClosuresOf() on a batch of random
+	//		  attribute sets spanning several blocks.
+	//		* "global closure": GenerateGlobalRelation() closures and
+	//		  candidate keys, computed on "max_threads" threads.
+	//		* "candidate key": ComputeCandidateKey() returns a candidate key.
+	//		* "minimum key": MinimumKeyFinder returns a smallest candidate
+	//		  key of a random relation.
+	//		* "prime attributes": MarkPrimeAttributes().
+	//		* "2nf": NormalizeTo2nf() on "max_threads" threads against the
+	//		  single-threaded run, which is the reference, plus a check that
+	//		  the relations cover every attribute.
+	//		* "static schema": StaticSchema::NormalizeTo2nf() against
+	//		  NormalizeTo2nf(), relation for relation and names included,
+	//		  on schemas of up to 64 attributes.
+	//		* "components": NormalizeComponents() to 2NF on "max_threads"
+	//		  threads against NormalizeTo2nf(), on schemas of independent
+	//		  sub-schemas: the relations cover every attribute, and the
+	//		  linking relation is held by a relation of NormalizeTo2nf()
+	//		  and holds no other relation.
+	//		* "4nf": NormalizeTo4nf() on "max_threads" threads leaves every
+	//		  relation in BCNF, since schemas have no multivalued
+	//		  dependencies, and keeps a schema already in BCNF whole.
+	// =========================================================================
+	class DifferentialOracle {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "seed":
+		//		Seed of the schema generator. Equal seeds generate equal
+		//		schemas.
+		//
+		// "_max_threads":
+		//		Maximum number of threads used by the optimized engines.
+		//
+		// "_max_attributes":
+		//		Maximum number of attributes per schema. At most 16, since
+		//		references enumerate every subset of the attributes.
+		//
+		// "_max_func_deps":
+		//		Maximum number of functional dependencies per schema.
+		// =====================================================================
+		DifferentialOracle(unsigned int seed = 1, unsigned int _max_threads = 1,
+			std::size_t _max_attributes = 10, std::size_t _max_func_deps = 12);
+		~DifferentialOracle() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Prints oracle results.
+		//
+		// "results":
+		//		Results returned by Run().
+		// =====================================================================
+		void Print(const OracleCaseResultList & results);
+
+		// =====================================================================
+		// Generates schemas and checks every engine on each of them.
+		//
+		// "num_schemas":
+		//		Number of schemas to generate.
+		//
+		// Returns one result per engine.
+		// =====================================================================
+		OracleCaseResultList Run(std::size_t num_schemas);
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::size_t max_attributes;			// Max attributes per schema.
+		std::size_t max_func_deps;			// Max func deps per schema.
+		unsigned int max_threads;			// Max threads to spawn.
+		std::mt19937 rng;					// Schema generator.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		void CheckBatchClosure(Database & db, OracleCaseResult & result);
+		void CheckCandidateKey(Database & db, OracleCaseResult & result);
+		void CheckClosure(Database & db, OracleCaseResult & result);
+		void CheckComponents(OracleCaseResult & result);
+		void CheckDecomposition(Database & db, Database & baseline, OracleCaseResult & result);
+		void CheckFourthNormalForm(Database & db, OracleCaseResult & result);
+		void CheckGlobalClosure(Database & db, OracleCaseResult & result);
+		void CheckMinimumKey(Database & db, OracleCaseResult & result);
+		void CheckPrimeAttributes(Database & db, OracleCaseResult & result);
+		void CheckStaticSchema(OracleCaseResult & result);
+		Database GenerateBcnfSchema();
+		Database GenerateComponentSchema();
+		Database GenerateSchema();
+
+	};
+
+}
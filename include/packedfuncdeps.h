@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "types.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Packed attribute sets: one bit per attribute table index, 64 per word.
+	// =========================================================================
+
+	// =========================================================================
+	// Returns the number of attributes in a packed set.
+	// =========================================================================
+	std::size_t CountPackedAttributes(const PackedAttributeSet & packed);
+
+	// =========================================================================
+	// Removes an attribute from a packed set.
+	// =========================================================================
+	void ErasePackedAttribute(PackedAttributeSet & packed, AttributeTblIndex attr);
+
+	// =========================================================================
+	// Returns whether a packed set contains an attribute.
+	// =========================================================================
+	bool HasPackedAttribute(const PackedAttributeSet & packed, AttributeTblIndex attr);
+
+	// =========================================================================
+	// Adds an attribute to a packed set.
+	// =========================================================================
+	void InsertPackedAttribute(PackedAttributeSet & packed, AttributeTblIndex attr);
+
+	// =========================================================================
+	// Packs a set of attributes.
+	//
+	// "attribute_set":
+	//		Set of attributes to pack. Every index must be below
+	//		64 * "num_words".
+	//
+	// "num_words":
+	//		Words of the packed set.
+	// =========================================================================
+	PackedAttributeSet PackAttributes(const AttributeSet & attribute_set, std::size_t num_words);
+
+	// =========================================================================
+	// Unpacks a packed set of attributes, in ascending order.
+	// =========================================================================
+	AttributeSet UnpackAttributes(const PackedAttributeSet & packed);
+
+	// =========================================================================
+	// PackedFuncDepTable class that holds a functional dependency table with
+	// every lhs and rhs packed into 64-bit words, for the searches that
+	// compute many closures over small attribute sets: PrimeAttributeFinder,
+	// MinimumKeyFinder, and DatabaseSnapshot.
+	//
+	// A lhs or rhs only keeps its nonzero words, each with its word index,
+	// so the table grows with the size of the functional dependencies, not
+	// with the number of attributes times the number of functional
+	// dependencies. Closures, and the sets of attributes on some lhs or
+	// rhs, are dense.
+	//
+	// A table never changes once built, so any number of threads may
+	// compute closures with one.
+	// =========================================================================
+	class PackedFuncDepTable {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		PackedFuncDepTable() : num_attributes(0), num_func_deps(0), num_words(0) {};
+
+		// =====================================================================
+		// "func_dep_table":
+		//		Functional dependencies to pack.
+		//
+		// "_num_attributes":
+		//		Number of attributes. Every attribute table index in
+		//		"func_dep_table" must be below it.
+		// =====================================================================
+		PackedFuncDepTable(const FuncDepTable & func_dep_table, std::size_t _num_attributes);
+		~PackedFuncDepTable() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Computes the closure of a packed set of attributes.
+		//
+		// "attributes":
+		//		Set of attributes for which the closure will be computed.
+		//		Must have at least GetNumWords() words.
+		//
+		// Returns the set of all attributes functionally determined by
+		// "attributes", including "attributes" itself.
+		// =====================================================================
+		PackedAttributeSet ComputeClosureOf(const PackedAttributeSet & attributes) const;
+
+		// =====================================================================
+		// Returns the attributes on some lhs.
+		// =====================================================================
+		const PackedAttributeSet & GetInLhs() const { return in_lhs; };
+
+		// =====================================================================
+		// Returns the attributes on some rhs.
+		// =====================================================================
+		const PackedAttributeSet & GetInRhs() const { return in_rhs; };
+
+		// =====================================================================
+		// Returns the number of attributes.
+		// =====================================================================
+		std::size_t GetNumAttributes() const { return num_attributes; };
+
+		// =====================================================================
+		// Returns the number of functional dependencies.
+		// =====================================================================
+		std::size_t GetNumFuncDeps() const { return num_func_deps; };
+
+		// =====================================================================
+		// Returns the number of words of every packed set.
+		// =====================================================================
+		std::size_t GetNumWords() const { return num_words; };
+
+		// =====================================================================
+		// Returns the set of all attributes.
+		// =====================================================================
+		const PackedAttributeSet & GetUniverse() const { return universe; };
+
+		// =====================================================================
+		// Fires a functional dependency on a closure being computed: if its
+		// lhs is a subset of "closure", adds its rhs.
+		//
+		// "fd_tbl_index":
+		//		Index of the functional dependency.
+		//
+		// "closure":
+		//		Closure being computed. Must have at least GetNumWords()
+		//		words; only the words of the functional dependency are
+		//		read or written.
+		//
+		// "new_insertion":
+		//		Set to true if the rhs added an attribute to "closure".
+		//
+		// Returns whether the functional dependency fired.
+		// =====================================================================
+		bool Fire(std::size_t fd_tbl_index, PackedAttributeSet & closure, bool & new_insertion) const;
+
+	private:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		// Nonzero word of a packed lhs or rhs.
+		struct PackedWord {
+
+			std::size_t index;				// Index of the word.
+			std::uint64_t bits;				// Attributes in the word.
+
+		};
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		PackedAttributeSet in_lhs;			// Attributes on some lhs.
+		PackedAttributeSet in_rhs;			// Attributes on some rhs.
+		std::size_t num_attributes;			// Number of attributes.
+		std::size_t num_func_deps;			// Number of functional
+											// dependencies.
+		std::size_t num_words;				// Words per packed set.
+		std::vector<std::size_t> offsets;	// Start of every lhs and rhs in
+											// "words", in functional
+											// dependency order, then the end.
+		PackedAttributeSet universe;		// All attributes.
+		std::vector<PackedWord> words;		// Nonzero words of every lhs,
+											// each followed by its rhs.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		void AppendWords(const AttributeSet & attribute_set, PackedAttributeSet & in_side);
+
+	};
+
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <set>
+#include <vector>
+
+#include "budget.h"
+#include "packedfuncdeps.h"
+#include "types.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// PrimeAttributeFinder class that determines which attributes are prime,
+	// i.e., belong to at least one candidate key, without enumerating every
+	// candidate key.
+	//
+	// Attributes are first classified by where they appear in the
+	// functional dependencies:
+	//		* Never on a rhs: in every candidate key, so always prime. These
+	//		  form the core.
+	//		* On a rhs but never on a lhs: never prime.
+	//		* On both sides: searched.
+	//
+	// An attribute A on both sides is prime if and only if there is a set X
+	// of core and both-sides attributes that is not a superkey while X + A
+	// is. Each such attribute is first tried with a greedy key reduction
+	// that removes A last, and then with a depth-first search over X that
+	// prunes every X whose closure is a superkey or contains A. Every
+	// candidate key found along the way marks all of its attributes as
+	// prime, and the search for an attribute stops as soon as it is proven
+	// prime. All sets are packed into 64-bit words.
+	// =========================================================================
+	class PrimeAttributeFinder {
+
+	public:
+
+		// Closures computed per Find() unless the constructor is given
+		// another budget.
+		static constexpr std::size_t DEFAULT_SEARCH_BUDGET = 1 << 16;
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_func_deps":
+		//		Packed functional dependencies over the attributes. Must
+		//		outlive the finder.
+		//
+		// "_search_budget":
+		//		Maximum number of closures computed. Attributes that are not
+		//		resolved within the budget are reported as prime, so that
+		//		normalization never decomposes on them.
+		//
+		// "_should_stop":
+		//		Called before every closure of the search and of the
+		//		reductions to a key. Once it returns true, Find() stops as
+		//		if the budget ran out. May be empty.
+		// =====================================================================
+		PrimeAttributeFinder(const PackedFuncDepTable & _func_deps,
+			std::size_t _search_budget = DEFAULT_SEARCH_BUDGET,
+			StopPredicate _should_stop = StopPredicate());
+		~PrimeAttributeFinder() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns whether the search budget ran out in the last call to
+		// Find().
+		// =====================================================================
+		bool BudgetExhausted() const { return budget_exhausted; };
+
+		// =====================================================================
+		// Returns the number of closures computed in the last call to
+		// Find().
+		// =====================================================================
+		std::size_t ClosuresComputed() const { return closures_computed; };
+
+		// =====================================================================
+		// Determines the prime attributes.
+		//
+		// Returns one flag per attribute table index, set if the attribute
+		// is prime.
+		// =====================================================================
+		std::vector<char> Find();
+
+		// =====================================================================
+		// Returns the number of distinct candidate keys found in the last
+		// call to Find().
+		// =====================================================================
+		std::size_t KeysFound() const { return keys.size(); };
+
+		// =====================================================================
+		// Returns whether the stop predicate stopped the last call to
+		// Find(), in which case unresolved attributes were reported as
+		// prime.
+		// =====================================================================
+		bool Stopped() const { return stopped; };
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		bool budget_exhausted;				// Budget ran out in Find().
+		std::vector<AttributeTblIndex> both_sides;	// Searched attributes.
+		std::size_t closures_computed;		// Closures computed in Find().
+		PackedAttributeSet core;			// Attributes never on a rhs.
+		const PackedFuncDepTable & func_deps;	// Packed functional
+											// dependencies.
+		std::set<PackedAttributeSet> keys;	// Candidate keys found.
+		std::vector<char> prime;			// Prime flags found so far.
+		std::size_t search_budget;			// Max closures per Find().
+		StopPredicate should_stop;			// Stops Find() early.
+		bool stopped;						// should_stop stopped Find().
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		PackedAttributeSet ComputeClosureOf(const PackedAttributeSet & attributes);
+		bool IsSuperkey(const PackedAttributeSet & attributes);
+		void MarkKey(const PackedAttributeSet & key);
+		bool OutOfBudget();
+		bool ReduceToKey(PackedAttributeSet & key, AttributeTblIndex last);
+		bool SearchWitness(PackedAttributeSet & x, std::size_t next, AttributeTblIndex attr);
+
+	};
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -10,8 +12,36 @@ namespace DbNormalizerCpp {
 	// =========================================================================
 	// A Relation struct that basically represents a table in a relational
 	// database. Relations house data used by the Database class. 
+	//
+	// A Relation is allocator-aware: all of its sets and lists allocate from
+	// the memory resource it was constructed with, and containers of 
+	// Relations pass their own resource on to the Relations they hold.
 	// =========================================================================
 	struct Relation {
+
+		using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+		explicit Relation(const allocator_type & alloc = {})
+			: attributes(alloc), primary_key(alloc), candidate_keys(alloc),
+			closure(alloc) {}
+
+		Relation(const Relation & other, const allocator_type & alloc = {})
+			: name(other.name), attributes(other.attributes, alloc),
+			primary_key(other.primary_key, alloc),
+			candidate_keys(other.candidate_keys, alloc),
+			closure(other.closure, alloc) {}
+
+		Relation(Relation && other) = default;
+
+		Relation(Relation && other, const allocator_type & alloc)
+			: name(std::move(other.name)), 
+			attributes(std::move(other.attributes), alloc),
+			primary_key(std::move(other.primary_key), alloc),
+			candidate_keys(std::move(other.candidate_keys), alloc),
+			closure(std::move(other.closure), alloc) {}
+
+		Relation & operator=(const Relation & other) = default;
+		Relation & operator=(Relation && other) = default;
 	
 		std::string name;
 		AttributeSet attributes;
@@ -21,6 +51,6 @@ namespace DbNormalizerCpp {
 
 	};
 
-	using RelationTable = std::vector<Relation>;
+	using RelationTable = std::pmr::vector<Relation>;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// RelationStream class that normalizes a Database lazily: every call to
+	// Next() runs the normalization queue only until the next relation is
+	// final and hands that relation to the caller, instead of collecting
+	// every relation in "relation_table" first. Writers, DDL emitters, or a
+	// network layer can start on the first relation right away.
+	//
+	// The stream drives the same queue and the same RelationTo2nf() or
+	// RelationTo4nf() steps as Database::NormalizeTo2nf() and
+	// Database::NormalizeTo4nf() with one thread, so relations come out in
+	// the same order and with the same names. Queued relations allocate
+	// from the default resource rather than from a normalization arena, and
+	// a relation is released as soon as it leaves the queue, so memory is
+	// bounded by the queue rather than by the whole result. Streamed
+	// relations are not kept in "relation_table".
+	//
+	// If the Database is already in the target normal form, its relation
+	// table is streamed as it is.
+	// =========================================================================
+	class RelationStream {
+
+	public:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		// Input iterator over the remaining relations of a stream.
+		// Incrementing it pulls the next relation.
+		class iterator {
+
+		public:
+
+			using iterator_category = std::input_iterator_tag;
+			using value_type = Relation;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Relation *;
+			using reference = const Relation &;
+
+			iterator() : stream(nullptr) {};
+			explicit iterator(RelationStream * _stream) : stream(_stream) { ++(*this); };
+
+			reference operator*() const { return current; };
+			pointer operator->() const { return &current; };
+
+			iterator & operator++() {
+
+				if (stream && !stream->Next(current))
+					stream = nullptr;
+
+				return *this;
+
+			};
+
+			bool operator==(const iterator & other) const { return stream == other.stream; };
+			bool operator!=(const iterator & other) const { return stream != other.stream; };
+
+		private:
+
+			RelationStream * stream;		// Null at the end.
+			Relation current;				// Last relation pulled.
+
+		};
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_db":
+		//		Database to normalize. Must outlive the stream.
+		//
+		// "_target":
+		//		NormalForm::Two or NormalForm::Four.
+		//
+		// Throws std::invalid_argument if "_target" is neither 2NF nor 4NF.
+		// =====================================================================
+		RelationStream(Database & _db, NormalForm _target = NormalForm::Two);
+		~RelationStream() {};
+
+		RelationStream(const RelationStream &) = delete;
+		RelationStream & operator=(const RelationStream &) = delete;
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns an iterator that pulls the next relation.
+		// =====================================================================
+		iterator begin() { return iterator(this); };
+
+		// =====================================================================
+		// Returns the end iterator.
+		// =====================================================================
+		iterator end() { return iterator(); };
+
+		// =====================================================================
+		// Normalizes until the next relation is final.
+		//
+		// "relation":
+		//		Receives the final relation, named as in "relation_table".
+		//
+		// Returns false, leaving "relation" unchanged, once every relation
+		// has been streamed.
+		// =====================================================================
+		bool Next(Relation & relation);
+
+		// =====================================================================
+		// Returns the largest number of relations queued at once so far.
+		// =====================================================================
+		std::size_t PeakQueueSize() const { return peak_queue_size; };
+
+		// =====================================================================
+		// Returns the number of relations queued for normalization.
+		// =====================================================================
+		std::size_t QueueSize() const { return normalization_queue.size(); };
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		Database & db;						// Normalized database.
+		std::size_t kept_index;				// Next relation of an already
+											// normalized relation table.
+		NormalizationQueue normalization_queue;	// Relations to normalize.
+		std::size_t peak_queue_size;		// Largest queue size so far.
+		bool started;						// Queue has been filled.
+		NormalForm target;					// Target normal form.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		void Start();
+
+	};
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// ResultCache class that persists normalization results in a local cache
+	// directory. Results are content-addressed by a canonical hash of a 
+	// Database's attribute, functional dependency, and multivalued 
+	// dependency tables, which does not depend on the order in which 
+	// attributes or dependencies were inserted. A normalization of an 
+	// unchanged schema is loaded instead of recomputed.
+	// =========================================================================
+	class ResultCache {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_directory":
+		//		Cache directory. Created if it does not exist.
+		// =====================================================================
+		ResultCache(const std::string & _directory);
+		~ResultCache() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Computes the canonical schema hash of a Database.
+		//
+		// "db":
+		//		Database to hash.
+		//
+		// Returns a 64-bit FNV-1a hash of the canonical schema of "db".
+		// =====================================================================
+		static std::uint64_t ComputeSchemaHash(const Database & db);
+
+		// =====================================================================
+		// Returns the number of cache hits so far.
+		// =====================================================================
+		std::size_t Hits() const { return hits; }
+
+		// =====================================================================
+		// Returns the number of cache misses so far.
+		// =====================================================================
+		std::size_t Misses() const { return misses; }
+
+		// =====================================================================
+		// Normalizes a Database, loading the result from the cache if an 
+		// entry exists for its schema and "normal_form". Otherwise, 
+		// normalizes "db" and stores the result.
+		//
+		// "db":
+		//		Database to normalize.
+		//
+		// "normal_form":
+		//		Normal form to normalize to. NormalForm::Two or 
+		//		NormalForm::Four.
+		//
+		// "max_threads":
+		//		Maximum number of threads to spawn on a cache miss.
+		//
+		// Returns true on a cache hit and false on a cache miss.
+		//
+		// Throws std::invalid_argument if "normal_form" is not supported.
+		// =====================================================================
+		bool Normalize(Database & db, NormalForm normal_form, 
+			unsigned int max_threads = 1);
+
+		// =====================================================================
+		// Prints the number of cache hits and misses.
+		// =====================================================================
+		void PrintStats();
+
+	private:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		// =====================================================================
+		// Canonical form of a schema. Attributes are ordered by name and 
+		// dependencies are ordered by their canonical text, so that entries
+		// can be mapped between databases that inserted them in different 
+		// orders.
+		// =====================================================================
+		struct CanonicalSchema {
+
+			std::vector<AttributeTblIndex> attributes;	// Db index by rank.
+			std::vector<AttributeTblIndex> ranks;		// Rank by db index.
+			std::vector<FuncDepTblIndex> func_deps;		// Db index by rank.
+			std::vector<FuncDepTblIndex> func_dep_ranks;// Rank by db index.
+			std::string text;
+
+		};
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::string directory;				// Cache directory.
+		std::size_t hits = 0;				// Number of cache hits.
+		std::size_t misses = 0;				// Number of cache misses.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		static CanonicalSchema Canonicalize(const Database & db);
+		std::string EntryPath(const CanonicalSchema & schema, NormalForm normal_form);
+		static std::uint64_t HashText(const std::string & text);
+		bool Load(Database & db, const CanonicalSchema & schema, NormalForm normal_form);
+		void Store(const Database & db, const CanonicalSchema & schema, NormalForm normal_form);
+
+	};
+
+}
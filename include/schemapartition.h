@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "types.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// SchemaPartition class that splits a schema into independent
+	// components, i.e., the connected components of the hypergraph whose
+	// vertices are the attributes and whose hyperedges are the functional
+	// and multivalued dependencies. No dependency spans two components, so
+	// each component can be normalized on its own.
+	//
+	// Components are found with a union-find over the attribute table
+	// indexes (union by size, path halving): every dependency unites all of
+	// its attributes. Attributes that appear in no dependency are isolated
+	// and are not put in any component.
+	// =========================================================================
+	class SchemaPartition {
+
+	public:
+
+	// =========================================================================
+	// Constants
+	// =========================================================================
+
+		static const std::size_t NO_COMPONENT;	// Component of an isolated
+												// attribute.
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "num_attributes":
+		//		Number of attributes. Every attribute table index in the
+		//		dependency tables must be below it.
+		//
+		// "func_dep_table":
+		//		Functional dependencies over the attributes.
+		//
+		// "mvd_table":
+		//		Multivalued dependencies over the attributes.
+		// =====================================================================
+		SchemaPartition(std::size_t num_attributes,
+			const FuncDepTable & func_dep_table,
+			const MultiValuedDepTable & mvd_table);
+		~SchemaPartition() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns the component of an attribute, or NO_COMPONENT if the
+		// attribute is isolated.
+		// =====================================================================
+		std::size_t ComponentOf(AttributeTblIndex attr) const { return component_of[attr]; };
+
+		// =====================================================================
+		// Returns the attributes of every component in ascending order.
+		// Components are ordered by their smallest attribute.
+		// =====================================================================
+		const std::vector<SortedAttributeList> & Components() const { return components; };
+
+		// =====================================================================
+		// Returns the indexes into the functional dependency table of the
+		// functional dependencies of every component, in ascending order.
+		// =====================================================================
+		const std::vector<FuncDepTblIndexList> & FuncDeps() const { return func_deps; };
+
+		// =====================================================================
+		// Returns the isolated attributes in ascending order.
+		// =====================================================================
+		const SortedAttributeList & Isolated() const { return isolated; };
+
+		// =====================================================================
+		// Returns the indexes into the multivalued dependency table of the
+		// multivalued dependencies of every component, in ascending order.
+		// =====================================================================
+		const std::vector<std::vector<MultiValuedDepTblIndex>> &
+			MultiValuedDeps() const { return mvds; };
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::vector<std::size_t> component_of;	// Component of every
+												// attribute.
+		std::vector<SortedAttributeList> components;	// Attributes of every
+														// component.
+		std::vector<FuncDepTblIndexList> func_deps;	// Func deps of every
+													// component.
+		SortedAttributeList isolated;		// Attributes in no dependency.
+		std::vector<std::vector<MultiValuedDepTblIndex>>
+			mvds;							// MVDs of every component.
+		std::vector<AttributeTblIndex> parent;	// Union-find parents.
+		std::vector<std::size_t> size;		// Union-find set sizes.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		AttributeTblIndex Find(AttributeTblIndex attr);
+		void Unite(AttributeTblIndex a, AttributeTblIndex b);
+		void UniteDependency(const std::pair<Lhs, Rhs> & dependency);
+
+	};
+
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <istream>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Counters of a NormalizationServer since it was constructed.
+	// =========================================================================
+	struct ServerStats {
+
+		std::size_t requests = 0;			// Requests answered.
+		std::size_t cache_hits = 0;			// Requests answered from cache.
+		std::size_t errors = 0;				// Requests that failed.
+		std::uint64_t total_latency_us = 0;	// Sum of request latencies.
+		std::uint64_t max_latency_us = 0;	// Largest request latency.
+
+	};
+
+	// =========================================================================
+	// NormalizationServer class that normalizes schemas sent as requests
+	// over a stream, e.g., stdin/stdout, or over a Unix domain socket, so
+	// that many schemas are normalized by one long-lived process.
+	//
+	// A request is a DbNormalizer++ .txt file followed by a line holding
+	// only ".". Every request is answered with
+	//
+	//		#response <id> latency_us=<latency> cache=<hit|miss>
+	//		<Database::Print() output, or "#error <message>">
+	//		.
+	//
+	// where <id> numbers the requests of a session from 1 and <latency> is
+	// the time from reading the request to finishing its response. Two
+	// control lines are also accepted: ".stats" answers with the server's
+	// counters, and ".shutdown" ends the session and, on a socket, stops
+	// accepting connections.
+	//
+	// Requests are pipelined: each one is handed to a pool of worker threads
+	// as soon as it is read, while the session keeps reading, and responses
+	// are written in request order as they complete. The pool and a
+	// least-recently-used cache of responses, keyed by request text, stay
+	// warm between requests and sessions.
+	// =========================================================================
+	class NormalizationServer {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_normal_form":
+		//		NormalForm::Two or NormalForm::Four.
+		//
+		// "num_workers":
+		//		Number of worker threads that normalize requests. 0 uses one
+		//		per hardware thread.
+		//
+		// "_max_threads":
+		//		Maximum number of threads each request spawns to normalize.
+		//
+		// "_cache_capacity":
+		//		Maximum number of cached responses. 0 disables the cache.
+		//
+		// Throws std::invalid_argument if "_normal_form" is neither 2NF nor
+		// 4NF.
+		// =====================================================================
+		NormalizationServer(NormalForm _normal_form = NormalForm::Two,
+			unsigned int num_workers = 0, unsigned int _max_threads = 1,
+			std::size_t _cache_capacity = 1024);
+
+		// =====================================================================
+		// Finishes queued requests and joins the worker threads.
+		// =====================================================================
+		~NormalizationServer();
+
+		NormalizationServer(const NormalizationServer &) = delete;
+		NormalizationServer & operator=(const NormalizationServer &) = delete;
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Prints the server's counters.
+		//
+		// "stream":
+		//		Stream to print to.
+		// =====================================================================
+		void PrintStats(std::ostream & stream);
+
+		// =====================================================================
+		// Serves one session: reads requests from "in" until its end or a
+		// ".shutdown" line and writes their responses to "out".
+		//
+		// "in", "out":
+		//		Streams of the session.
+		//
+		// Returns true if the session ended with ".shutdown".
+		// =====================================================================
+		bool Serve(std::istream & in, std::ostream & out);
+
+		// =====================================================================
+		// Listens on a Unix domain socket and serves every connection as a
+		// session on its own detached thread, which is released as soon as
+		// the session ends. Once a session sends ".shutdown", stops
+		// accepting and returns when every open session has ended. The
+		// socket file is replaced if it exists and removed on return.
+		//
+		// "path":
+		//		Path of the socket file.
+		//
+		// Throws std::runtime_error if the socket cannot be created.
+		// =====================================================================
+		void ServeSocket(const std::string & path);
+
+		// =====================================================================
+		// Returns the server's counters.
+		// =====================================================================
+		ServerStats Stats();
+
+	private:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		using Clock = std::chrono::steady_clock;
+		using ResponseCacheList = std::list<std::pair<std::string, std::string>>;
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		ResponseCacheList cache;			// Request text and response body,
+											// most recently used first.
+		std::size_t cache_capacity;			// Max cached responses.
+		std::unordered_map<std::string, ResponseCacheList::iterator>
+			cache_index;					// Entry of every cached request.
+		std::mutex cache_mutex;				// Guards cache and cache_index.
+
+		unsigned int max_threads;			// Max threads per request.
+		NormalForm normal_form;				// Target normal form.
+
+		ServerStats stats;					// Counters.
+		std::mutex stats_mutex;				// Guards stats.
+
+		std::atomic<bool> stopping;			// Worker threads must exit.
+		std::deque<std::function<void()>>
+			tasks;							// Requests waiting for a worker.
+		std::condition_variable tasks_cv;	// Signals tasks and stopping.
+		std::mutex tasks_mutex;				// Guards tasks.
+		std::vector<std::thread> workers;	// Worker threads.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		std::string NormalizeRequest(const std::string & request, bool & cache_hit);
+		std::string Respond(std::uint64_t id, const std::string & request, Clock::time_point received);
+		std::future<std::string> Submit(std::function<std::string()> task);
+		void Work();
+
+	};
+
+}
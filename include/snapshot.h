@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "attribute.h"
+#include "database.h"
+#include "packedfuncdeps.h"
+#include "relation.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Fixed-size block of a snapshot's functional dependency table, with
+	// every functional dependency also packed into 64-bit words for
+	// closures. Chunks never change once published, so consecutive
+	// snapshots share every chunk that did not change.
+	// =========================================================================
+	struct FuncDepChunk {
+
+		FuncDepTable func_deps;
+		PackedFuncDepTable packed;			// "func_deps" packed over the
+											// attributes when the chunk was
+											// made.
+
+	};
+
+	// =========================================================================
+	// DatabaseSnapshot class, an immutable version of a Database's name,
+	// attribute table, functional dependency table, and relation table.
+	//
+	// Every query is const and takes no lock, so any number of threads can
+	// query one snapshot while a writer keeps editing the Database and
+	// prepares the next snapshot. Snapshots are made by a
+	// SnapshotPublisher and share their tables, and the functional
+	// dependency table chunk by chunk, with the snapshot published before
+	// them.
+	// =========================================================================
+	class DatabaseSnapshot {
+
+		friend class SnapshotPublisher;
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		DatabaseSnapshot() : num_func_deps(0), version(0) {};
+		~DatabaseSnapshot() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Computes the closure of a set of attributes with respect to the
+		// functional dependency table.
+		//
+		// "attributes":
+		//		Set of attributes for which the closure will be computed.
+		//
+		// Returns the set of all attributes functionally determined by
+		// "attributes", including "attributes" itself.
+		// =====================================================================
+		AttributeSet ComputeClosureOf(const AttributeSet & attributes) const;
+
+		// =====================================================================
+		// Returns this snapshot's attribute table.
+		// =====================================================================
+		const AttributeTable & GetAttributeTable() const { return *attribute_table; };
+
+		// =====================================================================
+		// Returns a functional dependency.
+		//
+		// "fd_tbl_index":
+		//		Index of the functional dependency in the Database's
+		//		functional dependency table. Must be below GetNumFuncDeps().
+		// =====================================================================
+		const FuncDep & GetFuncDep(FuncDepTblIndex fd_tbl_index) const;
+
+		// =====================================================================
+		// Returns the database's name.
+		// =====================================================================
+		const std::string & GetName() const { return *name; };
+
+		// =====================================================================
+		// Returns the number of functional dependencies.
+		// =====================================================================
+		std::size_t GetNumFuncDeps() const { return num_func_deps; };
+
+		// =====================================================================
+		// Returns this snapshot's relation table.
+		// =====================================================================
+		const RelationTable & GetRelationTable() const { return *relation_table; };
+
+		// =====================================================================
+		// Returns the version of this snapshot. The first published
+		// snapshot is version 1.
+		// =====================================================================
+		std::uint64_t GetVersion() const { return version; };
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::shared_ptr<const AttributeTable> attribute_table;	// Attributes.
+		std::vector<std::shared_ptr<const FuncDepChunk>> func_dep_chunks;	// Functional
+											// dependency table, in chunks.
+		std::shared_ptr<const std::string> name;	// Database name.
+		std::size_t num_func_deps;			// Functional dependencies.
+		std::shared_ptr<const RelationTable> relation_table;	// Relations.
+		std::uint64_t version;				// Publication number.
+
+	};
+
+	using DatabaseSnapshotPtr = std::shared_ptr<const DatabaseSnapshot>;
+
+	// =========================================================================
+	// SnapshotPublisher class that publishes DatabaseSnapshots of a live
+	// Database. One writer thread edits the Database, e.g., inserts
+	// functional dependencies or normalizes it, and calls Publish(). Reader
+	// threads call Current() and query the snapshot they get, never the
+	// Database.
+	//
+	// Publish() compares the Database with the last snapshot and copies
+	// only what changed: a table equal to the last snapshot's is shared,
+	// and so is every chunk of "FUNC_DEP_CHUNK_SIZE" functional
+	// dependencies equal to the same chunk of the last snapshot. Appending
+	// functional dependencies therefore copies at most the last chunk plus
+	// the new ones. The new snapshot is then swapped in with
+	// std::atomic_store(). A reader keeps the snapshot it holds alive for
+	// as long as it needs it, and a snapshot is freed, with whatever it
+	// does not share, when its last reader drops it.
+	// =========================================================================
+	class SnapshotPublisher {
+
+	public:
+
+		// Functional dependencies per chunk.
+		static constexpr std::size_t FUNC_DEP_CHUNK_SIZE = 64;
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_db":
+		//		Live Database. Must outlive the SnapshotPublisher and must
+		//		only be used by the thread that calls Publish().
+		//
+		// Publishes the first snapshot.
+		// =====================================================================
+		SnapshotPublisher(const Database & _db);
+		~SnapshotPublisher() {};
+
+		SnapshotPublisher(const SnapshotPublisher &) = delete;
+		SnapshotPublisher & operator=(const SnapshotPublisher &) = delete;
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns the number of functional dependency chunks the last
+		// Publish() copied rather than shared.
+		// =====================================================================
+		std::size_t ChunksCopied() const { return chunks_copied; };
+
+		// =====================================================================
+		// Returns the latest snapshot. Safe to call from any thread.
+		// =====================================================================
+		DatabaseSnapshotPtr Current() const;
+
+		// =====================================================================
+		// Publishes a snapshot of the Database's current state. Must only be
+		// called by the writer thread.
+		//
+		// Returns the published snapshot.
+		// =====================================================================
+		DatabaseSnapshotPtr Publish();
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::size_t chunks_copied;			// Chunks copied by Publish().
+		DatabaseSnapshotPtr current;		// Latest snapshot. Only
+											// accessed atomically.
+		const Database & db;				// Live database.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		std::shared_ptr<const FuncDepChunk> MakeChunk(std::size_t first, std::size_t last);
+
+	};
+
+}
@@ -0,0 +1,727 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace DbNormalizerCpp {
+
+	// Set of attribute indexes of a StaticSchema, one bit per attribute.
+	using StaticAttributeSet = std::uint64_t;
+
+	// =========================================================================
+	// StaticSchema class that normalizes a schema fixed at compile time, so
+	// that a program embedding it pays nothing at startup: the normalized
+	// relation table is computed by the compiler and baked into the binary
+	// as a static table, and its normal form can be checked with
+	// static_assert.
+	//
+	// Attributes and functional dependencies are given as string literals
+	// in the DbNormalizer++ .txt syntax, e.g., "ssn,pnumber->hrs". Every
+	// step mirrors its Database counterpart on 64-bit attribute sets:
+	// functional dependencies are canonicalized and merged by lhs as in
+	// Database::InsertFuncDep(), prime attributes are found as by
+	// PrimeAttributeFinder, the global relation's primary key is chosen as
+	// by Database::AssignPrimaryKey(), and relations are decomposed in the
+	// same queue order as by Database::RelationTo2nf(). The relation table
+	// is therefore the one Database::NormalizeTo2nf() produces, relation
+	// for relation.
+	//
+	// Everything is constexpr. An error, e.g., an unknown attribute or more
+	// relations than "MaxRelations", throws, which fails compilation when
+	// the schema is normalized in a constant expression.
+	//
+	// Example:
+	//
+	//		constexpr std::array<std::string_view, 6> attributes{
+	//			"ssn", "name", "pnumber", "pname", "ploc", "hrs" };
+	//		constexpr std::array<std::string_view, 3> func_deps{
+	//			"ssn->name", "pnumber->pname,ploc", "ssn,pnumber->hrs" };
+	//		constexpr auto emp_proj = StaticSchema(attributes, func_deps).NormalizeTo2nf();
+	//
+	//		static_assert(emp_proj.GetNumRelations() == 3);
+	//		static_assert(emp_proj.IsIn2nf());
+	// =========================================================================
+	template <std::size_t NumAttributes, std::size_t NumFuncDeps,
+		std::size_t MaxRelations = 2 * NumFuncDeps + 1>
+	class StaticSchema {
+
+		static_assert(NumAttributes <= 64, "A StaticSchema holds at most 64 attributes.");
+
+	public:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		// Relation of the relation table.
+		struct Relation {
+
+			StaticAttributeSet attributes = 0;
+			StaticAttributeSet primary_key = 0;
+			std::array<StaticAttributeSet, NumFuncDeps + 1> candidate_keys{};
+			std::size_t num_candidate_keys = 0;
+			std::size_t number = 0;		// 0 for "global_relation", N for
+										// "rN".
+
+		};
+
+		// Canonical functional dependency lhs -> rhs.
+		struct FuncDep {
+
+			StaticAttributeSet lhs = 0;
+			StaticAttributeSet rhs = 0;
+
+		};
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "attribute_names":
+		//		Names of the attributes, in attribute table order.
+		//
+		// "func_dep_texts":
+		//		Functional dependencies, e.g., "a,b->c".
+		//
+		// Throws std::invalid_argument if a functional dependency is
+		// malformed or names an unknown attribute.
+		// =====================================================================
+		constexpr StaticSchema(const std::array<std::string_view, NumAttributes> &
+			attribute_names, const std::array<std::string_view, NumFuncDeps> &
+			func_dep_texts) : names(attribute_names) {
+
+			for (std::string_view text : func_dep_texts)
+				InsertFuncDep(text);
+
+		}
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns the closure of a set of attributes with respect to the
+		// functional dependencies.
+		//
+		// "attributes":
+		//		Set of attributes for which the closure will be computed.
+		// =====================================================================
+		constexpr StaticAttributeSet ComputeClosureOf(StaticAttributeSet attributes) const {
+
+			StaticAttributeSet closure = attributes;
+			bool new_insertion = true;
+
+			while (new_insertion) {
+
+				new_insertion = false;
+
+				for (std::size_t i = 0; i < num_func_deps; i++) {
+
+					if ((func_deps[i].lhs & ~closure) == 0 && (func_deps[i].rhs & ~closure) != 0) {
+						closure |= func_deps[i].rhs;
+						new_insertion = true;
+					}
+
+				}
+
+			}
+
+			return closure;
+
+		}
+
+		// =====================================================================
+		// Returns the index of an attribute.
+		//
+		// "name":
+		//		Name of the attribute.
+		//
+		// Throws std::invalid_argument if the attribute is unknown.
+		// =====================================================================
+		constexpr std::size_t GetAttributeIndex(std::string_view name) const {
+
+			for (std::size_t attr = 0; attr < NumAttributes; attr++) {
+
+				if (names[attr] == name)
+					return attr;
+
+			}
+
+			throw std::invalid_argument("Unknown attribute!");
+
+		}
+
+		// =====================================================================
+		// Returns the name of an attribute.
+		// =====================================================================
+		constexpr std::string_view GetAttributeName(std::size_t attr) const { return names[attr]; };
+
+		// =====================================================================
+		// Returns the set of comma-separated attributes, e.g., "a,b".
+		//
+		// Throws std::invalid_argument if an attribute is unknown.
+		// =====================================================================
+		constexpr StaticAttributeSet GetAttributeSet(std::string_view text) const {
+
+			StaticAttributeSet set = 0;
+
+			while (!text.empty()) {
+
+				std::size_t comma = text.find(',');
+				std::string_view name = text.substr(0, comma);
+
+				set |= StaticAttributeSet(1) << GetAttributeIndex(name);
+				text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+
+			}
+
+			return set;
+
+		}
+
+		// =====================================================================
+		// Returns a canonical functional dependency.
+		// =====================================================================
+		constexpr const FuncDep & GetFuncDep(std::size_t i) const { return func_deps[i]; };
+
+		// =====================================================================
+		// Returns the number of canonical functional dependencies. Functional
+		// dependencies with the same lhs are merged, and trivial ones are
+		// dropped.
+		// =====================================================================
+		constexpr std::size_t GetNumFuncDeps() const { return num_func_deps; };
+
+		// =====================================================================
+		// Returns the number of relations in the relation table.
+		// =====================================================================
+		constexpr std::size_t GetNumRelations() const { return num_relations; };
+
+		// =====================================================================
+		// Returns a relation of the relation table.
+		// =====================================================================
+		constexpr const Relation & GetRelation(std::size_t i) const { return relations[i]; };
+
+		// =====================================================================
+		// Returns true if every relation of the relation table is in 2NF:
+		// no non-prime attribute depends on a proper subset of its primary
+		// key.
+		// =====================================================================
+		constexpr bool IsIn2nf() const {
+
+			for (std::size_t r = 0; r < num_relations; r++) {
+
+				const Relation & relation = relations[r];
+
+				for (std::size_t i = 0; i < num_func_deps; i++) {
+
+					StaticAttributeSet lhs = func_deps[i].lhs;
+
+					if ((lhs & ~relation.attributes) != 0 || !IsProperSubset(lhs, relation.primary_key))
+						continue;
+
+					if ((ComputeClosureOf(lhs) & relation.attributes & ~lhs & ~prime) != 0)
+						return false;
+
+				}
+
+			}
+
+			return num_relations != 0;
+
+		}
+
+		// =====================================================================
+		// Returns true if every relation of the relation table is in 3NF:
+		// every functional dependency within it whose lhs is not a superkey
+		// of it determines only prime attributes.
+		// =====================================================================
+		constexpr bool IsIn3nf() const {
+
+			return CheckRelations(prime);
+
+		}
+
+		// =====================================================================
+		// Returns true if every relation of the relation table is in BCNF:
+		// the lhs of every non-trivial functional dependency within it is a
+		// superkey of it.
+		// =====================================================================
+		constexpr bool IsInBcnf() const {
+
+			return CheckRelations(0);
+
+		}
+
+		// =====================================================================
+		// Returns true if an attribute belongs to a candidate key of the
+		// global relation.
+		// =====================================================================
+		constexpr bool IsPrime(std::size_t attr) const { return (prime >> attr) & 1; };
+
+		// =====================================================================
+		// Normalizes the schema to 2NF.
+		//
+		// Returns a copy of this schema whose relation table holds the
+		// decomposition.
+		//
+		// Throws std::length_error if the decomposition needs more than
+		// "MaxRelations" relations.
+		// =====================================================================
+		constexpr StaticSchema NormalizeTo2nf() const {
+
+			StaticSchema normalized = *this;
+			normalized.Normalize();
+
+			return normalized;
+
+		}
+
+	private:
+
+		// Number of a relation that is not final yet and was split off.
+		static constexpr std::size_t UNNAMED = ~std::size_t(0);
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::array<FuncDep, NumFuncDeps> func_deps{};	// Functional deps.
+		std::array<std::string_view, NumAttributes> names{};	// Attributes.
+		std::size_t num_func_deps = 0;		// Used entries of func_deps.
+		std::size_t num_relations = 0;		// Used entries of relations.
+		StaticAttributeSet prime = 0;		// Prime attributes.
+		std::array<Relation, MaxRelations> relations{};	// Relation table.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Returns the set of all attributes.
+		// =====================================================================
+		static constexpr StaticAttributeSet Universe() {
+
+			return NumAttributes == 64 ? ~StaticAttributeSet(0)
+				: (StaticAttributeSet(1) << NumAttributes) - 1;
+
+		}
+
+		// =====================================================================
+		// Returns true if "a" is a proper subset of "b".
+		// =====================================================================
+		static constexpr bool IsProperSubset(StaticAttributeSet a, StaticAttributeSet b) {
+
+			return (a & ~b) == 0 && a != b;
+
+		}
+
+		// =====================================================================
+		// Returns the number of attributes in a set.
+		// =====================================================================
+		static constexpr std::size_t Size(StaticAttributeSet set) {
+
+			std::size_t size = 0;
+
+			for (; set != 0; set &= set - 1)
+				size++;
+
+			return size;
+
+		}
+
+		// =====================================================================
+		// Returns true if, in every relation, every functional dependency
+		// whose lhs is not a superkey of the relation determines only
+		// attributes of "allowed".
+		// =====================================================================
+		constexpr bool CheckRelations(StaticAttributeSet allowed) const {
+
+			for (std::size_t r = 0; r < num_relations; r++) {
+
+				const Relation & relation = relations[r];
+
+				for (std::size_t i = 0; i < num_func_deps; i++) {
+
+					StaticAttributeSet lhs = func_deps[i].lhs;
+
+					if ((lhs & ~relation.attributes) != 0)
+						continue;
+
+					StaticAttributeSet determined = ComputeClosureOf(lhs) & relation.attributes;
+
+					if (determined != relation.attributes && (determined & ~lhs & ~allowed) != 0)
+						return false;
+
+				}
+
+			}
+
+			return num_relations != 0;
+
+		}
+
+		// =====================================================================
+		// Finds a smallest key of all attributes as MinimumKeyFinder does:
+		// attributes never on a rhs, and rhs-only attributes the others do
+		// not determine, are in the key, the rest of it is searched among
+		// the attributes on both sides, and the greedy key bounds the
+		// search.
+		// =====================================================================
+		constexpr StaticAttributeSet FindMinimumKey() const {
+
+			StaticAttributeSet in_lhs = 0;
+			StaticAttributeSet in_rhs = 0;
+
+			for (std::size_t i = 0; i < num_func_deps; i++) {
+				in_lhs |= func_deps[i].lhs;
+				in_rhs |= func_deps[i].rhs;
+			}
+
+			StaticAttributeSet rhs_only = in_rhs & ~in_lhs;
+			StaticAttributeSet core = (Universe() & ~in_rhs)
+				| (rhs_only & ~ComputeClosureOf(Universe() & ~rhs_only));
+			StaticAttributeSet candidates = in_lhs & in_rhs;
+			StaticAttributeSet best = core | candidates;
+
+			for (std::size_t attr = 0; attr < NumAttributes; attr++) {
+
+				StaticAttributeSet bit = StaticAttributeSet(1) << attr;
+
+				if ((candidates & bit) && ComputeClosureOf(best & ~bit) == Universe())
+					best &= ~bit;
+
+			}
+
+			std::size_t best_size = Size(best);
+			SearchMinimumKey(core, Size(core), 0, candidates, best, best_size);
+
+			return best;
+
+		}
+
+		// =====================================================================
+		// Determines the prime attributes as PrimeAttributeFinder does:
+		// attributes never on a rhs are prime, and every other attribute on
+		// both sides is prime if a witness X, not a superkey while X + attr
+		// is, exists.
+		// =====================================================================
+		constexpr void FindPrimeAttributes() {
+
+			StaticAttributeSet in_lhs = 0;
+			StaticAttributeSet in_rhs = 0;
+
+			for (std::size_t i = 0; i < num_func_deps; i++) {
+				in_lhs |= func_deps[i].lhs;
+				in_rhs |= func_deps[i].rhs;
+			}
+
+			StaticAttributeSet core = Universe() & ~in_rhs;
+			StaticAttributeSet both_sides = in_lhs & in_rhs;
+
+			prime = core;
+
+			// Greedy pass.
+			for (std::size_t attr = 0; attr < NumAttributes; attr++) {
+
+				if (!((both_sides >> attr) & 1) || IsPrime(attr))
+					continue;
+
+				prime |= ReduceToKey(core | both_sides, attr, both_sides);
+
+			}
+
+			// Exhaustive pass.
+			for (std::size_t attr = 0; attr < NumAttributes; attr++) {
+
+				if (!((both_sides >> attr) & 1) || IsPrime(attr))
+					continue;
+
+				SearchWitness(core, 0, attr, both_sides);
+
+			}
+
+		}
+
+		// =====================================================================
+		// Parses a functional dependency and inserts it, merging it into a
+		// stored one with the same lhs.
+		// =====================================================================
+		constexpr void InsertFuncDep(std::string_view text) {
+
+			std::size_t arrow = text.find("->");
+
+			if (arrow == std::string_view::npos)
+				throw std::invalid_argument("Malformed functional dependency!");
+
+			StaticAttributeSet lhs = GetAttributeSet(text.substr(0, arrow));
+			StaticAttributeSet rhs = GetAttributeSet(text.substr(arrow + 2)) & ~lhs;
+
+			if (rhs == 0)
+				return;
+
+			for (std::size_t i = 0; i < num_func_deps; i++) {
+
+				if (func_deps[i].lhs == lhs) {
+					func_deps[i].rhs |= rhs;
+					return;
+				}
+
+			}
+
+			func_deps[num_func_deps++] = FuncDep{ lhs, rhs };
+
+		}
+
+		// =====================================================================
+		// Normalizes the global relation to 2NF in place. Relations are
+		// numbered when they become final, as Database::NameRelation() does.
+		// =====================================================================
+		constexpr void Normalize() {
+
+			std::array<Relation, MaxRelations> queue{};
+			std::size_t queue_front = 0;
+			std::size_t queue_size = 0;
+			std::size_t next_number = 1;
+
+			FindPrimeAttributes();
+
+			// Global relation: every lhs that determines all attributes is
+			// a candidate key, and the first smallest one is the primary key.
+			// Without one, a smallest key is the only candidate key.
+			Relation global;
+			global.attributes = Universe();
+
+			for (std::size_t i = 0; i < num_func_deps; i++) {
+
+				if (ComputeClosureOf(func_deps[i].lhs) == Universe())
+					global.candidate_keys[global.num_candidate_keys++] = func_deps[i].lhs;
+
+			}
+
+			if (global.num_candidate_keys == 0)
+				global.candidate_keys[global.num_candidate_keys++] = FindMinimumKey();
+
+			global.primary_key = global.candidate_keys[0];
+
+			for (std::size_t k = 1; k < global.num_candidate_keys; k++) {
+
+				if (Size(global.candidate_keys[k]) < Size(global.primary_key))
+					global.primary_key = global.candidate_keys[k];
+
+			}
+
+			num_relations = 0;
+			queue[queue_size++] = global;
+
+			while (queue_size != 0) {
+
+				Relation next = queue[queue_front];
+				queue_front = (queue_front + 1) % MaxRelations;
+				queue_size--;
+
+				std::array<Relation, NumFuncDeps + 1> decomposed{};
+				std::size_t num_decomposed = RelationTo2nf(next, decomposed);
+
+				if (num_decomposed == 1) {
+
+					if (num_relations == MaxRelations)
+						throw std::length_error("Too many relations for the StaticSchema!");
+
+					if (decomposed[0].number == UNNAMED)
+						decomposed[0].number = next_number++;
+
+					relations[num_relations++] = decomposed[0];
+
+				}
+				else {
+
+					for (std::size_t d = 0; d < num_decomposed; d++) {
+
+						if (queue_size == MaxRelations)
+							throw std::length_error("Too many relations for the StaticSchema!");
+
+						queue[(queue_front + queue_size) % MaxRelations] = decomposed[d];
+						queue_size++;
+
+					}
+
+				}
+
+			}
+
+		}
+
+		// =====================================================================
+		// Reduces a superkey to a candidate key, trying to remove "last"
+		// last, as PrimeAttributeFinder::ReduceToKey() does.
+		// =====================================================================
+		constexpr StaticAttributeSet ReduceToKey(StaticAttributeSet key,
+			std::size_t last, StaticAttributeSet both_sides) const {
+
+			for (std::size_t attr = 0; attr < NumAttributes; attr++) {
+
+				StaticAttributeSet bit = StaticAttributeSet(1) << attr;
+
+				if (!(both_sides & bit) || attr == last || !(key & bit))
+					continue;
+
+				if (ComputeClosureOf(key & ~bit) == Universe())
+					key &= ~bit;
+
+			}
+
+			StaticAttributeSet bit = StaticAttributeSet(1) << last;
+
+			if ((key & bit) && ComputeClosureOf(key & ~bit) == Universe())
+				key &= ~bit;
+
+			return key;
+
+		}
+
+		// =====================================================================
+		// Decomposes a relation one step as Database::RelationTo2nf() does.
+		// Returns the number of relations in "decomposed", the remaining
+		// relation first.
+		// =====================================================================
+		constexpr std::size_t RelationTo2nf(const Relation & relation,
+			std::array<Relation, NumFuncDeps + 1> & decomposed) const {
+
+			std::size_t num_decomposed = 1;
+
+			decomposed[0] = relation;
+
+			if (Size(relation.primary_key) == 1)
+				return num_decomposed;
+
+			for (std::size_t i = 0; i < num_func_deps; i++) {
+
+				StaticAttributeSet lhs = func_deps[i].lhs;
+
+				if ((lhs & ~relation.attributes) != 0 || !IsProperSubset(lhs, relation.primary_key))
+					continue;
+
+				StaticAttributeSet moved = ComputeClosureOf(lhs) & relation.attributes
+					& ~lhs & decomposed[0].attributes & ~prime;
+
+				if (moved == 0)
+					continue;
+
+				Relation & split = decomposed[num_decomposed++];
+				split.candidate_keys[0] = lhs;
+				split.num_candidate_keys = 1;
+				split.primary_key = lhs;
+				split.attributes = lhs | moved;
+				split.number = UNNAMED;
+				decomposed[0].attributes &= ~moved;
+
+			}
+
+			if (num_decomposed > 1) {
+
+				// Keep only the candidate keys that survived in the remaining
+				// relation.
+				Relation & remaining = decomposed[0];
+				std::size_t kept = 0;
+
+				for (std::size_t k = 0; k < remaining.num_candidate_keys; k++) {
+
+					if ((remaining.candidate_keys[k] & ~remaining.attributes) == 0)
+						remaining.candidate_keys[kept++] = remaining.candidate_keys[k];
+
+				}
+
+				remaining.num_candidate_keys = kept;
+
+			}
+
+			return num_decomposed;
+
+		}
+
+		// =====================================================================
+		// Searches for a key smaller than "best", grown from "x" with
+		// candidates from "next" on, as MinimumKeyFinder::Search() does.
+		// =====================================================================
+		constexpr void SearchMinimumKey(StaticAttributeSet x, std::size_t size,
+			std::size_t next, StaticAttributeSet candidates,
+			StaticAttributeSet & best, std::size_t & best_size) const {
+
+			StaticAttributeSet closure = ComputeClosureOf(x);
+
+			if (closure == Universe()) {
+
+				if (size < best_size) {
+					best = x;
+					best_size = size;
+				}
+
+				return;
+
+			}
+
+			StaticAttributeSet left = next >= NumAttributes ? 0
+				: candidates & ~((StaticAttributeSet(1) << next) - 1);
+
+			if (size + 1 >= best_size || left == 0
+				|| ComputeClosureOf(x | left) != Universe())
+				return;
+
+			for (std::size_t attr = next; attr < NumAttributes; attr++) {
+
+				StaticAttributeSet bit = StaticAttributeSet(1) << attr;
+
+				if (!(candidates & bit) || (closure & bit))
+					continue;
+
+				SearchMinimumKey(x | bit, size + 1, attr + 1, candidates, best, best_size);
+
+				if (size + 1 >= best_size)
+					return;
+
+			}
+
+		}
+
+		// =====================================================================
+		// Searches for a witness X, grown from "x" with both-sides attributes
+		// from "next" on, that proves "attr" prime, as
+		// PrimeAttributeFinder::SearchWitness() does.
+		// =====================================================================
+		constexpr bool SearchWitness(StaticAttributeSet x, std::size_t next,
+			std::size_t attr, StaticAttributeSet both_sides) {
+
+			StaticAttributeSet closure = ComputeClosureOf(x);
+			StaticAttributeSet bit = StaticAttributeSet(1) << attr;
+
+			if (closure & bit)
+				return false;
+
+			if (ComputeClosureOf(x | bit) == Universe()) {
+				prime |= ReduceToKey(x | bit, attr, both_sides);
+				return true;
+			}
+
+			for (std::size_t other = next; other < NumAttributes; other++) {
+
+				StaticAttributeSet other_bit = StaticAttributeSet(1) << other;
+
+				if (!(both_sides & other_bit) || other == attr || (closure & other_bit))
+					continue;
+
+				if (SearchWitness(x | other_bit, other + 1, attr, both_sides))
+					return true;
+
+			}
+
+			return false;
+
+		}
+
+	};
+
+}
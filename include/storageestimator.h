@@ -0,0 +1,218 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "database.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Storage model of a StorageEstimator: the bytes a value of every
+	// AttributeType takes and the fixed bytes every row takes.
+	// =========================================================================
+	struct StorageModel {
+
+		double int_bytes = 4.0;				// Bytes per Int value.
+		double float_bytes = 8.0;			// Bytes per Float value.
+		double string_bytes = 32.0;			// Bytes per String value.
+		double row_overhead_bytes = 24.0;	// Header bytes per row.
+
+	};
+
+	// =========================================================================
+	// Estimated storage of one relation.
+	// =========================================================================
+	struct RelationStorage {
+
+		std::string name;
+		double rows = 0.0;					// Estimated rows.
+		double row_bytes = 0.0;				// Bytes per row.
+		double total_bytes = 0.0;			// rows * row_bytes.
+		double join_column_bytes = 0.0;		// Part of total_bytes spent on
+											// attributes shared with other
+											// relations.
+
+	};
+
+	// =========================================================================
+	// Estimated storage of a Database before and after normalization.
+	// =========================================================================
+	struct StorageReport {
+
+		RelationStorage global;				// All attributes in one relation.
+		std::vector<RelationStorage>
+			relations;						// Every relation of the relation
+											// table.
+		double normalized_bytes = 0.0;		// Total bytes of "relations".
+		double saved_bytes = 0.0;			// Global minus normalized bytes.
+		double join_column_bytes = 0.0;		// Bytes of "relations" spent on
+											// the columns they are joined on.
+		std::size_t joins = 0;				// Joins that reassemble the
+											// global relation.
+
+	};
+
+	// =========================================================================
+	// StorageEstimator class that estimates the bytes per row and the total
+	// storage of the global relation and of every relation in the relation
+	// table of a normalized Database, so that the redundancy a normalization
+	// removes can be weighed against the joins it adds.
+	//
+	// The global relation holds all attributes in the given number of rows.
+	// A relation of the decomposition holds one row per distinct value of
+	// its primary key, estimated as the product of the distinct counts of
+	// the key's attributes, capped at the global row count. Attributes
+	// without a distinct count, and relations without a primary key, keep
+	// the global row count, so the estimate never overstates the savings.
+	// The row count of a relation may also be given directly.
+	// =========================================================================
+	class StorageEstimator {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		// =====================================================================
+		// "_db":
+		//		Normalized Database whose relations are estimated. Must
+		//		outlive the estimator.
+		//
+		// "_model":
+		//		Bytes per value of every type and per row.
+		// =====================================================================
+		StorageEstimator(const Database & _db, StorageModel _model = StorageModel());
+		~StorageEstimator() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Estimates the storage of the global relation and of every
+		// relation in the relation table.
+		//
+		// Returns the estimates.
+		// =====================================================================
+		StorageReport Estimate();
+
+		// =====================================================================
+		// Estimates the rows of a relation: its given row count, or else
+		// the number of distinct values of its primary key, capped at the
+		// rows of the global relation.
+		//
+		// "relation":
+		//		Relation of the relation table.
+		// =====================================================================
+		double EstimateRows(const Relation & relation) const;
+
+		// =====================================================================
+		// Returns the number of distinct values of an attribute, or 0 if
+		// it is unknown.
+		// =====================================================================
+		double GetDistinct(AttributeTblIndex attr) const { return distinct[attr]; };
+
+		// =====================================================================
+		// Returns the number of rows of the global relation.
+		// =====================================================================
+		double GetRows() const { return global_rows; };
+
+		// =====================================================================
+		// Reads a statistics file. See ReadStatistics() for its format.
+		//
+		// "path":
+		//		Path of the statistics file.
+		//
+		// Throws std::runtime_error if the file cannot be opened.
+		// =====================================================================
+		void LoadStatistics(const std::string & path);
+
+		// =====================================================================
+		// Prints a report.
+		//
+		// "report":
+		//		Report returned by Estimate().
+		// =====================================================================
+		void Print(const StorageReport & report);
+
+		// =====================================================================
+		// Reads statistics, one per line:
+		//
+		//		rows <count>				Rows of the global relation.
+		//		distinct <attr> <count>		Distinct values of an attribute.
+		//		relation <name> <count>		Rows of a relation.
+		//		bytes <int|float|string|row> <count>
+		//									Bytes per value of a type, or
+		//									per row.
+		//
+		// Empty lines and lines starting with '#' are skipped.
+		//
+		// "stream":
+		//		Stream to read until its end.
+		//
+		// Throws std::invalid_argument if a line is malformed or names an
+		// unknown attribute.
+		// =====================================================================
+		void ReadStatistics(std::istream & stream);
+
+		// =====================================================================
+		// Sets the number of distinct values of an attribute.
+		//
+		// "attr_name":
+		//		Name of the attribute.
+		//
+		// "distinct":
+		//		Number of distinct values.
+		//
+		// Throws std::invalid_argument if the attribute is unknown.
+		// =====================================================================
+		void SetDistinct(const std::string & attr_name, double distinct);
+
+		// =====================================================================
+		// Sets the number of rows of a relation of the relation table,
+		// overriding its estimate.
+		//
+		// "relation_name":
+		//		Name of the relation.
+		//
+		// "rows":
+		//		Number of rows.
+		// =====================================================================
+		void SetRelationRows(const std::string & relation_name, double rows);
+
+		// =====================================================================
+		// Sets the number of rows of the global relation.
+		//
+		// "rows":
+		//		Number of rows.
+		// =====================================================================
+		void SetRows(double rows) { global_rows = rows; };
+
+	private:
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		const Database & db;				// Estimated database.
+		std::vector<double> distinct;		// Distinct values per attribute;
+											// 0 if unknown.
+		double global_rows;					// Rows of the global relation.
+		StorageModel model;					// Bytes per value and per row.
+		std::unordered_map<std::string, double>
+			relation_rows;					// Given rows per relation name.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		double AttributeBytes(AttributeTblIndex attr);
+
+	};
+
+}
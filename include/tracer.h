@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Tracer class that records timed events from any thread and writes them
+	// in the Chrome trace-event JSON format, which can be opened in
+	// chrome://tracing or Perfetto to view one timeline per thread.
+	//
+	// Tracing is optional: instrumented code holds a Tracer pointer that is
+	// null when tracing is disabled, and every recording helper returns
+	// immediately on a null pointer. Event names and categories must be
+	// string literals; they are stored as pointers.
+	// =========================================================================
+	class Tracer {
+
+	public:
+
+	// =========================================================================
+	// Constructors and Destructors
+	// =========================================================================
+
+		Tracer();
+		~Tracer() {};
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		// =====================================================================
+		// Records an event that spans an interval.
+		//
+		// "name", "category":
+		//		Name and category of the event.
+		//
+		// "start_us":
+		//		Start of the event, as returned by NowMicros().
+		//
+		// "arg_name", "arg_value":
+		//		Optional argument shown with the event. Ignored if "arg_name"
+		//		is null.
+		// =====================================================================
+		void Complete(const char * name, const char * category,
+			std::int64_t start_us, const char * arg_name = nullptr,
+			std::int64_t arg_value = 0);
+
+		// =====================================================================
+		// Records an event that happens at one point in time.
+		//
+		// "name", "category", "arg_name", "arg_value":
+		//		See Complete().
+		// =====================================================================
+		void Instant(const char * name, const char * category,
+			const char * arg_name = nullptr, std::int64_t arg_value = 0);
+
+		// =====================================================================
+		// Returns the microseconds elapsed since the Tracer was constructed.
+		// =====================================================================
+		std::int64_t NowMicros() const;
+
+		// =====================================================================
+		// Returns the trace id of the calling thread. Threads are numbered
+		// from 1 in the order in which they first record an event or ask
+		// for their id.
+		// =====================================================================
+		std::uint32_t ThreadId();
+
+		// =====================================================================
+		// Writes every recorded event as Chrome trace-event JSON.
+		//
+		// "stream":
+		//		Stream to write to.
+		// =====================================================================
+		void Write(std::ostream & stream);
+
+		// =====================================================================
+		// Writes every recorded event as Chrome trace-event JSON to a file.
+		//
+		// "path":
+		//		Path of the file to write.
+		//
+		// Throws std::runtime_error if the file cannot be written.
+		// =====================================================================
+		void Write(const std::string & path);
+
+	private:
+
+	// =========================================================================
+	// Types
+	// =========================================================================
+
+		struct TraceEvent {
+
+			const char * name;
+			const char * category;
+			char phase;						// 'X' complete or 'i' instant.
+			std::int64_t start_us;
+			std::int64_t duration_us;
+			std::uint32_t thread_id;
+			const char * arg_name;
+			std::int64_t arg_value;
+
+		};
+
+	// =========================================================================
+	// Data members
+	// =========================================================================
+
+		std::vector<TraceEvent> events;		// Recorded events.
+		std::mutex mutex;					// Guards events and thread_ids.
+		std::chrono::steady_clock::time_point
+			start;							// Time the Tracer was created.
+		std::unordered_map<std::thread::id, std::uint32_t>
+			thread_ids;						// Trace id of every thread.
+
+	// =========================================================================
+	// Member functions
+	// =========================================================================
+
+		void Record(TraceEvent event);
+		std::uint32_t ThreadIdLocked();
+
+	};
+
+	// =========================================================================
+	// Records a Complete() event spanning its own lifetime. Does nothing if
+	// the Tracer is null.
+	// =========================================================================
+	class TraceScope {
+
+	public:
+
+		TraceScope(Tracer * _tracer, const char * _name, const char * _category,
+			const char * _arg_name = nullptr, std::int64_t _arg_value = 0)
+			: tracer(_tracer), name(_name), category(_category),
+			arg_name(_arg_name), arg_value(_arg_value),
+			start_us(_tracer ? _tracer->NowMicros() : 0) {};
+
+		~TraceScope() {
+			if (tracer)
+				tracer->Complete(name, category, start_us, arg_name, arg_value);
+		};
+
+		TraceScope(const TraceScope &) = delete;
+		TraceScope & operator=(const TraceScope &) = delete;
+
+	private:
+
+		Tracer * tracer;
+		const char * name;
+		const char * category;
+		const char * arg_name;
+		std::int64_t arg_value;
+		std::int64_t start_us;
+
+	};
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <istream>
 #include <string>
 
 #include "database.h"
@@ -36,13 +37,32 @@ namespace DbNormalizerCpp {
 		// =====================================================================
 		Database Parse() {
 
+			return Parse(fileStream);
+
+		}
+
+		// =====================================================================
+		// Parses the contents of a .txt file from a stream, e.g., a request
+		// read by a NormalizationServer.
+		//
+		// "stream":
+		//		Stream to parse until its end.
+		//
+		// Returns a Database initialized with name, 
+		// universal set of attributes, and set of functional dependencies.
+		// =====================================================================
+		Database Parse(std::istream & stream) {
+
 			enum LineType { DbName, AttrSet, FuncDep };
 
+			TraceScope trace(tracer, "parse", "parse");
 			LineType line_type = LineType::DbName;
 			Database db;
 			std::string line;
 
-			while (std::getline(fileStream, line)) {
+			db.SetTracer(tracer);
+
+			while (std::getline(stream, line)) {
 
 
 				if (line == "" || line[0] == '#') // Empty line or comment.
@@ -73,6 +93,7 @@ namespace DbNormalizerCpp {
 
 		void AddAttributeNameToFuncDep(SimpleFuncDep & func_dep, const std::string & attr_name, bool processing_left);
 		void ProcessDbName(Database & db, const std::string & line);
+		void ProcessAttr(Database & db, const std::string & token);
 		void ProcessAttrSet(Database & db, const std::string & line);
 		void ProcessFuncDep(Database & db, const std::string & line);
 
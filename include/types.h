@@ -1,12 +1,21 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <memory_resource>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "attributeset.h"
+
 // =============================================================================
 // This file consists of program-defined types used by DbNormalizer++.
+//
+// Containers used during normalization are polymorphic-allocator (std::pmr)
+// containers so that a normalization run can allocate them from its own 
+// arena. Outside of a run, they allocate from the default resource.
 // =============================================================================
 
 namespace DbNormalizerCpp {
@@ -24,16 +33,18 @@ namespace DbNormalizerCpp {
 
 	using AttributeTblIndex = unsigned int;
 	using FuncDepTblIndex = unsigned int;
+	using MultiValuedDepTblIndex = unsigned int;
 	using RelationTblIndex = unsigned int;
 
 	// =========================================================================
 	// Core types
 	// =========================================================================
 
-	using AttributeSet = std::unordered_set<AttributeTblIndex>;
+	using AttributeSet = HybridAttributeSet;
 	using Lhs = AttributeSet;
 	using Rhs = AttributeSet;
 	using FuncDep = std::pair<Lhs, Rhs>;
+	using MultiValuedDep = std::pair<Lhs, Rhs>;
 	using GlobalRelation = Relation;
 
 	// =========================================================================
@@ -45,6 +56,15 @@ namespace DbNormalizerCpp {
 	// =========================================================================
 
 	using FuncDepTable = std::vector<FuncDep>;
+	using MultiValuedDepTable = std::vector<MultiValuedDep>;
+
+	// =========================================================================
+	// Lists
+	// =========================================================================
+
+	using FuncDepTblIndexList = std::vector<FuncDepTblIndex>;
+	using SortedAttributeList = std::vector<AttributeTblIndex>;
+	using DependencyBasis = std::vector<AttributeSet>;
 
 	// =========================================================================
 	// Maps
@@ -52,20 +72,40 @@ namespace DbNormalizerCpp {
 
 	using AttributeIndexMap = std::unordered_map<std::string, AttributeTblIndex>;
 
+	// Hashes a SortedAttributeList.
+	struct SortedAttributeListHash {
+
+		std::size_t operator()(const SortedAttributeList & list) const {
+
+			std::size_t hash = list.size();
+
+			for (AttributeTblIndex attr : list)
+				hash ^= attr + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+			return hash;
+
+		}
+
+	};
+
+	// Maps the sorted lhs of every functional dependency to its index.
+	using LhsIndexMap = std::unordered_map<SortedAttributeList, FuncDepTblIndex,
+		SortedAttributeListHash>;
+
 	// =========================================================================
 	// Keys
 	// =========================================================================
 
 	using PrimaryKey = AttributeSet;
 	using CandidateKey = AttributeSet;
-	using CandidateKeyList = std::vector<CandidateKey>;
+	using CandidateKeyList = std::pmr::vector<CandidateKey>;
 
 	// =========================================================================
 	// Closure
 	// =========================================================================
 
 	using AttributeSetClosure = std::pair<FuncDepTblIndex, Rhs>;
-	using FuncDepSetClosure = std::vector<AttributeSetClosure>;
+	using FuncDepSetClosure = std::pmr::vector<AttributeSetClosure>;
 	
 	using AttributeSetClosureIndex = unsigned int;
 	using FuncDepSetClosureIndex = unsigned int;
@@ -74,7 +114,26 @@ namespace DbNormalizerCpp {
 	// Queues
 	// =========================================================================
 
-	using NormalizationQueue = std::queue<Relation>;
+	using NormalizationQueue = std::queue<Relation, std::pmr::deque<Relation>>;
+
+	// =========================================================================
+	// Packed attribute sets
+	//
+	// Bit i of word i / 64 is set iff attribute table index i is in the set.
+	// Used by algorithms that repeatedly intersect and subtract sets.
+	// =========================================================================
+
+	using PackedAttributeSet = std::vector<std::uint64_t>;
+
+	// =========================================================================
+	// Data
+	//
+	// Used when reading data files, e.g., .csv files, where every distinct 
+	// value of a column is dictionary-encoded as a ValueCode.
+	// =========================================================================
+
+	using RowIndex = std::uint32_t;
+	using ValueCode = std::uint32_t;
 
 	// =========================================================================
 	// Used as an easy interface for insertion.
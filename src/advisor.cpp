@@ -0,0 +1,764 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "advisor.h"
+#include "packedfuncdeps.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a DecompositionAdvisor with an empty workload and no
+	// statistics, i.e., one row per table.
+	// =========================================================================
+	DecompositionAdvisor::DecompositionAdvisor(const Database & _db,
+		AdvisorCostModel _cost_model, std::size_t _search_budget)
+		: best_cost(0.0), cost_model(_cost_model), db(_db),
+		distinct(_db.GetAttributeTable().size(), 0.0), global_rows(1.0),
+		min_rows(1.0), nodes(0), num_words((_db.GetAttributeTable().size() + 63) / 64),
+		search_budget(_search_budget) {}
+
+	// =========================================================================
+	// Adds a query to the workload.
+	// =========================================================================
+	void DecompositionAdvisor::AddQuery(const std::vector<std::string> &
+		attr_names, double frequency) {
+
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+		WorkloadQuery query;
+
+		query.frequency = frequency;
+
+		for (const std::string & attr_name : attr_names) {
+
+			AttributeTblIndex index = 0;
+
+			while (index < attribute_table.size() && attribute_table[index].name != attr_name)
+				index++;
+
+			if (index == attribute_table.size())
+				throw std::invalid_argument("Unknown attribute '" + attr_name + "'!");
+
+			query.attributes.insert(index);
+
+		}
+
+		workload.push_back(query);
+
+	}
+
+	// =========================================================================
+	// Adds a relation to a table of a grouping. A table index equal to the
+	// number of tables opens a new table.
+	//
+	// "grouping":
+	//		Grouping to extend.
+	//
+	// "relation":
+	//		Index of the relation in the relation table.
+	//
+	// "table":
+	//		Table to add the relation to.
+	// =========================================================================
+	void DecompositionAdvisor::AddToTable(Grouping & grouping,
+		std::size_t relation, std::size_t table) {
+
+		if (table == grouping.tables.size()) {
+			grouping.tables.push_back(relations[relation]);
+			grouping.widths.push_back(0);
+			grouping.rows.push_back(relation_rows[relation]);
+		}
+		else {
+
+			for (std::size_t w = 0; w < num_words; w++)
+				grouping.tables[table][w] |= relations[relation][w];
+
+			grouping.rows[table] = std::max(grouping.rows[table], relation_rows[relation]);
+
+		}
+
+		grouping.widths[table] = CountPackedAttributes(grouping.tables[table]);
+		grouping.group_of.push_back(table);
+
+	}
+
+	// =========================================================================
+	// Searches for the cheapest grouping of the relations.
+	// =========================================================================
+	AdvisorRecommendation DecompositionAdvisor::Advise(unsigned int max_threads) {
+
+		const RelationTable & relation_table = db.GetRelationTable();
+		std::size_t num_relations = relation_table.size();
+
+		if (num_relations == 0)
+			throw std::invalid_argument("The database has no relations to advise on!");
+
+		PackedFuncDepTable packed_func_deps(db.GetFuncDepTable(), db.GetAttributeTable().size());
+
+		relations.clear();
+		keys.clear();
+		key_closures.clear();
+		queries.clear();
+		unassigned.assign(num_relations + 1, PackedAttributeSet(num_words, 0));
+		nodes = 0;
+
+		if (relation_rows.size() != num_relations)
+			relation_rows.assign(num_relations, 1.0);
+
+		min_rows = *std::min_element(relation_rows.begin(), relation_rows.end());
+
+		for (std::size_t i = 0; i < num_relations; i++) {
+			relations.push_back(PackAttributes(relation_table[i].attributes, num_words));
+			keys.push_back(PackAttributes(relation_table[i].primary_key, num_words));
+			key_closures.push_back(packed_func_deps.ComputeClosureOf(keys.back()));
+		}
+
+		for (std::size_t q = 0; q < workload.size(); q++)
+			queries.push_back(PackAttributes(workload[q].attributes, num_words));
+
+		for (std::size_t i = num_relations; i-- > 0; ) {
+
+			for (std::size_t w = 0; w < num_words; w++)
+				unassigned[i][w] = unassigned[i + 1][w] | relations[i][w];
+
+		}
+
+		// The normalized relation table is the first candidate, so every
+		// branch that cannot beat it is pruned.
+		Grouping normalized;
+
+		for (std::size_t i = 0; i < num_relations; i++)
+			AddToTable(normalized, i, i);
+
+		AdvisorRecommendation recommendation;
+
+		recommendation.normalized_cost = ComputeBound(normalized, num_relations);
+		best_cost = recommendation.normalized_cost;
+		best_group_of = normalized.group_of;
+
+		// Split the search into partition prefixes, i.e., restricted growth
+		// strings of the first relations, so that threads share the work.
+		std::vector<std::vector<std::size_t>> prefixes(1);
+		std::size_t depth = 0;
+
+		while (depth < num_relations && prefixes.size() < 8 * std::max(max_threads, 1u)) {
+
+			std::vector<std::vector<std::size_t>> longer;
+
+			for (const std::vector<std::size_t> & prefix : prefixes) {
+
+				std::size_t num_tables = prefix.empty() ? 0
+					: *std::max_element(prefix.begin(), prefix.end()) + 1;
+
+				for (std::size_t table = 0; table <= num_tables; table++) {
+					longer.push_back(prefix);
+					longer.back().push_back(table);
+				}
+
+			}
+
+			prefixes.swap(longer);
+			depth++;
+
+		}
+
+		std::atomic<std::size_t> next_prefix(0);
+
+		auto worker = [&]() {
+
+			for (std::size_t p = next_prefix++; p < prefixes.size(); p = next_prefix++) {
+
+				Grouping grouping;
+
+				for (std::size_t i = 0; i < depth; i++)
+					AddToTable(grouping, i, prefixes[p][i]);
+
+				Search(grouping, depth);
+
+			}
+
+		};
+
+		unsigned int num_threads = static_cast<unsigned int>(
+			std::min<std::size_t>(std::max(max_threads, 1u), prefixes.size()));
+
+		if (num_threads <= 1) {
+			worker();
+		}
+		else {
+
+			std::vector<std::thread> threads;
+
+			for (unsigned int t = 0; t < num_threads; t++)
+				threads.push_back(std::thread(worker));
+
+			for (std::thread & thread : threads)
+				thread.join();
+
+		}
+
+		std::size_t num_tables = *std::max_element(best_group_of.begin(), best_group_of.end()) + 1;
+
+		recommendation.groups.resize(num_tables);
+
+		for (RelationTblIndex i = 0; i < num_relations; i++)
+			recommendation.groups[best_group_of[i]].push_back(i);
+
+		for (const std::vector<RelationTblIndex> & group : recommendation.groups)
+			recommendation.relations.push_back(MergeRelations(group));
+
+		recommendation.cost = best_cost;
+		recommendation.nodes_explored = std::min<std::size_t>(nodes, search_budget);
+		recommendation.budget_exhausted = nodes > search_budget;
+
+		return recommendation;
+
+	}
+
+	// =========================================================================
+	// Computes a lower bound on the workload cost of every grouping that
+	// extends a partial grouping. Exact once every relation is assigned.
+	//
+	// "grouping":
+	//		Tables of the relations assigned so far.
+	//
+	// "next":
+	//		Index of the first unassigned relation.
+	// =========================================================================
+	double DecompositionAdvisor::ComputeBound(const Grouping & grouping,
+		std::size_t next) {
+
+		double bound = 0.0;
+
+		for (std::size_t q = 0; q < queries.size(); q++)
+			bound += ComputeQueryCost(q, grouping, unassigned[next]);
+
+		return bound;
+
+	}
+
+	// =========================================================================
+	// Finds the cheapest set of tables that covers a set of attributes by
+	// branching on the tables that contain its first uncovered attribute.
+	// The tables are joined into the largest one, so every row of the
+	// others is joined once. Adding a table never lowers the cost, so a
+	// branch stops as soon as it reaches "best".
+	//
+	// "uncovered":
+	//		Attributes still to cover.
+	//
+	// "grouping":
+	//		Tables to choose from.
+	//
+	// "scan_cost":
+	//		Bytes scanned in the tables chosen so far.
+	//
+	// "joined_rows":
+	//		Rows of the tables chosen so far.
+	//
+	// "largest_rows":
+	//		Rows of the largest table chosen so far.
+	//
+	// "best":
+	//		Cost of the cheapest cover found so far.
+	//
+	// Returns the cost of the cheapest cover, or "best" if none is cheaper.
+	// =========================================================================
+	double DecompositionAdvisor::ComputeCoverCost(const PackedAttributeSet &
+		uncovered, const Grouping & grouping, double scan_cost,
+		double joined_rows, double largest_rows, double best) {
+
+		double cost = scan_cost + cost_model.join_cost * (joined_rows - largest_rows);
+
+		if (cost >= best)
+			return best;
+
+		std::size_t w = 0;
+
+		while (w < num_words && uncovered[w] == 0)
+			w++;
+
+		if (w == num_words)
+			return cost;
+
+		std::size_t bit = 0;
+
+		while (!(uncovered[w] & (std::uint64_t(1) << bit)))
+			bit++;
+
+		for (std::size_t t = 0; t < grouping.tables.size(); t++) {
+
+			if (!(grouping.tables[t][w] & (std::uint64_t(1) << bit)))
+				continue;
+
+			PackedAttributeSet rest(num_words);
+
+			for (std::size_t v = 0; v < num_words; v++)
+				rest[v] = uncovered[v] & ~grouping.tables[t][v];
+
+			double table_cost = cost_model.attribute_bytes * grouping.widths[t] * grouping.rows[t];
+
+			best = ComputeCoverCost(rest, grouping, scan_cost + table_cost,
+				joined_rows + grouping.rows[t], std::max(largest_rows, grouping.rows[t]), best);
+
+		}
+
+		return best;
+
+	}
+
+	// =========================================================================
+	// Computes a lower bound on the cost of one query under every grouping
+	// that extends a partial grouping. Attributes in "free" may be covered
+	// by unassigned relations, which are assumed to cost nothing. A query
+	// always scans at least its own attributes in as many rows as the
+	// smallest relation has.
+	//
+	// "query":
+	//		Index of the query in the workload.
+	//
+	// "grouping":
+	//		Tables of the relations assigned so far.
+	//
+	// "free":
+	//		Attributes of the unassigned relations.
+	// =========================================================================
+	double DecompositionAdvisor::ComputeQueryCost(std::size_t query,
+		const Grouping & grouping, const PackedAttributeSet & free) {
+
+		PackedAttributeSet uncovered(num_words);
+
+		for (std::size_t w = 0; w < num_words; w++)
+			uncovered[w] = queries[query][w] & ~free[w];
+
+		double cover_cost = ComputeCoverCost(uncovered, grouping, 0.0, 0.0, 0.0,
+			std::numeric_limits<double>::infinity());
+		double scan_cost = cost_model.attribute_bytes * CountPackedAttributes(queries[query])
+			* min_rows;
+
+		return workload[query].frequency * std::max(cover_cost, scan_cost);
+
+	}
+
+	// =========================================================================
+	// Estimates the rows of a table keyed by a set of attributes, like
+	// StorageEstimator: the product of the distinct counts of the key's
+	// attributes, capped at the rows of the global relation. A key that is
+	// empty or has an attribute without a distinct count keeps the global
+	// row count.
+	//
+	// "key":
+	//		Packed primary key of the table.
+	// =========================================================================
+	double DecompositionAdvisor::EstimateKeyRows(const PackedAttributeSet & key) {
+
+		double key_values = 1.0;
+		bool empty = true;
+
+		for (std::size_t w = 0; w < num_words; w++) {
+
+			for (std::uint64_t bits = key[w]; bits != 0; bits &= bits - 1) {
+
+				AttributeTblIndex attr = w * 64 + __builtin_ctzll(bits);
+
+				if (distinct[attr] <= 0.0)
+					return global_rows;
+
+				key_values *= distinct[attr];
+				empty = false;
+
+			}
+
+		}
+
+		return empty ? global_rows : std::min(key_values, global_rows);
+
+	}
+
+	// =========================================================================
+	// Estimates the rows of every table of a complete grouping that merges
+	// several relations from the primary key MergeRelations() gives it: the
+	// smallest primary key of its relations whose closure covers the table,
+	// or else the union of their primary keys. A table keeps at least the
+	// rows of its largest relation, so the estimate never falls below the
+	// bound the search pruned with.
+	//
+	// "grouping":
+	//		Complete grouping whose rows are estimated.
+	// =========================================================================
+	void DecompositionAdvisor::EstimateRows(Grouping & grouping) {
+
+		std::size_t num_tables = grouping.tables.size();
+		std::vector<PackedAttributeSet> merged_keys(num_tables, PackedAttributeSet(num_words, 0));
+		std::vector<std::size_t> num_parts(num_tables, 0);
+
+		for (std::size_t i = 0; i < grouping.group_of.size(); i++) {
+
+			std::size_t table = grouping.group_of[i];
+
+			for (std::size_t w = 0; w < num_words; w++)
+				merged_keys[table][w] |= keys[i][w];
+
+			num_parts[table]++;
+
+		}
+
+		std::vector<std::size_t> key_sizes(num_tables);
+
+		for (std::size_t t = 0; t < num_tables; t++)
+			key_sizes[t] = CountPackedAttributes(merged_keys[t]);
+
+		for (std::size_t i = 0; i < grouping.group_of.size(); i++) {
+
+			std::size_t table = grouping.group_of[i];
+			std::size_t key_size = CountPackedAttributes(keys[i]);
+			bool covers = true;
+
+			for (std::size_t w = 0; w < num_words; w++)
+				covers = covers && (grouping.tables[table][w] & ~key_closures[i][w]) == 0;
+
+			if (num_parts[table] > 1 && covers && key_size < key_sizes[table]) {
+				merged_keys[table] = keys[i];
+				key_sizes[table] = key_size;
+			}
+
+		}
+
+		for (std::size_t t = 0; t < num_tables; t++) {
+
+			if (num_parts[t] > 1)
+				grouping.rows[t] = std::max(grouping.rows[t], EstimateKeyRows(merged_keys[t]));
+
+		}
+
+	}
+
+	// =========================================================================
+	// Reads a workload file.
+	// =========================================================================
+	void DecompositionAdvisor::LoadWorkload(const std::string & path) {
+
+		std::ifstream stream(path);
+
+		if (!stream)
+			throw std::runtime_error("Could not open workload file '" + path + "'!");
+
+		ReadWorkload(stream);
+
+	}
+
+	// =========================================================================
+	// Merges relations of the relation table into one table. Its primary key
+	// is the smallest primary key among the relations that determines the
+	// whole table, or else the union of their primary keys.
+	//
+	// "group":
+	//		Indexes of the relations to merge.
+	//
+	// Returns the merged relation. Its closure is not computed.
+	// =========================================================================
+	Relation DecompositionAdvisor::MergeRelations(const std::vector<RelationTblIndex> & group) {
+
+		const RelationTable & relation_table = db.GetRelationTable();
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+		Relation merged;
+		PrimaryKey keys;
+
+		for (RelationTblIndex i : group) {
+
+			merged.name += (merged.name.empty() ? "" : "_") + relation_table[i].name;
+			merged.attributes.UnionWith(relation_table[i].attributes);
+			keys.UnionWith(relation_table[i].primary_key);
+
+		}
+
+		merged.primary_key = keys;
+
+		for (RelationTblIndex i : group) {
+
+			const PrimaryKey & key = relation_table[i].primary_key;
+
+			if (key.size() >= merged.primary_key.size())
+				continue;
+
+			AttributeSet closure = key;
+			bool grown;
+
+			do {
+
+				grown = false;
+
+				for (const FuncDep & func_dep : func_dep_table) {
+
+					if (func_dep.first.IsSubsetOf(closure) && closure.UnionWith(func_dep.second) > 0)
+						grown = true;
+
+				}
+
+			} while (grown);
+
+			if (merged.attributes.IsSubsetOf(closure))
+				merged.primary_key = key;
+
+		}
+
+		merged.candidate_keys.push_back(merged.primary_key);
+
+		return merged;
+
+	}
+
+	// =========================================================================
+	// Prints a recommendation and the cost of every query under it.
+	// =========================================================================
+	void DecompositionAdvisor::Print(const AdvisorRecommendation & recommendation) {
+
+		Grouping grouping;
+		std::vector<std::size_t> group_of(relations.size());
+
+		for (std::size_t t = 0; t < recommendation.groups.size(); t++) {
+
+			for (RelationTblIndex i : recommendation.groups[t])
+				group_of[i] = t;
+
+		}
+
+		// Tables are numbered in order of their first relation.
+		for (std::size_t i = 0; i < group_of.size(); i++)
+			AddToTable(grouping, i, group_of[i]);
+
+		EstimateRows(grouping);
+
+		double ratio = recommendation.normalized_cost == 0.0 ? 1.0
+			: recommendation.cost / recommendation.normalized_cost;
+		std::ostringstream percent;
+
+		percent << std::fixed << std::setprecision(1) << ratio * 100;
+
+		std::cout << "Decomposition Advice:\n"
+			<< "Normalized cost: " << recommendation.normalized_cost << "\n"
+			<< "Recommended cost: " << recommendation.cost << " (" << percent.str()
+			<< "% of normalized)\n"
+			<< "Search nodes: " << recommendation.nodes_explored
+			<< (recommendation.budget_exhausted ? " (budget exhausted)" : "")
+			<< "\n\nTables:\n";
+
+		for (std::size_t t = 0; t < recommendation.relations.size(); t++) {
+
+			const Relation & relation = recommendation.relations[t];
+			std::ostringstream rows;
+
+			rows << std::fixed << std::setprecision(0) << grouping.rows[t];
+
+			std::cout << relation.name << " ";
+			PrintAttrSet(relation.attributes);
+			std::cout << " key ";
+			PrintAttrSet(relation.primary_key);
+			std::cout << " rows " << rows.str() << "\n";
+
+		}
+
+		std::cout << "\nQueries:\n";
+
+		PackedAttributeSet none(num_words, 0);
+
+		for (std::size_t q = 0; q < workload.size(); q++) {
+
+			std::cout << workload[q].frequency << " x ";
+			PrintAttrSet(workload[q].attributes);
+			std::cout << " : " << ComputeQueryCost(q, grouping, none) << "\n";
+
+		}
+
+	}
+
+	// =========================================================================
+	// Prints an AttributeSet by attribute names.
+	//
+	// "attribute_set":
+	//		Set of attributes to print.
+	// =========================================================================
+	void DecompositionAdvisor::PrintAttrSet(const AttributeSet & attribute_set) {
+
+		std::cout << "{ ";
+
+		for (AttributeSet::const_iterator it = attribute_set.begin(); it != attribute_set.end(); it++) {
+
+			std::cout << db.GetAttributeTable()[*it].name;
+			std::string comma = std::next(it, 1) != attribute_set.end() ? ", " : "";
+			std::cout << comma;
+
+		}
+
+		std::cout << " }";
+
+	}
+
+	// =========================================================================
+	// Reads a workload.
+	// =========================================================================
+	void DecompositionAdvisor::ReadWorkload(std::istream & stream) {
+
+		std::string line;
+
+		while (std::getline(stream, line)) {
+
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::istringstream fields(line);
+			double frequency;
+			std::string attr_list;
+
+			if (!(fields >> frequency >> attr_list) || frequency < 0)
+				throw std::invalid_argument("Malformed workload line '" + line + "'!");
+
+			std::vector<std::string> attr_names(1);
+
+			for (char token : attr_list) {
+
+				if (token == ',')
+					attr_names.emplace_back();
+				else
+					attr_names.back().push_back(token);
+
+			}
+
+			AddQuery(attr_names, frequency);
+
+		}
+
+	}
+
+	// =========================================================================
+	// Takes the row counts and distinct counts of a StorageEstimator.
+	// =========================================================================
+	void DecompositionAdvisor::SetStatistics(const StorageEstimator & estimator) {
+
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+
+		for (AttributeTblIndex attr = 0; attr < attribute_table.size(); attr++)
+			distinct[attr] = estimator.GetDistinct(attr);
+
+		global_rows = estimator.GetRows();
+		relation_rows.clear();
+
+		for (const Relation & relation : db.GetRelationTable())
+			relation_rows.push_back(estimator.EstimateRows(relation));
+
+	}
+
+	// =========================================================================
+	// Depth-first branch and bound over the groupings that extend a partial
+	// grouping. Relation "next" joins every existing table in turn, then a
+	// new one.
+	//
+	// "grouping":
+	//		Tables of the relations assigned so far. Restored on return.
+	//
+	// "next":
+	//		Index of the first unassigned relation.
+	// =========================================================================
+	void DecompositionAdvisor::Search(Grouping & grouping, std::size_t next) {
+
+		if (nodes++ >= search_budget)
+			return;
+
+		// A complete grouping's merged tables get their own row estimates,
+		// so its bound is its cost.
+		std::vector<double> saved_rows;
+
+		if (next == relations.size()) {
+			saved_rows = grouping.rows;
+			EstimateRows(grouping);
+		}
+
+		double bound = ComputeBound(grouping, next);
+
+		if (next == relations.size())
+			grouping.rows.swap(saved_rows);
+
+		{
+
+			// A branch that can only tie the best grouping is pruned too,
+			// unless it can still win the tie with more tables.
+			std::lock_guard<std::mutex> lock(best_mutex);
+			std::size_t best_tables = *std::max_element(best_group_of.begin(), best_group_of.end()) + 1;
+			std::size_t max_tables = grouping.tables.size() + relations.size() - next;
+
+			if (bound > best_cost || (bound == best_cost && max_tables < best_tables))
+				return;
+
+		}
+
+		if (next == relations.size()) {
+			UpdateBest(grouping, bound);
+			return;
+		}
+
+		std::size_t num_tables = grouping.tables.size();
+
+		for (std::size_t table = 0; table <= num_tables; table++) {
+
+			PackedAttributeSet saved_table = table < num_tables
+				? grouping.tables[table] : PackedAttributeSet();
+			std::size_t saved_width = table < num_tables ? grouping.widths[table] : 0;
+			double saved_table_rows = table < num_tables ? grouping.rows[table] : 0.0;
+
+			AddToTable(grouping, next, table);
+			Search(grouping, next + 1);
+
+			grouping.group_of.pop_back();
+
+			if (table < num_tables) {
+				grouping.tables[table] = saved_table;
+				grouping.widths[table] = saved_width;
+				grouping.rows[table] = saved_table_rows;
+			}
+			else {
+				grouping.tables.pop_back();
+				grouping.widths.pop_back();
+				grouping.rows.pop_back();
+			}
+
+		}
+
+	}
+
+	// =========================================================================
+	// Keeps a complete grouping if it is the best so far. Equal costs prefer
+	// more tables, i.e., fewer merges, and then the lexicographically
+	// smaller grouping, so the result does not depend on search order.
+	//
+	// "grouping":
+	//		Complete grouping.
+	//
+	// "cost":
+	//		Workload cost of "grouping".
+	// =========================================================================
+	void DecompositionAdvisor::UpdateBest(const Grouping & grouping, double cost) {
+
+		std::lock_guard<std::mutex> lock(best_mutex);
+		std::size_t best_tables = *std::max_element(best_group_of.begin(), best_group_of.end()) + 1;
+
+		bool better = cost < best_cost
+			|| (cost == best_cost && grouping.tables.size() > best_tables)
+			|| (cost == best_cost && grouping.tables.size() == best_tables
+				&& grouping.group_of < best_group_of);
+
+		if (better) {
+			best_cost = cost;
+			best_group_of = grouping.group_of;
+		}
+
+	}
+
+}
@@ -0,0 +1,96 @@
+#include "arena.h"
+
+namespace DbNormalizerCpp {
+
+	namespace {
+
+		// =====================================================================
+		// Initial size of a NormalizationArena's first heap block.
+		// =====================================================================
+		const std::size_t INITIAL_ARENA_SIZE = 64 * 1024;
+
+		thread_local std::pmr::memory_resource * current_resource = nullptr;
+
+	}
+
+	// =========================================================================
+	// Adds the counts of another run to these counts.
+	// =========================================================================
+	AllocationStats & AllocationStats::operator+=(const AllocationStats & other) {
+
+		allocations += other.allocations;
+		bytes += other.bytes;
+		upstream_allocations += other.upstream_allocations;
+		upstream_bytes += other.upstream_bytes;
+
+		return *this;
+
+	}
+
+	void * CountingResource::do_allocate(std::size_t size, std::size_t alignment) {
+
+		allocations++;
+		bytes += size;
+
+		return upstream->allocate(size, alignment);
+
+	}
+
+	void CountingResource::do_deallocate(void * p, std::size_t size, 
+		std::size_t alignment) {
+
+		upstream->deallocate(p, size, alignment);
+
+	}
+
+	bool CountingResource::do_is_equal(const std::pmr::memory_resource & other) 
+		const noexcept {
+
+		return this == &other;
+
+	}
+
+	// =========================================================================
+	// Constructs a NormalizationArena on top of the heap.
+	// =========================================================================
+	NormalizationArena::NormalizationArena()
+		: upstream(std::pmr::new_delete_resource()), 
+		arena(INITIAL_ARENA_SIZE, &upstream), front(&arena) {}
+
+	// =========================================================================
+	// Returns the allocation counts of this arena.
+	// =========================================================================
+	AllocationStats NormalizationArena::Stats() const {
+
+		AllocationStats stats;
+
+		stats.allocations = front.Allocations();
+		stats.bytes = front.Bytes();
+		stats.upstream_allocations = upstream.Allocations();
+		stats.upstream_bytes = upstream.Bytes();
+
+		return stats;
+
+	}
+
+	ScopedNormalizationResource::ScopedNormalizationResource(
+		std::pmr::memory_resource * resource) : previous(current_resource) {
+
+		current_resource = resource;
+
+	}
+
+	ScopedNormalizationResource::~ScopedNormalizationResource() {
+
+		current_resource = previous;
+
+	}
+
+	std::pmr::memory_resource * CurrentNormalizationResource() {
+
+		return current_resource != nullptr ? current_resource 
+			: std::pmr::get_default_resource();
+
+	}
+
+}
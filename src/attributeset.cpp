@@ -0,0 +1,546 @@
+#include <algorithm>
+
+#include "attributeset.h"
+
+namespace DbNormalizerCpp {
+
+	namespace {
+
+		// =====================================================================
+		// Returns the number of set bits in a word.
+		// =====================================================================
+		std::uint32_t PopCount(std::uint64_t word) {
+
+			return static_cast<std::uint32_t>(__builtin_popcountll(word));
+
+		}
+
+	}
+
+	// =========================================================================
+	// Moves the iterator to the first index at or after "next" within the
+	// current chunk, or to a later chunk.
+	// =========================================================================
+	void HybridAttributeSet::const_iterator::Advance(std::uint32_t next) {
+
+		while (chunk < set->chunks.size()) {
+
+			const Chunk & current = set->chunks[chunk];
+
+			if (!current.IsBitmap()) {
+
+				if (next < current.array.size()) {
+					position = next;
+					value = (value_type(current.key) << 16) | current.array[next];
+					return;
+				}
+
+			}
+			else {
+
+				for (std::uint32_t w = next / 64; w < BITMAP_WORDS; w++) {
+
+					std::uint64_t word = current.bitmap[w];
+
+					if (w == next / 64)
+						word &= ~std::uint64_t(0) << (next % 64);
+
+					if (word != 0) {
+						position = w * 64 + static_cast<std::uint32_t>(__builtin_ctzll(word));
+						value = (value_type(current.key) << 16) | position;
+						return;
+					}
+
+				}
+
+			}
+
+			chunk++;
+			next = 0;
+
+		}
+
+		position = 0;
+		value = 0;
+
+	}
+
+	// =========================================================================
+	// Returns an iterator to the smallest index in the set.
+	// =========================================================================
+	HybridAttributeSet::const_iterator HybridAttributeSet::begin() const {
+
+		return const_iterator(this, 0, 0);
+
+	}
+
+	// =========================================================================
+	// Returns whether a chunk contains a low part.
+	// =========================================================================
+	bool HybridAttributeSet::ChunkContains(const Chunk & chunk,
+		std::uint16_t low) {
+
+		if (chunk.IsBitmap())
+			return (chunk.bitmap[low / 64] >> (low % 64)) & 1;
+
+		return std::binary_search(chunk.array.begin(), chunk.array.end(), low);
+
+	}
+
+	// =========================================================================
+	// Returns whether every low part in chunk "a" is in chunk "b". Both
+	// chunks have the same key.
+	// =========================================================================
+	bool HybridAttributeSet::ChunkIsSubsetOf(const Chunk & a, const Chunk & b) {
+
+		if (a.cardinality > b.cardinality)
+			return false;
+
+		if (a.IsBitmap()) {
+
+			// b is a bitmap too, since it holds more than MAX_ARRAY_SIZE
+			// low parts.
+
+			for (std::size_t w = 0; w < BITMAP_WORDS; w++) {
+
+				if (a.bitmap[w] & ~b.bitmap[w])
+					return false;
+
+			}
+
+			return true;
+
+		}
+
+		if (b.IsBitmap()) {
+
+			for (std::uint16_t low : a.array) {
+
+				if (!((b.bitmap[low / 64] >> (low % 64)) & 1))
+					return false;
+
+			}
+
+			return true;
+
+		}
+
+		return std::includes(b.array.begin(), b.array.end(), a.array.begin(),
+			a.array.end());
+
+	}
+
+	// =========================================================================
+	// Returns whether chunks "a" and "b" have a low part in common. Both
+	// chunks have the same key.
+	// =========================================================================
+	bool HybridAttributeSet::ChunksIntersect(const Chunk & a, const Chunk & b) {
+
+		if (a.IsBitmap() && b.IsBitmap()) {
+
+			for (std::size_t w = 0; w < BITMAP_WORDS; w++) {
+
+				if (a.bitmap[w] & b.bitmap[w])
+					return true;
+
+			}
+
+			return false;
+
+		}
+
+		if (a.IsBitmap() || b.IsBitmap()) {
+
+			const Chunk & array = a.IsBitmap() ? b : a;
+			const Chunk & bitmap = a.IsBitmap() ? a : b;
+
+			for (std::uint16_t low : array.array) {
+
+				if ((bitmap.bitmap[low / 64] >> (low % 64)) & 1)
+					return true;
+
+			}
+
+			return false;
+
+		}
+
+		std::pmr::vector<std::uint16_t>::const_iterator a_it = a.array.begin();
+		std::pmr::vector<std::uint16_t>::const_iterator b_it = b.array.begin();
+
+		while (a_it != a.array.end() && b_it != b.array.end()) {
+
+			if (*a_it == *b_it)
+				return true;
+
+			if (*a_it < *b_it)
+				a_it++;
+			else
+				b_it++;
+
+		}
+
+		return false;
+
+	}
+
+	// =========================================================================
+	// Returns whether the set contains "value".
+	// =========================================================================
+	bool HybridAttributeSet::Contains(value_type value) const {
+
+		std::pmr::vector<Chunk>::const_iterator it = FindChunk(value >> 16);
+
+		return it != chunks.end() && it->key == (value >> 16)
+			&& ChunkContains(*it, value & 0xffff);
+
+	}
+
+	// =========================================================================
+	// Returns the past-the-end iterator.
+	// =========================================================================
+	HybridAttributeSet::const_iterator HybridAttributeSet::end() const {
+
+		const_iterator it;
+
+		it.set = this;
+		it.chunk = chunks.size();
+
+		return it;
+
+	}
+
+	// =========================================================================
+	// Erases an index.
+	//
+	// Returns 1 if the index was in the set and 0 otherwise.
+	// =========================================================================
+	HybridAttributeSet::size_type HybridAttributeSet::erase(value_type value) {
+
+		std::uint16_t key = value >> 16;
+		std::uint16_t low = value & 0xffff;
+		std::pmr::vector<Chunk>::iterator it = chunks.begin()
+			+ (FindChunk(key) - chunks.cbegin());
+
+		if (it == chunks.end() || it->key != key || !ChunkContains(*it, low))
+			return 0;
+
+		if (it->IsBitmap()) {
+
+			it->bitmap[low / 64] &= ~(std::uint64_t(1) << (low % 64));
+			it->cardinality--;
+
+			if (it->cardinality <= MAX_ARRAY_SIZE)
+				ToArray(*it);
+
+		}
+		else {
+
+			it->array.erase(std::lower_bound(it->array.begin(), it->array.end(), low));
+			it->cardinality--;
+
+		}
+
+		if (it->cardinality == 0)
+			chunks.erase(it);
+
+		num_values--;
+
+		return 1;
+
+	}
+
+	// =========================================================================
+	// Returns an iterator to "value", or end() if it is not in the set.
+	// =========================================================================
+	HybridAttributeSet::const_iterator HybridAttributeSet::find(value_type
+		value) const {
+
+		std::pmr::vector<Chunk>::const_iterator it = FindChunk(value >> 16);
+
+		if (it == chunks.end() || it->key != (value >> 16))
+			return end();
+
+		std::uint16_t low = value & 0xffff;
+		std::size_t chunk = it - chunks.begin();
+
+		if (it->IsBitmap())
+			return ChunkContains(*it, low) ? const_iterator(this, chunk, low) : end();
+
+		std::pmr::vector<std::uint16_t>::const_iterator low_it =
+			std::lower_bound(it->array.begin(), it->array.end(), low);
+
+		if (low_it == it->array.end() || *low_it != low)
+			return end();
+
+		return const_iterator(this, chunk,
+			static_cast<std::uint32_t>(low_it - it->array.begin()));
+
+	}
+
+	// =========================================================================
+	// Returns the first chunk whose key is not less than "key".
+	// =========================================================================
+	std::pmr::vector<HybridAttributeSet::Chunk>::const_iterator
+		HybridAttributeSet::FindChunk(std::uint16_t key) const {
+
+		return std::lower_bound(chunks.begin(), chunks.end(), key,
+			[](const Chunk & chunk, std::uint16_t k) { return chunk.key < k; });
+
+	}
+
+	// =========================================================================
+	// Inserts an index.
+	//
+	// Returns true if the index was not already in the set.
+	// =========================================================================
+	bool HybridAttributeSet::Insert(value_type value) {
+
+		std::uint16_t key = value >> 16;
+		std::uint16_t low = value & 0xffff;
+		std::pmr::vector<Chunk>::iterator it = chunks.begin()
+			+ (FindChunk(key) - chunks.cbegin());
+
+		if (it == chunks.end() || it->key != key)
+			it = chunks.emplace(it, key);
+
+		if (it->IsBitmap()) {
+
+			std::uint64_t & word = it->bitmap[low / 64];
+			std::uint64_t bit = std::uint64_t(1) << (low % 64);
+
+			if (word & bit)
+				return false;
+
+			word |= bit;
+
+		}
+		else {
+
+			std::pmr::vector<std::uint16_t>::iterator low_it =
+				std::lower_bound(it->array.begin(), it->array.end(), low);
+
+			if (low_it != it->array.end() && *low_it == low)
+				return false;
+
+			it->array.insert(low_it, low);
+
+			if (it->array.size() > MAX_ARRAY_SIZE)
+				ToBitmap(*it);
+
+		}
+
+		it->cardinality++;
+		num_values++;
+
+		return true;
+
+	}
+
+	// =========================================================================
+	// Inserts an index.
+	//
+	// Returns an iterator to the index and whether it was inserted.
+	// =========================================================================
+	std::pair<HybridAttributeSet::const_iterator, bool>
+		HybridAttributeSet::insert(value_type value) {
+
+		bool inserted = Insert(value);
+
+		return std::make_pair(find(value), inserted);
+
+	}
+
+	// =========================================================================
+	// Returns whether the set and "other" have at least one index in common.
+	// =========================================================================
+	bool HybridAttributeSet::Intersects(const HybridAttributeSet & other) const {
+
+		std::pmr::vector<Chunk>::const_iterator a_it = chunks.begin();
+		std::pmr::vector<Chunk>::const_iterator b_it = other.chunks.begin();
+
+		while (a_it != chunks.end() && b_it != other.chunks.end()) {
+
+			if (a_it->key < b_it->key)
+				a_it++;
+			else if (b_it->key < a_it->key)
+				b_it++;
+			else {
+
+				if (ChunksIntersect(*a_it, *b_it))
+					return true;
+
+				a_it++;
+				b_it++;
+
+			}
+
+		}
+
+		return false;
+
+	}
+
+	// =========================================================================
+	// Returns whether every index in the set is also in "other".
+	// =========================================================================
+	bool HybridAttributeSet::IsSubsetOf(const HybridAttributeSet & other) const {
+
+		if (num_values > other.num_values)
+			return false;
+
+		std::pmr::vector<Chunk>::const_iterator b_it = other.chunks.begin();
+
+		for (const Chunk & chunk : chunks) {
+
+			while (b_it != other.chunks.end() && b_it->key < chunk.key)
+				b_it++;
+
+			if (b_it == other.chunks.end() || b_it->key != chunk.key
+				|| !ChunkIsSubsetOf(chunk, *b_it))
+				return false;
+
+		}
+
+		return true;
+
+	}
+
+	// =========================================================================
+	// Returns the number of bytes allocated by the set.
+	// =========================================================================
+	HybridAttributeSet::size_type HybridAttributeSet::MemoryBytes() const {
+
+		size_type bytes = chunks.capacity() * sizeof(Chunk);
+
+		for (const Chunk & chunk : chunks) {
+			bytes += chunk.array.capacity() * sizeof(std::uint16_t);
+			bytes += chunk.bitmap.capacity() * sizeof(std::uint64_t);
+		}
+
+		return bytes;
+
+	}
+
+	// =========================================================================
+	// Converts a bitmap chunk to an array chunk.
+	// =========================================================================
+	void HybridAttributeSet::ToArray(Chunk & chunk) {
+
+		chunk.array.clear();
+		chunk.array.reserve(chunk.cardinality);
+
+		for (std::uint32_t w = 0; w < BITMAP_WORDS; w++) {
+
+			for (std::uint64_t word = chunk.bitmap[w]; word != 0; word &= word - 1)
+				chunk.array.push_back(static_cast<std::uint16_t>(w * 64 + __builtin_ctzll(word)));
+
+		}
+
+		chunk.bitmap.clear();
+		chunk.bitmap.shrink_to_fit();
+
+	}
+
+	// =========================================================================
+	// Converts an array chunk to a bitmap chunk.
+	// =========================================================================
+	void HybridAttributeSet::ToBitmap(Chunk & chunk) {
+
+		chunk.bitmap.assign(BITMAP_WORDS, 0);
+
+		for (std::uint16_t low : chunk.array)
+			chunk.bitmap[low / 64] |= std::uint64_t(1) << (low % 64);
+
+		chunk.array.clear();
+		chunk.array.shrink_to_fit();
+
+	}
+
+	// =========================================================================
+	// Inserts every index in "other".
+	// =========================================================================
+	HybridAttributeSet::size_type HybridAttributeSet::UnionWith(const
+		HybridAttributeSet & other) {
+
+		size_type size_before = num_values;
+		std::size_t a = 0;
+
+		for (const Chunk & chunk : other.chunks) {
+
+			while (a < chunks.size() && chunks[a].key < chunk.key)
+				a++;
+
+			if (a == chunks.size() || chunks[a].key != chunk.key) {
+
+				// No chunk with this key yet, so copy it.
+
+				chunks.insert(chunks.begin() + a, chunk);
+				num_values += chunk.cardinality;
+				a++;
+				continue;
+
+			}
+
+			Chunk & target = chunks[a];
+			std::uint32_t cardinality_before = target.cardinality;
+
+			if (!target.IsBitmap() && !chunk.IsBitmap()
+				&& target.array.size() + chunk.array.size() <= MAX_ARRAY_SIZE) {
+
+				std::pmr::vector<std::uint16_t> merged(target.array.get_allocator());
+				merged.reserve(target.array.size() + chunk.array.size());
+				std::set_union(target.array.begin(), target.array.end(),
+					chunk.array.begin(), chunk.array.end(), std::back_inserter(merged));
+
+				target.array.swap(merged);
+				target.cardinality = static_cast<std::uint32_t>(target.array.size());
+
+			}
+			else {
+
+				if (!target.IsBitmap())
+					ToBitmap(target);
+
+				if (chunk.IsBitmap()) {
+
+					for (std::size_t w = 0; w < BITMAP_WORDS; w++)
+						target.bitmap[w] |= chunk.bitmap[w];
+
+				}
+				else {
+
+					for (std::uint16_t low : chunk.array)
+						target.bitmap[low / 64] |= std::uint64_t(1) << (low % 64);
+
+				}
+
+				target.cardinality = 0;
+
+				for (std::uint64_t word : target.bitmap)
+					target.cardinality += PopCount(word);
+
+				if (target.cardinality <= MAX_ARRAY_SIZE)
+					ToArray(target);
+
+			}
+
+			num_values += target.cardinality - cardinality_before;
+			a++;
+
+		}
+
+		return num_values - size_before;
+
+	}
+
+	// =========================================================================
+	// Returns whether two sets hold the same indexes.
+	// =========================================================================
+	bool operator==(const HybridAttributeSet & a, const HybridAttributeSet & b) {
+
+		return a.num_values == b.num_values && a.IsSubsetOf(b);
+
+	}
+
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+
+#include "batchclosure.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a BatchClosure by flattening the functional dependencies.
+	// =========================================================================
+	BatchClosure::BatchClosure(const FuncDepTable & func_dep_table,
+		std::size_t _num_attributes)
+		: num_attributes(_num_attributes) {
+
+		lhs_begin.push_back(0);
+		rhs_begin.push_back(0);
+
+		for (const FuncDep & func_dep : func_dep_table) {
+
+			lhs_attrs.insert(lhs_attrs.end(), func_dep.first.begin(), func_dep.first.end());
+			rhs_attrs.insert(rhs_attrs.end(), func_dep.second.begin(), func_dep.second.end());
+			lhs_begin.push_back(static_cast<std::uint32_t>(lhs_attrs.size()));
+			rhs_begin.push_back(static_cast<std::uint32_t>(rhs_attrs.size()));
+
+		}
+
+	}
+
+	// =========================================================================
+	// Computes the closure of every attribute set, one block of
+	// "BLOCK_SIZE" sets at a time.
+	// =========================================================================
+	std::vector<AttributeSet> BatchClosure::Compute(const std::vector<AttributeSet> &
+		attribute_sets, std::pmr::memory_resource * resource,
+		const StopPredicate & should_stop) const {
+
+		std::vector<AttributeSet> closures;
+		std::vector<std::uint64_t> slices(num_attributes * LANES);
+		std::vector<std::uint64_t> fired((lhs_begin.size() - 1) * LANES);
+
+		closures.reserve(attribute_sets.size());
+
+		for (std::size_t first = 0; first < attribute_sets.size(); first += BLOCK_SIZE) {
+
+			std::size_t count = attribute_sets.size() - first < BLOCK_SIZE
+				? attribute_sets.size() - first : BLOCK_SIZE;
+
+			std::fill(slices.begin(), slices.end(), 0);
+			std::fill(fired.begin(), fired.end(), 0);
+
+			for (std::size_t q = 0; q < count; q++) {
+
+				for (AttributeTblIndex attr : attribute_sets[first + q])
+					slices[attr * LANES + q / 64] |= std::uint64_t(1) << (q % 64);
+
+			}
+
+			if (!ComputeBlock(slices, fired, should_stop))
+				break;
+
+			// Attributes are visited in ascending order, so every closure
+			// is built by appending.
+			std::size_t first_closure = closures.size();
+
+			for (std::size_t q = 0; q < count; q++)
+				closures.emplace_back(AttributeSet::allocator_type(resource));
+
+			for (AttributeTblIndex attr = 0; attr < num_attributes; attr++) {
+
+				for (std::size_t lane = 0; lane < LANES; lane++) {
+
+					std::uint64_t word = slices[attr * LANES + lane];
+
+					for (; word != 0; word &= word - 1) {
+
+						std::size_t q = lane * 64 + static_cast<std::size_t>(__builtin_ctzll(word));
+
+						if (q < count)
+							closures[first_closure + q].insert(attr);
+
+					}
+
+				}
+
+			}
+
+		}
+
+		return closures;
+
+	}
+
+	// =========================================================================
+	// Applies the functional dependencies to a block of bit-sliced queries
+	// until no word changes.
+	//
+	// "slices":
+	//		"LANES" words per attribute. Bit q of the words of an attribute
+	//		is set iff the closure of query q holds the attribute so far.
+	//
+	// "fired":
+	//		"LANES" words per functional dependency, all 0 at first. Bit q
+	//		is set once the functional dependency fired for query q.
+	//
+	// "should_stop":
+	//		Called before every pass. May be empty.
+	//
+	// Returns false if "should_stop" stopped the block before it was
+	// complete.
+	// =========================================================================
+	bool BatchClosure::ComputeBlock(std::vector<std::uint64_t> & slices,
+		std::vector<std::uint64_t> & fired, const StopPredicate & should_stop) const {
+
+		std::size_t num_func_deps = lhs_begin.size() - 1;
+		bool changed;
+
+		do {
+
+			if (should_stop && should_stop())
+				return false;
+
+			changed = false;
+
+			for (std::size_t f = 0; f < num_func_deps; f++) {
+
+				std::uint64_t fire[LANES];
+				std::uint64_t any = 0;
+
+				for (std::size_t lane = 0; lane < LANES; lane++)
+					fire[lane] = ~fired[f * LANES + lane];
+
+				for (std::uint32_t i = lhs_begin[f]; i < lhs_begin[f + 1]; i++) {
+
+					const std::uint64_t * words = &slices[lhs_attrs[i] * LANES];
+
+					for (std::size_t lane = 0; lane < LANES; lane++)
+						fire[lane] &= words[lane];
+
+				}
+
+				for (std::size_t lane = 0; lane < LANES; lane++)
+					any |= fire[lane];
+
+				if (any == 0)
+					continue;
+
+				for (std::size_t lane = 0; lane < LANES; lane++)
+					fired[f * LANES + lane] |= fire[lane];
+
+				for (std::uint32_t i = rhs_begin[f]; i < rhs_begin[f + 1]; i++) {
+
+					std::uint64_t * words = &slices[rhs_attrs[i] * LANES];
+
+					for (std::size_t lane = 0; lane < LANES; lane++) {
+						changed = changed || (fire[lane] & ~words[lane]) != 0;
+						words[lane] |= fire[lane];
+					}
+
+				}
+
+			}
+
+		} while (changed);
+
+		return true;
+
+	}
+
+}
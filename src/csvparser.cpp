@@ -0,0 +1,739 @@
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "csvparser.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Maximum number of attributes in a .csv file. Attribute sets in the 
+	// lattice are represented as 64-bit masks.
+	// =========================================================================
+	static const std::size_t MAX_CSV_ATTRIBUTES = 64;
+
+	// =========================================================================
+	// Rows read between two checks of the byte budget while encoding.
+	// =========================================================================
+	static const std::size_t BUDGET_CHECK_ROWS = 4096;
+
+	// =========================================================================
+	// Adds a discovered functional dependency to a Database.
+	//
+	// "db":
+	//		Database to add the functional dependency to.
+	//
+	// "attr_names":
+	//		Names of all attributes, in column order.
+	//
+	// "lhs":
+	//		Mask of the attributes on the lhs of the functional dependency.
+	//
+	// "rhs":
+	//		Column of the attribute on the rhs of the functional dependency.
+	// =========================================================================
+	void CsvParser::AddFuncDep(Database & db, 
+		const std::vector<std::string> & attr_names, AttributeMask lhs,
+		unsigned int rhs) {
+
+		SimpleFuncDep func_dep;
+
+		for (unsigned int i = 0; i < attr_names.size(); i++) {
+
+			if (lhs & (AttributeMask(1) << i))
+				func_dep.first.push_back(attr_names[i]);
+
+		}
+
+		if (max_lhs_size != 0 && func_dep.first.size() > max_lhs_size)
+			return;
+
+		func_dep.second.push_back(attr_names[rhs]);
+		db.InsertFuncDep(func_dep);
+
+	}
+
+	// =========================================================================
+	// Computes C+(X) for every attribute set X in a level and adds every
+	// minimal functional dependency X \ A -> A that holds, where A is in X.
+	//
+	// "db":
+	//		Database to add discovered functional dependencies to.
+	//
+	// "attr_names":
+	//		Names of all attributes, in column order.
+	//
+	// "level":
+	//		Current level of the lattice.
+	//
+	// "previous_level":
+	//		Previous level of the lattice. Contains every X \ A.
+	//
+	// "empty_set_error":
+	//		Error of the partition of the empty attribute set.
+	// =========================================================================
+	void CsvParser::ComputeDependencies(Database & db, 
+		const std::vector<std::string> & attr_names, Level & level,
+		const Level & previous_level, std::size_t empty_set_error) {
+
+		for (AttributeMask x : SortedMasks(level)) {
+
+			LatticeNode & node = level.at(x);
+			AttributeMask rhs_candidates = ~AttributeMask(0);
+
+			// C+(X) is the intersection of C+(X \ A) for all A in X.
+			for (unsigned int a = 0; a < attr_names.size(); a++) {
+
+				AttributeMask bit = AttributeMask(1) << a;
+
+				if (x & bit)
+					rhs_candidates &= previous_level.at(x & ~bit).rhs_candidates;
+
+			}
+
+			for (unsigned int a = 0; a < attr_names.size(); a++) {
+
+				AttributeMask bit = AttributeMask(1) << a;
+
+				if (!(x & bit & rhs_candidates))
+					continue;
+
+				AttributeMask lhs = x & ~bit;
+				std::size_t lhs_error = lhs == 0 ? empty_set_error
+					: previous_level.at(lhs).partition->Error();
+
+				if (lhs_error == node.partition->Error()) {
+
+					// X \ A -> A holds and is minimal.
+					AddFuncDep(db, attr_names, lhs, a);
+
+					// Remove A and all attributes outside of X from C+(X).
+					rhs_candidates &= ~bit;
+					rhs_candidates &= x;
+
+				}
+
+			}
+
+			node.rhs_candidates = rhs_candidates;
+
+		}
+
+	}
+
+	// =========================================================================
+	// Generates the next level of the lattice. Attribute sets that share all
+	// but their last attribute are combined, and a combination is kept only
+	// if all of its subsets survived pruning. The partition of every kept 
+	// combination is the product of the partitions of the two sets 
+	// combined; products are computed by up to max_threads threads.
+	//
+	// "level":
+	//		Current level of the lattice.
+	//
+	// "held_bytes":
+	//		Bytes already held: the column partitions and "level".
+	//
+	// Returns the next level of the lattice. If its partitions and the
+	// scratch tables do not fit in the byte budget next to "held_bytes",
+	// the products stop, "lattice_truncated" is set, and an empty level is
+	// returned.
+	// =========================================================================
+	CsvParser::Level CsvParser::GenerateNextLevel(const Level & level,
+		std::size_t held_bytes) {
+
+		struct Candidate {
+			AttributeMask x;
+			const StrippedPartition * a;
+			const StrippedPartition * b;
+		};
+
+		// Group attribute sets into prefix blocks, i.e., by all but their
+		// highest attribute. Masks are sorted, so blocks stay sorted too.
+		std::unordered_map<AttributeMask, std::vector<AttributeMask>> blocks;
+		std::vector<AttributeMask> prefixes;
+
+		for (AttributeMask y : SortedMasks(level)) {
+
+			AttributeMask highest = y;
+
+			while (highest & (highest - 1))
+				highest &= highest - 1;
+
+			std::vector<AttributeMask> & block = blocks[y & ~highest];
+
+			if (block.empty())
+				prefixes.push_back(y & ~highest);
+
+			block.push_back(y);
+
+		}
+
+		std::sort(prefixes.begin(), prefixes.end());
+
+		std::vector<Candidate> candidates;
+
+		for (AttributeMask prefix : prefixes) {
+
+			const std::vector<AttributeMask> & block = blocks.at(prefix);
+
+			for (std::size_t i = 0; i < block.size(); i++) {
+
+				for (std::size_t j = i + 1; j < block.size(); j++) {
+
+					AttributeMask x = block[i] | block[j];
+					bool all_subsets_present = true;
+
+					for (AttributeMask rest = x; rest != 0 && all_subsets_present;
+						rest &= rest - 1) {
+
+						AttributeMask bit = rest & (0 - rest);
+						all_subsets_present = level.find(x & ~bit) != level.end();
+
+					}
+
+					if (all_subsets_present) {
+						candidates.push_back({ x, level.at(block[i]).partition.get(),
+							level.at(block[j]).partition.get() });
+					}
+
+				}
+
+			}
+
+		}
+
+		std::vector<StrippedPartition> products(candidates.size());
+		unsigned int num_threads = max_threads;
+
+		if (num_threads > candidates.size())
+			num_threads = static_cast<unsigned int>(candidates.size());
+
+		if (num_threads < 1)
+			num_threads = 1;
+
+		// Every thread's scratch table and every product count against the
+		// budget. Scratch classes never hold more rows than the table.
+		std::atomic<std::size_t> level_bytes(num_threads * num_rows
+			* (sizeof(int) + sizeof(RowIndex)));
+		std::atomic<bool> exceeded(false);
+
+		// Each thread owns its scratch tables and only writes to the 
+		// products of its own candidates.
+		auto multiply = [&](unsigned int first) {
+
+			std::vector<int> scratch_table(num_rows, -1);
+			std::vector<std::vector<RowIndex>> scratch_classes;
+
+			for (std::size_t i = first; i < candidates.size() && !exceeded; i += num_threads) {
+
+				products[i] = MultiplyPartitions(*candidates[i].a, *candidates[i].b,
+					scratch_table, scratch_classes);
+
+				std::size_t bytes = level_bytes += products[i].Bytes() + sizeof(LatticeNode);
+
+				if (max_bytes != 0 && held_bytes + bytes > max_bytes)
+					exceeded = true;
+
+			}
+
+		};
+
+		if (num_threads == 1) {
+			multiply(0);
+		}
+		else {
+
+			std::vector<std::thread> threads;
+
+			for (unsigned int t = 0; t < num_threads; t++)
+				threads.push_back(std::thread(multiply, t));
+
+			for (std::thread & thread : threads)
+				thread.join();
+
+		}
+
+		Level next_level;
+
+		if (exceeded) {
+			lattice_truncated = true;
+			return next_level;
+		}
+
+		for (std::size_t i = 0; i < candidates.size(); i++) {
+			next_level[candidates[i].x].partition =
+				std::make_shared<const StrippedPartition>(std::move(products[i]));
+		}
+
+		return next_level;
+
+	}
+
+	// =========================================================================
+	// Computes the product of two stripped partitions, i.e., the stripped
+	// partition by the union of both attribute sets.
+	//
+	// "a", "b":
+	//		Stripped partitions to multiply.
+	//
+	// "scratch_table":
+	//		num_rows entries, all -1. Left all -1 on return.
+	//
+	// "scratch_classes":
+	//		Scratch space. Left with only empty classes on return.
+	//
+	// Returns the product of "a" and "b".
+	// =========================================================================
+	CsvParser::StrippedPartition CsvParser::MultiplyPartitions(
+		const StrippedPartition & a, const StrippedPartition & b,
+		std::vector<int> & scratch_table,
+		std::vector<std::vector<RowIndex>> & scratch_classes) {
+
+		StrippedPartition product;
+
+		if (scratch_classes.size() < a.NumClasses())
+			scratch_classes.resize(a.NumClasses());
+
+		for (std::size_t i = 0; i < a.NumClasses(); i++) {
+
+			for (RowIndex k = a.offsets[i]; k < a.offsets[i + 1]; k++)
+				scratch_table[a.rows[k]] = static_cast<int>(i);
+
+		}
+
+		for (std::size_t i = 0; i < b.NumClasses(); i++) {
+
+			for (RowIndex k = b.offsets[i]; k < b.offsets[i + 1]; k++) {
+
+				int owner = scratch_table[b.rows[k]];
+
+				if (owner != -1)
+					scratch_classes[owner].push_back(b.rows[k]);
+
+			}
+
+			for (RowIndex k = b.offsets[i]; k < b.offsets[i + 1]; k++) {
+
+				int owner = scratch_table[b.rows[k]];
+
+				if (owner == -1 || scratch_classes[owner].empty())
+					continue;
+
+				if (scratch_classes[owner].size() >= 2) {
+
+					product.rows.insert(product.rows.end(),
+						scratch_classes[owner].begin(), scratch_classes[owner].end());
+					product.offsets.push_back(static_cast<RowIndex>(product.rows.size()));
+
+				}
+
+				scratch_classes[owner].clear();
+
+			}
+
+		}
+
+		for (RowIndex row : a.rows)
+			scratch_table[row] = -1;
+
+		product.rows.shrink_to_fit();
+		product.offsets.shrink_to_fit();
+
+		return product;
+
+	}
+
+	// =========================================================================
+	// Opens a .csv file.
+	//
+	// "fileName":
+	//		Name of the file to open.
+	// =========================================================================
+	void CsvParser::Open(std::string fileName) {
+
+		IParser::Open(fileName);
+
+		std::string::size_type begin = fileName.find_last_of("/\\");
+		begin = begin == std::string::npos ? 0 : begin + 1;
+
+		std::string::size_type end = fileName.find_last_of('.');
+		end = end == std::string::npos || end < begin ? fileName.size() : end;
+
+		db_name = fileName.substr(begin, end - begin);
+
+	}
+
+	// =========================================================================
+	// Parses .csv file and creates a Database object.
+	//
+	// Every value is dictionary-encoded per column so that only 32-bit codes
+	// are kept, and the codes of a column are released as soon as its
+	// stripped partition is built. Without a byte budget the file is read
+	// once; with one, as many times as it takes to encode every column
+	// within the budget. The previous level of the lattice is released
+	// before the next one is generated, so the column partitions and at
+	// most two levels are held at any time, and the next level is only
+	// kept if it fits.
+	//
+	// Returns a Database initialized with name, universal set of attributes,
+	// and set of discovered functional dependencies.
+	// =========================================================================
+	Database CsvParser::Parse() {
+
+		TraceScope trace(tracer, "parse", "parse");
+		CsvReader reader(fileStream);
+		std::vector<std::string> attr_names;
+		Database db;
+
+		db.SetTracer(tracer);
+
+		if (!reader.ReadRow(attr_names))
+			throw std::runtime_error("Expected a header row but reached end of file!");
+
+		if (attr_names.size() > MAX_CSV_ATTRIBUTES) {
+			throw std::runtime_error("Expected at most " + std::to_string(MAX_CSV_ATTRIBUTES)
+				+ " attributes but got " + std::to_string(attr_names.size()) + "!");
+		}
+
+		db.SetName(db_name);
+
+		for (const std::string & attr_name : attr_names)
+			db.InsertAttribute(attr_name);
+
+		column_partitions.clear();
+		column_partition_bytes = 0;
+		column_passes = 0;
+		lattice_truncated = false;
+
+		for (std::size_t first = 0; first < attr_names.size(); ) {
+
+			if (first != 0) {
+
+				// Rewind to the first data row for the next pass.
+				std::vector<std::string> header;
+
+				fileStream.clear();
+				fileStream.seekg(0);
+				reader.ReadRow(header);
+
+			}
+
+			first = EncodeColumns(reader, attr_names, first);
+
+		}
+
+		// Level 1 of the lattice, i.e., every single attribute.
+		Level level;
+
+		for (std::size_t i = 0; i < column_partitions.size(); i++)
+			level[AttributeMask(1) << i].partition = column_partitions[i];
+
+		// Level 0 of the lattice, i.e., the empty set, whose only rhs 
+		// candidates are all attributes.
+		Level previous_level;
+		previous_level[0].rhs_candidates = attr_names.size() == MAX_CSV_ATTRIBUTES
+			? ~AttributeMask(0) : (AttributeMask(1) << attr_names.size()) - 1;
+
+		std::size_t empty_set_error = num_rows >= 2 ? num_rows - 1 : 0;
+
+		for (unsigned int l = 1; !level.empty(); l++) {
+
+			ComputeDependencies(db, attr_names, level, previous_level, empty_set_error);
+			Prune(db, attr_names, level, previous_level, empty_set_error);
+
+			if (max_lhs_size != 0 && l > max_lhs_size)
+				break;
+
+			// Level 1 shares the column partitions.
+			Level().swap(previous_level);
+			Level next_level = GenerateNextLevel(level, column_partition_bytes
+				+ (l == 1 ? 0 : LevelBytes(level)));
+
+			previous_level = std::move(level);
+			level = std::move(next_level);
+
+		}
+
+		column_partitions.clear();
+
+		return db;
+
+	}
+
+	// =========================================================================
+	// Encodes columns in one pass over the data rows and builds their
+	// stripped partitions. Starts with every column from "first" on. Every
+	// "BUDGET_CHECK_ROWS" rows, while the codes, dictionaries, and future
+	// partitions of the columns do not fit in the byte budget next to the
+	// column partitions built before, the upper half of the columns is
+	// dropped and left to a later pass.
+	//
+	// "reader":
+	//		Reader positioned at the first data row.
+	//
+	// "attr_names":
+	//		Names of all attributes, in column order.
+	//
+	// "first":
+	//		First column to encode.
+	//
+	// Returns one past the last column encoded.
+	// =========================================================================
+	std::size_t CsvParser::EncodeColumns(CsvReader & reader,
+		const std::vector<std::string> & attr_names, std::size_t first) {
+
+		TraceScope trace(tracer, "column pass", "parse", "first", first);
+		std::size_t end = attr_names.size();
+		std::vector<std::vector<ValueCode>> columns(end - first);
+		std::vector<ColumnDictionary> dictionaries(end - first);
+		std::vector<std::string> fields;
+
+		// A partition holds at most one row index per row plus one offset
+		// per two rows, so 6 bytes per row, and partitioning a column takes
+		// two counters per distinct value, less than its dictionary.
+		auto fits = [&]() {
+
+			std::size_t bytes = column_partition_bytes;
+
+			for (std::size_t i = 0; i < end - first; i++) {
+				bytes += columns[i].capacity() * sizeof(ValueCode) + 2 * dictionaries[i].Bytes()
+					+ num_rows * (sizeof(RowIndex) + sizeof(RowIndex) / 2);
+			}
+
+			return bytes <= max_bytes;
+
+		};
+
+		auto shrink = [&]() {
+
+			while (max_bytes != 0 && !fits()) {
+
+				if (end - first == 1) {
+					throw std::runtime_error("Column '" + attr_names[first]
+						+ "' does not fit in the memory budget of "
+						+ std::to_string(max_bytes) + " bytes!");
+				}
+
+				end = first + (end - first) / 2;
+				columns.resize(end - first);
+				dictionaries.resize(end - first);
+
+			}
+
+		};
+
+		column_passes++;
+		num_rows = 0;
+
+		while (reader.ReadRow(fields)) {
+
+			if (fields.size() == 1 && fields[0].empty())
+				continue; // Empty line.
+
+			if (fields.size() != attr_names.size()) {
+				throw std::runtime_error("Expected " + std::to_string(attr_names.size())
+					+ " fields on row " + std::to_string(num_rows + 1) + " but got "
+					+ std::to_string(fields.size()) + "!");
+			}
+
+			for (std::size_t i = first; i < end; i++)
+				columns[i - first].push_back(dictionaries[i - first].Encode(fields[i]));
+
+			num_rows++;
+
+			if (num_rows % BUDGET_CHECK_ROWS == 0)
+				shrink();
+
+		}
+
+		shrink();
+
+		for (std::size_t i = first; i < end; i++) {
+
+			column_partitions.push_back(std::make_shared<const StrippedPartition>(
+				PartitionColumn(columns[i - first], dictionaries[i - first].Size())));
+			column_partition_bytes += column_partitions.back()->Bytes();
+
+			std::vector<ValueCode>().swap(columns[i - first]);
+			dictionaries[i - first] = ColumnDictionary();
+
+		}
+
+		return end;
+
+	}
+
+	// =========================================================================
+	// Builds the stripped partition of a single column.
+	//
+	// "column":
+	//		Dictionary-encoded values of the column.
+	//
+	// "num_values":
+	//		Number of distinct values in the column.
+	//
+	// Returns the stripped partition of the column.
+	// =========================================================================
+	CsvParser::StrippedPartition CsvParser::PartitionColumn(
+		const std::vector<ValueCode> & column, std::size_t num_values) {
+
+		std::vector<RowIndex> counts(num_values, 0);
+
+		for (ValueCode value : column)
+			counts[value]++;
+
+		// Turn counts into start positions; singleton classes get none.
+		std::vector<RowIndex> starts(num_values, 0);
+		StrippedPartition partition;
+		RowIndex next = 0;
+
+		for (std::size_t value = 0; value < num_values; value++) {
+
+			if (counts[value] >= 2) {
+				starts[value] = next;
+				next += counts[value];
+				partition.offsets.push_back(next);
+			}
+
+		}
+
+		partition.rows.resize(next);
+
+		for (RowIndex row = 0; row < column.size(); row++) {
+
+			if (counts[column[row]] >= 2)
+				partition.rows[starts[column[row]]++] = row;
+
+		}
+
+		return partition;
+
+	}
+
+	// =========================================================================
+	// Prunes a level of the lattice. Attribute sets with no rhs candidates
+	// are removed. Attribute sets that are keys are removed after adding 
+	// every minimal functional dependency with the key as lhs.
+	//
+	// "db":
+	//		Database to add discovered functional dependencies to.
+	//
+	// "attr_names":
+	//		Names of all attributes, in column order.
+	//
+	// "level":
+	//		Current level of the lattice.
+	//
+	// "previous_level":
+	//		Previous level of the lattice.
+	//
+	// "empty_set_error":
+	//		Error of the partition of the empty attribute set.
+	// =========================================================================
+	void CsvParser::Prune(Database & db, const std::vector<std::string> &
+		attr_names, Level & level, const Level & previous_level,
+		std::size_t empty_set_error) {
+
+		std::vector<AttributeMask> pruned;
+		std::vector<int> scratch_table(num_rows, -1);
+		std::vector<std::vector<RowIndex>> scratch_classes;
+
+		for (AttributeMask x : SortedMasks(level)) {
+
+			const LatticeNode & node = level.at(x);
+
+			if (node.rhs_candidates == 0) {
+				pruned.push_back(x);
+				continue;
+			}
+
+			if (node.partition->Error() != 0)
+				continue;
+
+			// X is a (super)key, so X -> A holds for every A. X -> A is 
+			// minimal iff X \ B -> A does not hold for any B in X, i.e., iff
+			// the errors of X \ B and X \ B u A differ. The partition of 
+			// X \ B u A is in this level unless it was never generated, in 
+			// which case it is computed from the partition of A.
+			for (unsigned int a = 0; a < attr_names.size(); a++) {
+
+				AttributeMask a_bit = AttributeMask(1) << a;
+
+				if (!(node.rhs_candidates & a_bit) || (x & a_bit))
+					continue;
+
+				bool minimal = true;
+
+				for (AttributeMask rest = x; rest != 0 && minimal; rest &= rest - 1) {
+
+					AttributeMask b_bit = rest & (0 - rest);
+					AttributeMask lhs = x & ~b_bit;
+					std::size_t lhs_error = lhs == 0 ? empty_set_error
+						: previous_level.at(lhs).partition->Error();
+					Level::const_iterator it = level.find(lhs | a_bit);
+					std::size_t lhs_rhs_error;
+
+					if (it != level.end()) {
+						lhs_rhs_error = it->second.partition->Error();
+					}
+					else if (lhs == 0) {
+						lhs_rhs_error = column_partitions[a]->Error();
+					}
+					else {
+						lhs_rhs_error = MultiplyPartitions(*previous_level.at(lhs).partition,
+							*column_partitions[a], scratch_table, scratch_classes).Error();
+					}
+
+					minimal = lhs_error != lhs_rhs_error;
+
+				}
+
+				if (minimal)
+					AddFuncDep(db, attr_names, x, a);
+
+			}
+
+			pruned.push_back(x);
+
+		}
+
+		for (AttributeMask x : pruned)
+			level.erase(x);
+
+	}
+
+	// =========================================================================
+	// Returns the heap bytes of the partitions and nodes of a level.
+	// =========================================================================
+	std::size_t CsvParser::LevelBytes(const Level & level) {
+
+		std::size_t bytes = 0;
+
+		for (const Level::value_type & entry : level)
+			bytes += entry.second.partition->Bytes() + sizeof(Level::value_type);
+
+		return bytes;
+
+	}
+
+	// =========================================================================
+	// Returns the attribute sets of a level in ascending order, so that 
+	// functional dependencies are discovered in a deterministic order.
+	// =========================================================================
+	std::vector<CsvParser::AttributeMask> CsvParser::SortedMasks(
+		const Level & level) {
+
+		std::vector<AttributeMask> masks;
+
+		for (const Level::value_type & entry : level)
+			masks.push_back(entry.first);
+
+		std::sort(masks.begin(), masks.end());
+
+		return masks;
+
+	}
+
+}
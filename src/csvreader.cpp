@@ -0,0 +1,110 @@
+#include "csvreader.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a CsvReader.
+	//
+	// "_stream":
+	//		Stream to read rows from. Must outlive the CsvReader.
+	//
+	// "_delimiter":
+	//		Field delimiter.
+	// =========================================================================
+	CsvReader::CsvReader(std::istream & _stream, char _delimiter)
+		: delimiter(_delimiter), stream(_stream) {}
+
+	// =========================================================================
+	// Reads the next row.
+	//
+	// "fields":
+	//		Cleared and filled with the fields of the next row.
+	//
+	// Returns false if the end of the stream has been reached.
+	// =========================================================================
+	bool CsvReader::ReadRow(std::vector<std::string> & fields) {
+
+		std::string line;
+
+		fields.clear();
+
+		if (!std::getline(stream, line))
+			return false;
+
+		std::string field;
+		bool quoted = false;
+
+		for (std::string::size_type i = 0; ; i++) {
+
+			if (i == line.size()) {
+
+				if (!quoted)
+					break;
+
+				// A quoted field contains a line break, so continue with the
+				// next line.
+				field.push_back('\n');
+				i = static_cast<std::string::size_type>(-1);
+
+				if (!std::getline(stream, line))
+					break;
+
+				continue;
+
+			}
+
+			char token = line[i];
+
+			if (quoted) {
+
+				if (token == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+					field.push_back('"');
+					i++;
+				}
+				else if (token == '"') {
+					quoted = false;
+				}
+				else {
+					field.push_back(token);
+				}
+
+			}
+			else if (token == '"') {
+				quoted = true;
+			}
+			else if (token == delimiter) {
+				fields.push_back(field);
+				field.clear();
+			}
+			else if (token != '\r') {
+				field.push_back(token);
+			}
+
+		}
+
+		fields.push_back(field);
+
+		return true;
+
+	}
+
+	// =========================================================================
+	// Returns the code for "value", assigning the next code if "value" has 
+	// not been seen before.
+	// =========================================================================
+	ValueCode ColumnDictionary::Encode(const std::string & value) {
+
+		std::pair<std::unordered_map<std::string, ValueCode>::iterator, bool>
+			inserted = codes.emplace(value, static_cast<ValueCode>(codes.size()));
+
+		// Every entry is a node holding the value and its code, plus a
+		// bucket pointer. Characters are counted even when they fit inline,
+		// so the estimate errs high.
+		if (inserted.second)
+			bytes += sizeof(std::pair<const std::string, ValueCode>) + 2 * sizeof(void *) + value.size();
+
+		return inserted.first->second;
+
+	}
+
+}
@@ -1,8 +1,22 @@
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 #include "attribute.h"
+#include "batchclosure.h"
 #include "database.h"
+#include "minkeyfinder.h"
+#include "primefinder.h"
+#include "schemapartition.h"
+#include "tracer.h"
 #include "relation.h"
 
 // =============================================================================
@@ -20,8 +34,10 @@ namespace DbNormalizerCpp {
 	Database::Database() {
 	
 		normal_form = NormalForm::One;
+		packed_func_dep_table_stale = true;
 		relation_num = 1;
 		table_index = 0;
+		tracer = nullptr;
 	
 	}
 
@@ -43,40 +59,55 @@ namespace DbNormalizerCpp {
 	// "lhs":
 	//		True if "attribute_set" will be inserted into the lhs of "func_dep".
 	//		False, if it will be inserted into the rhs.
+	//
+	// Throws std::invalid_argument if an attribute is not in the attribute
+	// table.
 	// =========================================================================
-	void Database::AppendToFuncDep(SimpleFuncDep & func_dep, 
+	void Database::AppendToFuncDep(const SimpleFuncDep & func_dep, 
 		AttributeSet & attribute_set, bool lhs = true) {
 
-		std::vector<std::string> &side = func_dep.first;
-
-		if (lhs == false)
-			side = func_dep.second;
+		const std::vector<std::string> & side = lhs ? func_dep.first : func_dep.second;
 
-		for (std::string attr_name : side) {
+		for (const std::string & attr_name : side) {
 
 			AttributeTblIndex index = LookUpAttributeTblIndex(attr_name);
+
+			if (index >= attribute_table.size())
+				throw std::invalid_argument("Unknown attribute '" + attr_name + "'!");
+
 			attribute_set.insert(index);
 
 		}
 
-
 	}
 
 	// =========================================================================
-	// Assigns a primary key to relation based on its candidate keys.
+	// Assigns a primary key to relation based on its candidate keys. If it
+	// has none, a smallest key of its attributes is searched for and becomes
+	// its only candidate key.
 	//
 	// "relation":
 	//		Relation to assign primary key to.
 	//
+	// "should_stop":
+	//		Stops the search for a smallest key, which then returns the
+	//		smallest key found so far. May be empty.
+	//
 	// Precondition: 
-	//		"relation"'s candidate keys have been computed.
+	//		"relation"'s candidate keys, if any, have been computed.
 	// =========================================================================
-	void Database::AssignPrimaryKey(Relation & relation) {
+	void Database::AssignPrimaryKey(Relation & relation,
+		const StopPredicate & should_stop) {
 
 		if (relation.candidate_keys.empty()) {
 
-			for (AttributeTblIndex i = 0; i < attribute_table.size(); i++)
-				relation.primary_key.insert(i);
+			MinimumKeyFinder finder(GetPackedFuncDepTable(),
+				MinimumKeyFinder::DEFAULT_SEARCH_BUDGET, should_stop);
+			AttributeSet key = finder.Find(relation.attributes);
+
+			relation.candidate_keys.emplace_back();
+			relation.candidate_keys.back().insert(key.begin(), key.end());
+			relation.primary_key = relation.candidate_keys.back();
 
 		}
 		else {
@@ -98,6 +129,123 @@ namespace DbNormalizerCpp {
 
 	}
 
+	// =========================================================================
+	// Builds the database of one independent component of this database's
+	// schema. The component's attributes are renumbered from 0 in
+	// ascending order, and its functional and multivalued dependencies are
+	// copied in table order, so functional dependency i of the component
+	// database is the i-th functional dependency of the component.
+	//
+	// "partition":
+	//		Partition of this database's schema.
+	//
+	// "component":
+	//		Index of the component in "partition".
+	//
+	// "local_index":
+	//		Index of every attribute within its component.
+	//
+	// "component_db":
+	//		Empty database that receives the component.
+	// =========================================================================
+	void Database::BuildComponentDatabase(const SchemaPartition & partition,
+		std::size_t component, const std::vector<AttributeTblIndex> & local_index,
+		Database & component_db) {
+
+		auto to_local = [&](const AttributeSet & attribute_set) {
+
+			AttributeSet local;
+
+			for (AttributeTblIndex attr : attribute_set)
+				local.insert(local_index[attr]);
+
+			return local;
+
+		};
+
+		component_db.name = name + "_" + std::to_string(component + 1);
+		component_db.tracer = tracer;
+
+		for (AttributeTblIndex attr : partition.Components()[component])
+			component_db.InsertAttribute(attribute_table[attr].name,
+				attribute_table[attr].type);
+
+		for (FuncDepTblIndex i : partition.FuncDeps()[component]) {
+
+			FuncDep func_dep(to_local(func_dep_table[i].first), 
+				to_local(func_dep_table[i].second));
+			SortedAttributeList lhs(func_dep.first.begin(), func_dep.first.end());
+
+			component_db.lhs_index_map.insert(std::make_pair(lhs, 
+				static_cast<FuncDepTblIndex>(component_db.func_dep_table.size())));
+			component_db.func_dep_table.push_back(std::move(func_dep));
+
+		}
+
+		component_db.packed_func_dep_table_stale = true;
+
+		for (MultiValuedDepTblIndex i : partition.MultiValuedDeps()[component]) {
+
+			component_db.mvd_table.push_back(std::make_pair(
+				to_local(mvd_table[i].first), to_local(mvd_table[i].second)));
+
+		}
+
+	}
+
+	// =========================================================================
+	// Checks the budget of a normalization run.
+	//
+	// "run":
+	//		Run whose budget is checked.
+	//
+	// "extra_bytes":
+	//		Heap bytes of arenas not yet counted in "run".
+	//
+	// Returns Complete if the run may continue, or why it must stop.
+	// =========================================================================
+	NormalizationStatus Database::CheckBudget(const NormalizationRun & run,
+		std::size_t extra_bytes) {
+
+		const NormalizationBudget & budget = run.budget;
+
+		if (budget.cancellation.IsCancelled())
+			return Cancelled;
+
+		if (NormalizationBudget::Clock::now() >= budget.deadline)
+			return DeadlineExceeded;
+
+		if (budget.max_bytes != 0 
+			&& run.arena.Stats().upstream_bytes + run.worker_bytes + extra_bytes > budget.max_bytes)
+			return MemoryExceeded;
+
+		return Complete;
+
+	}
+
+	// =========================================================================
+	// Worker called by FindLostFuncDeps() that checks every "stride"-th 
+	// functional dependency starting at "first" for preservation.
+	//
+	// "first":
+	//		Index of the first functional dependency to check.
+	//
+	// "stride":
+	//		Distance between consecutive functional dependencies to check.
+	//
+	// "preserved":
+	//		One slot per functional dependency. Each checked slot is set to 1 
+	//		if the functional dependency is preserved and 0 otherwise. Slots
+	//		are never shared between workers.
+	// =========================================================================
+	void Database::CheckFuncDepPreservation(unsigned int first,
+		unsigned int stride, std::vector<char> & preserved) {
+
+		for (FuncDepTblIndex i = first; i < func_dep_table.size(); i += stride)
+			preserved[i] = IsFuncDepPreserved(i) ? 1 : 0;
+
+	}
+
 	// =========================================================================
 	// Computes the AttributeSetClosure for a non-global Relation given a 
 	// FuncDepTblIndex.
@@ -114,6 +262,39 @@ namespace DbNormalizerCpp {
 		Relation & relation) {
 	}
 
+	// =========================================================================
+	// Computes one candidate key of a Relation by starting from all of its
+	// attributes and removing attributes, in ascending index order, as long
+	// as the remaining attributes still functionally determine the Relation.
+	//
+	// "relation":
+	//		Relation for which a candidate key will be computed.
+	//
+	// Side effects:
+	//		The candidate key is appended to "relation"'s candidate keys.
+	// =========================================================================
+	void Database::ComputeCandidateKey(Relation & relation) {
+
+		std::pmr::memory_resource * resource = CurrentNormalizationResource();
+		std::pmr::vector<AttributeTblIndex> attributes(relation.attributes.begin(),
+			relation.attributes.end(), resource);
+		std::sort(attributes.begin(), attributes.end());
+
+		CandidateKey candidate_key(relation.attributes, resource);
+
+		for (AttributeTblIndex attr : attributes) {
+
+			candidate_key.erase(attr);
+
+			if (!IsSubsetOf(relation.attributes, ComputeClosureOf(candidate_key)))
+				candidate_key.insert(attr);
+
+		}
+
+		relation.candidate_keys.push_back(candidate_key);
+
+	}
+
 	// =========================================================================
 	// Computes the FuncDepSetClosure for a Relation (can be global or 
 	// non-global).
@@ -133,117 +314,278 @@ namespace DbNormalizerCpp {
 	}
 
 	// =========================================================================
-	// Computes the FuncDepSetClosure for a non-global Relation.
+	// Computes the closures of many sets of attributes at once with a
+	// BatchClosure.
+	// =========================================================================
+	std::vector<AttributeSet> Database::ComputeClosuresOf(const
+		std::vector<AttributeSet> & attribute_sets) const {
+
+		BatchClosure batch(func_dep_table, attribute_table.size());
+
+		return batch.Compute(attribute_sets);
+
+	}
+
+	// =========================================================================
+	// Computes the closure of an arbitrary set of attributes with respect to
+	// the functional dependency table.
 	//
-	// "relation":
-	//		Non-global Relation for which the FuncDepSetClosure will be 
-	//		computed.
+	// "attributes":
+	//		Set of attributes for which the closure will be computed.
+	//
+	// Returns the set of all attributes functionally determined by
+	// "attributes", including "attributes" itself.
 	// =========================================================================
-	void Database::ComputeFuncDepSetClosure(Relation & relation) {
+	AttributeSet Database::ComputeClosureOf(const AttributeSet & attributes) {
+
+		std::pmr::memory_resource * resource = CurrentNormalizationResource();
+		AttributeSet closure(attributes, resource);
+		std::pmr::vector<char> applied(func_dep_table.size(), 0, resource);
+		bool new_insertion;
+
+		// While a new insertion has been made into closure, include the rhs
+		// of every functional dependency whose lhs is a subset of closure.
+		do {
+
+			new_insertion = false;
 
+			for (FuncDepTblIndex i = 0; i < func_dep_table.size(); i++) {
 
+				if (!applied[i] && IsSubsetOf(func_dep_table[i].first, closure)) {
+
+					applied[i] = 1;
+					new_insertion = closure.UnionWith(func_dep_table[i].second) != 0
+						|| new_insertion;
+
+				}
+
+			}
+
+		} while (new_insertion);
+
+		return closure;
 
 	}
 
 	// =========================================================================
-	// Computes the AttributeSetClosure for a GlobalRelation.
+	// Computes the dependency basis of a set of attributes X, i.e., the
+	// coarsest partition of U \ X into blocks Y such that X ->> Y holds for
+	// every block. Blocks start as { U \ X } and are refined with every
+	// multivalued dependency V ->> W, and every functional dependency 
+	// V -> W as V ->> A for each A in W: a block Y that is disjoint from V
+	// and overlaps, but is not contained in, W is split into Y n W and 
+	// Y \ W. All sets are packed into 64-bit words, so every intersection
+	// and difference costs one word operation per 64 attributes.
 	//
-	// "fd_tbl_index":
-	//		Index into the functional dependency table that represents the lhs
-	//		of an AttributeSetClosure.
+	// "attributes":
+	//		Set of attributes X for which the dependency basis will be 
+	//		computed.
+	//
+	// Returns the blocks of the dependency basis of X, excluding X itself.
 	// =========================================================================
-	void Database::ComputeGblAttributeSetClosure(FuncDepTblIndex fd_tbl_index,
-		GlobalRelation & gbl_relation) {
+	DependencyBasis Database::ComputeDependencyBasis(const AttributeSet &
+		attributes) {
 
-		Rhs closure_rhs;
+		std::size_t num_words = (attribute_table.size() + 63) / 64;
+		std::vector<std::pair<PackedAttributeSet, PackedAttributeSet>> dependencies;
 
-		// Include the lhs of the current functional dependecy 
-		// as part of the closure.
-		closure_rhs.insert(func_dep_table[fd_tbl_index].first.begin(),
-			func_dep_table[fd_tbl_index].first.end());
+		for (const MultiValuedDep & mvd : mvd_table)
+			dependencies.push_back(std::make_pair(PackAttributes(mvd.first, num_words), PackAttributes(mvd.second, num_words)));
 
-		// Include the rhs of the current functional dependecy 
-		// as part of the closure.
-		closure_rhs.insert(func_dep_table[fd_tbl_index].second.begin(),
-			func_dep_table[fd_tbl_index].second.end());
+		for (const FuncDep & func_dep : func_dep_table) {
 
-		assert(closure_rhs.size() <= attribute_table.size());
+			PackedAttributeSet lhs = PackAttributes(func_dep.first, num_words);
 
-		if (closure_rhs.size() == attribute_table.size()) {
+			for (AttributeTblIndex attr : func_dep.second) {
 
-			// The lhs of the current functional dependency functionally 
-			// determines all attributes in the relation, so it is a
-			// candidate key for relation.
+				PackedAttributeSet rhs(num_words, 0);
+				InsertPackedAttribute(rhs, attr);
+				dependencies.push_back(std::make_pair(lhs, rhs));
 
-			gbl_relation.candidate_keys.push_back(func_dep_table[fd_tbl_index].first);
+			}
 
 		}
-		else {
 
-			// The lhs of the current functional dependency does not
-			// functionally determine all attributes in the relation,
-			// i.e., is not a candidate key.
+		// The first block is U \ X.
+		PackedAttributeSet x = PackAttributes(attributes, num_words);
+		PackedAttributeSet rest(num_words, ~std::uint64_t(0));
+		bool rest_empty = true;
+
+		if (attribute_table.size() % 64 != 0)
+			rest.back() = (std::uint64_t(1) << (attribute_table.size() % 64)) - 1;
 
-			// State for do-while loop.
-			bool is_lhs_candidate_key = false;
-			bool new_insertion;
-			std::unordered_set<int> included_func_deps;
-			included_func_deps.insert(fd_tbl_index);
+		for (std::size_t w = 0; w < num_words; w++) {
+			rest[w] &= ~x[w];
+			rest_empty = rest_empty && rest[w] == 0;
+		}
 
-			// While a new insertion has been made into closure_rhs,
-			// iterate over func_deps. If a functional dependency's
-			// lhs is a subset of closure_rhs, include the
-			// functional dependency's lhs into closure_rhs.
-			do {
+		std::vector<PackedAttributeSet> blocks;
 
-				new_insertion = false;
+		if (!rest_empty)
+			blocks.push_back(rest);
 
-				for (int j = (fd_tbl_index + 1) % func_dep_table.size();
-					j != fd_tbl_index;
-					j = (j + 1) % func_dep_table.size()) {
+		bool refined;
 
-					if (included_func_deps.find(j) == included_func_deps.end()
-						&& IsSubsetOf(func_dep_table[j].first, closure_rhs)) {
+		do {
 
-						// This current functional dependency's rhs
-						// has not already been included in
-						// closure_rhs and its lhs is a subset of
-						// closure_rhs.
+			refined = false;
 
-						// Include the current functional
-						// dependency's rhs in closure_rhs.
-						closure_rhs.insert(func_dep_table[j].second.begin(),
-							func_dep_table[j].second.end());
+			for (const auto & dependency : dependencies) {
 
-						assert(closure_rhs.size() <= attribute_table.size());
+				const PackedAttributeSet & v = dependency.first;
+				const PackedAttributeSet & w = dependency.second;
 
-						// Mark this functional dependency as 
-						// "included".
-						included_func_deps.insert(j);
-						new_insertion = true;
+				for (std::size_t b = 0; b < blocks.size(); b++) {
 
-						if (closure_rhs.size() == attribute_table.size()) {
+					PackedAttributeSet & y = blocks[b];
+					bool disjoint = true;
+					bool overlaps = false;
+					bool contained = true;
 
-							// Lhs is a candidate key, so break for loop
-							// and break do-while loop.
+					for (std::size_t i = 0; i < num_words; i++) {
+						disjoint = disjoint && (y[i] & v[i]) == 0;
+						overlaps = overlaps || (y[i] & w[i]) != 0;
+						contained = contained && (y[i] & ~w[i]) == 0;
+					}
 
-							gbl_relation.candidate_keys.push_back(func_dep_table[fd_tbl_index].first);
-							is_lhs_candidate_key = true;
-							break;
+					if (!disjoint || !overlaps || contained)
+						continue;
 
-						}
+					// Split Y into Y n W and Y \ W.
+					PackedAttributeSet difference(num_words);
 
+					for (std::size_t i = 0; i < num_words; i++) {
+						difference[i] = y[i] & ~w[i];
+						y[i] &= w[i];
 					}
 
+					blocks.push_back(difference);
+					refined = true;
+
 				}
 
-			} while (!is_lhs_candidate_key && new_insertion);
+			}
+
+		} while (refined);
+
+		DependencyBasis dependency_basis;
+
+		for (const PackedAttributeSet & block : blocks)
+			dependency_basis.push_back(UnpackAttributes(block));
+
+		return dependency_basis;
+
+	}
+
+	// =========================================================================
+	// Computes the FuncDepSetClosure for a non-global Relation, i.e., for the
+	// lhs of every functional dependency that lies within the Relation, the
+	// closure of the lhs projected onto the Relation's attributes. The
+	// closures are computed in one batch.
+	//
+	// "relation":
+	//		Non-global Relation for which the FuncDepSetClosure will be 
+	//		computed.
+	// =========================================================================
+	void Database::ComputeFuncDepSetClosure(Relation & relation) {
+
+		relation.closure.clear();
+
+		FuncDepTblIndexList relevant;
+		std::vector<AttributeSet> lhs_list;
+
+		for (FuncDepTblIndex i = 0; i < func_dep_table.size(); i++) {
+
+			if (IsSubsetOf(func_dep_table[i].first, relation.attributes)) {
+				relevant.push_back(i);
+				lhs_list.push_back(func_dep_table[i].first);
+			}
+
+		}
+
+		if (relevant.empty())
+			return;
+
+		BatchClosure batch(func_dep_table, attribute_table.size());
+		std::vector<AttributeSet> closures = batch.Compute(lhs_list);
+
+		for (std::size_t k = 0; k < relevant.size(); k++) {
+
+			Rhs closure_rhs(CurrentNormalizationResource());
+
+			for (AttributeTblIndex attr : closures[k]) {
+
+				if (relation.attributes.find(attr) != relation.attributes.end())
+					closure_rhs.insert(attr);
+
+			}
+
+			relation.closure.push_back(std::make_pair(relevant[k], closure_rhs));
+
+		}
+
+	}
+
+	// =========================================================================
+	// Worker called by ComputeGblFuncDepSetClosure() that computes the 
+	// closures of a contiguous range of functional dependencies into its own
+	// buffer, in one batch.
+	//
+	// "first", "last":
+	//		Range [first, last) of functional dependency table indexes.
+	//
+	// "gbl_relation":
+	//		GlobalRelation for which the closures are computed. Only read.
+	//
+	// "batch":
+	//		Batch closure kernel over the functional dependency table. Only
+	//		read.
+	//
+	// "buffer":
+	//		Receives one result per relevant functional dependency, in 
+	//		functional dependency table order.
+	//
+	// "should_stop":
+	//		Stops the batch. May be empty.
+	//
+	// Returns false if "should_stop" stopped the batch, in which case
+	// "buffer" only holds the closures completed before.
+	// =========================================================================
+	bool Database::ComputeGblClosureRange(FuncDepTblIndex first,
+		FuncDepTblIndex last, const GlobalRelation & gbl_relation,
+		const BatchClosure & batch, GblClosureBuffer & buffer,
+		const StopPredicate & should_stop) {
+
+		// The lhs of every functional dependency relevant to relation's
+		// attributes.
+		FuncDepTblIndexList relevant;
+		std::vector<AttributeSet> lhs_list;
+
+		for (FuncDepTblIndex i = first; i < last; i++) {
+
+			if (IsSubsetOf(func_dep_table[i].first, gbl_relation.attributes)) {
+				relevant.push_back(i);
+				lhs_list.push_back(func_dep_table[i].first);
+			}
 
 		}
 
-		// Add closure to relation.
-		gbl_relation.closure.push_back(std::make_pair(fd_tbl_index, closure_rhs));
+		TraceScope trace(tracer, "closure batch", "closure", "fds", relevant.size());
+		std::vector<AttributeSet> closures = batch.Compute(lhs_list,
+			CurrentNormalizationResource(), should_stop);
+
+		for (std::size_t k = 0; k < closures.size(); k++) {
+
+			// A lhs that functionally determines all attributes is a
+			// candidate key.
+			bool is_candidate_key = closures[k].size() == attribute_table.size();
+
+			buffer.push_back(GblClosureResult{ 
+				AttributeSetClosure(relevant[k], std::move(closures[k])), is_candidate_key });
 
+		}
+
+		return closures.size() == relevant.size();
 
 	}
 
@@ -251,69 +593,293 @@ namespace DbNormalizerCpp {
 	// Helper function called by GenerateGlobalRelation() that initializes a 
 	// GlobalRelation's closure using an existing Database.
 	//
+	// The closures are independent, so the functional dependency table is 
+	// split into contiguous ranges computed by up to max_threads threads, 
+	// each into its own buffer and arena. Each range is computed as one
+	// batch by a BatchClosure shared by all threads. Buffers are merged in range order,
+	// so closures and candidate keys end up in functional dependency table
+	// order regardless of the number of threads.
+	//
 	// "gbl_relation":
 	//		GlobalRelation for which the FuncDepSetClosure will be computed.
+	//
+	// "max_threads":
+	//		Maximum number of threads to spawn.
+	//
+	// "run":
+	//		Run whose budget stops the batches, or null. Threads check it
+	//		with the heap bytes of every thread's arena so far, and their
+	//		arenas are counted in its worker bytes.
+	//
+	// Returns Complete if every closure was computed, or why the budget
+	// stopped the batches, in which case "gbl_relation" is incomplete.
 	// =========================================================================
-	void Database::ComputeGblFuncDepSetClosure(GlobalRelation & gbl_relation) {
+	NormalizationStatus Database::ComputeGblFuncDepSetClosure(GlobalRelation &
+		gbl_relation, unsigned int max_threads, NormalizationRun * run) {
 
-		for (FuncDepTblIndex i = 0; i < func_dep_table.size(); i++) {
+		FuncDepTblIndex num_func_deps = static_cast<FuncDepTblIndex>(func_dep_table.size());
+		unsigned int num_threads = max_threads < num_func_deps ? max_threads : num_func_deps;
+		BatchClosure batch(func_dep_table, attribute_table.size());
+		std::atomic<NormalizationStatus> status(Complete);
 
-			// Iterate over func_deps.
+		if (num_threads <= 1) {
 
-			if (IsSubsetOf(func_dep_table[i].first, gbl_relation.attributes)) {
+			GblClosureBuffer buffer(CurrentNormalizationResource());
+			StopPredicate should_stop;
+
+			if (run) {
+				should_stop = [this, run, &status]() {
+					status = CheckBudget(*run);
+					return status != Complete;
+				};
+			}
+
+			ComputeGblClosureRange(0, num_func_deps, gbl_relation, batch, buffer, should_stop);
+
+			for (GblClosureResult & result : buffer) {
+
+				if (result.is_candidate_key)
+					gbl_relation.candidate_keys.push_back(func_dep_table[result.closure.first].first);
+
+				gbl_relation.closure.push_back(std::move(result.closure));
+
+			}
+
+			return status;
+
+		}
+
+		std::vector<std::unique_ptr<NormalizationArena>> arenas;
+		std::vector<GblClosureBuffer> buffers;
+		std::vector<std::thread> threads;
+		std::atomic<std::size_t> arena_bytes(0);	// Heap bytes of all
+													// arenas so far.
+
+		for (unsigned int t = 0; t < num_threads; t++) {
+			arenas.push_back(std::unique_ptr<NormalizationArena>(new NormalizationArena()));
+			buffers.push_back(GblClosureBuffer(arenas[t]->Resource()));
+		}
+
+		for (unsigned int t = 0; t < num_threads; t++) {
+
+			FuncDepTblIndex first = static_cast<FuncDepTblIndex>(
+				static_cast<std::uint64_t>(num_func_deps) * t / num_threads);
+			FuncDepTblIndex last = static_cast<FuncDepTblIndex>(
+				static_cast<std::uint64_t>(num_func_deps) * (t + 1) / num_threads);
+
+			threads.push_back(std::thread([this, first, last, t, run, &gbl_relation,
+				&batch, &arenas, &buffers, &status, &arena_bytes]() {
+
+				ScopedNormalizationResource scope(arenas[t]->Resource());
+				TraceScope trace(tracer, "closure range", "closure", "fds", last - first);
+				std::size_t counted = 0;	// Bytes of this thread's arena
+											// in arena_bytes.
+				StopPredicate should_stop;
+
+				// Only this thread allocates from its arena, and the run's
+				// own arena is not touched until the threads are joined.
+				if (run) {
+					should_stop = [&]() {
+
+						std::size_t bytes = arenas[t]->Stats().upstream_bytes;
+						arena_bytes += bytes - counted;
+						counted = bytes;
 
-				// The current functional dependency is relevant to
-				// relation's attributes, so find the closure of the
-				// set of attributes on the lhs of the current 
-				// functional dependency.
+						NormalizationStatus checked = CheckBudget(*run, arena_bytes);
 
-				ComputeGblAttributeSetClosure(i, gbl_relation);
+						if (checked != Complete)
+							status = checked;
 
+						// Another thread stopping stops this one too.
+						return status != Complete;
+
+					};
+				}
+
+				ComputeGblClosureRange(first, last, gbl_relation, batch, buffers[t], should_stop);
+
+			}));
+
+		}
+
+		for (std::thread & thread : threads)
+			thread.join();
+
+		for (const std::unique_ptr<NormalizationArena> & arena : arenas) {
+
+			allocation_stats += arena->Stats();
+
+			if (run)
+				run->worker_bytes += arena->Stats().upstream_bytes;
+
+		}
+
+		if (status != Complete)
+			return status;
+
+		// Merge in functional dependency table order. Closures are copied 
+		// into gbl_relation's resource before the worker arenas are 
+		// released.
+		for (GblClosureBuffer & buffer : buffers) {
+
+			for (const GblClosureResult & result : buffer) {
+
+				if (result.is_candidate_key)
+					gbl_relation.candidate_keys.push_back(func_dep_table[result.closure.first].first);
+
+				gbl_relation.closure.push_back(result.closure);
+
+			}
+
+		}
+
+		return Complete;
+
+	}
+
+	// =========================================================================
+	// Determines which functional dependencies are not preserved by the
+	// decomposition in relation_table.
+	//
+	// "max_threads":
+	//		Maximum number of threads to spawn to check functional 
+	//		dependencies.
+	//
+	// Returns the indexes of all lost functional dependencies in ascending
+	// order.
+	// =========================================================================
+	FuncDepTblIndexList Database::FindLostFuncDeps(unsigned int max_threads) {
+
+		std::vector<char> preserved(func_dep_table.size(), 0);
+		unsigned int num_threads = max_threads;
+
+		if (num_threads > func_dep_table.size())
+			num_threads = static_cast<unsigned int>(func_dep_table.size());
+
+		if (num_threads <= 1) {
+			CheckFuncDepPreservation(0, 1, preserved);
+		}
+		else {
+
+			// Each thread checks an interleaved slice of the functional
+			// dependency table and only writes to its own slots.
+			std::vector<std::thread> threads;
+
+			for (unsigned int t = 0; t < num_threads; t++) {
+				threads.push_back(std::thread(&Database::CheckFuncDepPreservation,
+					this, t, num_threads, std::ref(preserved)));
 			}
 
+			for (std::thread & thread : threads)
+				thread.join();
+
+		}
+
+		FuncDepTblIndexList lost_func_deps;
+
+		for (FuncDepTblIndex i = 0; i < func_dep_table.size(); i++) {
+
+			if (!preserved[i])
+				lost_func_deps.push_back(i);
+
 		}
 
+		return lost_func_deps;
+
 	}
 
 	// =========================================================================
 	// Helper function called by NormalizeTo2nf() to create the global 
 	// (first) Relation. The global Relation's closure is also computed.
 	//
-	// Returns the generated global Relation.
+	// "max_threads":
+	//		Maximum number of threads to spawn to compute the closure.
+	//
+	// "run":
+	//		Run whose budget stops the closure and the search for a
+	//		smallest key, or null. Its status is set if the closure is
+	//		stopped, and the global relation's candidate keys are counted
+	//		in its progress otherwise.
+	//
+	// Returns the generated global Relation. If the budget stopped its
+	// closure, the relation is incomplete and has no primary key. If it
+	// stopped the search for a smallest key, the primary key is the
+	// smallest candidate key found so far.
 	// =========================================================================
-	GlobalRelation Database::GenerateGlobalRelation() {
+	GlobalRelation Database::GenerateGlobalRelation(unsigned int max_threads,
+		NormalizationRun * run) {
 
-		GlobalRelation gbl_relation;
+		TraceScope trace(tracer, "global relation", "phase");
+		GlobalRelation gbl_relation(CurrentNormalizationResource());
 
 		gbl_relation.name = GLOBAL_RELATION_NAME;
 
 		for (AttributeTblIndex i = 0; i < attribute_table.size(); i++)
 			gbl_relation.attributes.insert(i);
 
-		ComputeGblFuncDepSetClosure(gbl_relation);
-		AssignPrimaryKey(gbl_relation);
+		if (!run) {
+			ComputeGblFuncDepSetClosure(gbl_relation, max_threads);
+			AssignPrimaryKey(gbl_relation);
+			return gbl_relation;
+		}
+
+		run->status = ComputeGblFuncDepSetClosure(gbl_relation, max_threads, run);
+
+		if (run->status != Complete)
+			return gbl_relation;
+
+		AssignPrimaryKey(gbl_relation, [this, run]() {
+			return CheckBudget(*run) != Complete;
+		});
+
+		run->progress.keys_found += gbl_relation.candidate_keys.size();
+		ReportProgress(*run);
 
 		return gbl_relation;
 
 	}
 
+	// =========================================================================
+	// Returns func_dep_table packed for MinimumKeyFinder and
+	// PrimeAttributeFinder, packing it again only if the functional
+	// dependencies or attributes changed since it was last packed. Not
+	// thread-safe while stale, so normalization packs it before starting
+	// any worker, and releases it when it ends.
+	// =========================================================================
+	const PackedFuncDepTable & Database::GetPackedFuncDepTable() {
+
+		if (packed_func_dep_table_stale) {
+			packed_func_dep_table = PackedFuncDepTable(func_dep_table, attribute_table.size());
+			packed_func_dep_table_stale = false;
+		}
+
+		return packed_func_dep_table;
+
+	}
+
 	// =========================================================================
 	// Inserts an attribute into this database.
 	//
 	// "attr_name":
 	//		The name of the attribute to insert.
 	//
+	// "type":
+	//		The type of the attribute's values.
+	//
 	// Side effects:
 	//		An attribute is inserted into private data member 
 	//		"attribute_table", increasing its size by 1.
 	// =========================================================================
-	void Database::InsertAttribute(const std::string & attr_name) {
+	void Database::InsertAttribute(const std::string & attr_name,
+		AttributeType type) {
 
 		Attribute attr;
 		attr.name = attr_name;
+		attr.type = type;
 		attribute_table.push_back(attr);
 		attribute_index_map.insert(std::make_pair(attr_name, table_index));
 		table_index++;
+		packed_func_dep_table_stale = true;
 
 	}
 	
@@ -339,12 +905,125 @@ namespace DbNormalizerCpp {
 		AppendToFuncDep(func_dep, left);
 		AppendToFuncDep(func_dep, right, false);
 
-		func_dep_table.push_back(std::make_pair(left, right));
+		// Drop the trivial part of the functional dependency.
+		for (AttributeTblIndex attr : left)
+			right.erase(attr);
 
-	}
+		if (right.empty())
+			return;
 
-	// =========================================================================
-	// Determines whether an attribute set is a proper subset of a Relation's
+		SortedAttributeList key(left.begin(), left.end());
+		std::sort(key.begin(), key.end());
+
+		LhsIndexMap::iterator it = lhs_index_map.find(key);
+
+		if (it != lhs_index_map.end()) {
+
+			// The lhs is already stored, so merge the rhs into it.
+
+			func_dep_table[it->second].second.UnionWith(right);
+
+		}
+		else {
+
+			lhs_index_map.insert(std::make_pair(std::move(key), 
+				static_cast<FuncDepTblIndex>(func_dep_table.size())));
+			func_dep_table.push_back(std::make_pair(left, right));
+
+		}
+
+		packed_func_dep_table_stale = true;
+
+	}
+
+	// =========================================================================
+	// Inserts multivalued dependency into this database.
+	// 
+	// "mvd":
+	//		The multivalued dependency to insert.
+	//
+	// Precondition: 
+	//		The attribute table is populated with the attributes referenced
+	//		in the mvd.
+	//
+	// Side effects:
+	//		A multivalued dependency is inserted into private data member
+	//		"mvd_table", increasing its size by 1.
+	// =========================================================================
+	void Database::InsertMultiValuedDep(SimpleFuncDep & mvd) {
+
+		Lhs left;
+		Rhs right;
+
+		AppendToFuncDep(mvd, left);
+		AppendToFuncDep(mvd, right, false);
+
+		mvd_table.push_back(std::make_pair(left, right));
+
+	}
+
+	// =========================================================================
+	// Determines whether a functional dependency is preserved by the 
+	// decomposition in relation_table using the restricted closure 
+	// algorithm.
+	//
+	// "fd_tbl_index":
+	//		Index into the functional dependency table of the functional
+	//		dependency to check.
+	//
+	// Returns true if the functional dependency is implied by the union of
+	// the projections onto every relation in relation_table.
+	// =========================================================================
+	bool Database::IsFuncDepPreserved(FuncDepTblIndex fd_tbl_index) {
+
+		const FuncDep & func_dep = func_dep_table[fd_tbl_index];
+		AttributeSet z(func_dep.first.begin(), func_dep.first.end());
+		bool new_insertion;
+
+		do {
+
+			new_insertion = false;
+
+			for (const Relation & relation : relation_table) {
+
+				// Z n Ri
+				AttributeSet restricted;
+
+				for (AttributeTblIndex attr : z) {
+
+					if (relation.attributes.find(attr) != relation.attributes.end())
+						restricted.insert(attr);
+
+				}
+
+				if (restricted.empty())
+					continue;
+
+				// Z = Z u ((Z n Ri)* n Ri)
+				for (AttributeTblIndex attr : ComputeClosureOf(restricted)) {
+
+					if (relation.attributes.find(attr) != relation.attributes.end()
+						&& z.insert(attr).second) {
+
+						new_insertion = true;
+
+					}
+
+				}
+
+			}
+
+			if (IsSubsetOf(func_dep.second, z))
+				return true;
+
+		} while (new_insertion);
+
+		return false;
+
+	}
+
+	// =========================================================================
+	// Determines whether an attribute set is a proper subset of a Relation's
 	// primary key.
 	//
 	// "attributes":
@@ -378,168 +1057,762 @@ namespace DbNormalizerCpp {
 	//
 	// Returns true if "a" is a subset of "b".
 	// =========================================================================
-	bool Database::IsSubsetOf(AttributeSet & a, AttributeSet & b) {
+	bool Database::IsSubsetOf(const AttributeSet & a, const AttributeSet & b) {
+
+		return a.IsSubsetOf(b);
+
+	}
+
+	// =========================================================================
+	// Moves the relations left in a normalization queue, e.g., when a run
+	// stops early, into relation_table as they are.
+	//
+	// "normalization_queue":
+	//		Queue of relations to keep.
+	// =========================================================================
+	void Database::KeepQueuedRelations(NormalizationQueue & normalization_queue) {
+
+		while (!normalization_queue.empty()) {
+
+			NameRelation(normalization_queue.front());
+			relation_table.push_back(std::move(normalization_queue.front()));
+			normalization_queue.pop();
+
+		}
+
+	}
+
+	// =========================================================================
+	// Uses attribute_index_map to find index of an attribute by using its name.
+	//
+	// "attr_name":
+	//		Name of attribute to find in attribute table.
+	//
+	// Returns the index into the attribute table at which the attribute is 
+	// located.
+	// =========================================================================
+	AttributeTblIndex Database::LookUpAttributeTblIndex(const std::string &
+		attr_name) {
+
+		auto it = attribute_index_map.find(attr_name);
+
+		if (it != attribute_index_map.end())
+			return it->second;
+		return -1;
+
+	}
+
+	// =========================================================================
+	// Marks all prime attributes in attribute_table, i.e., attributes that 
+	// belong to any candidate key of the global relation, not only to its 
+	// primary key. Uses a PrimeAttributeFinder, so candidate keys are never
+	// enumerated.
+	//
+	// "run":
+	//		Run whose budget stops the search, or null. Attributes left
+	//		unresolved are marked prime, and the candidate keys the search
+	//		found are counted in its progress.
+	//
+	// Side effects:
+	//		Attributes in private member "attribute_table" are modified by
+	//		setting "prime" to true or false.
+	// =========================================================================
+	void Database::MarkPrimeAttributes(NormalizationRun * run) {
+
+		TraceScope trace(tracer, "prime attributes", "phase");
+		StopPredicate should_stop;
+
+		if (run) {
+			should_stop = [this, run]() {
+				return CheckBudget(*run) != Complete;
+			};
+		}
+
+		PrimeAttributeFinder finder(GetPackedFuncDepTable(),
+			PrimeAttributeFinder::DEFAULT_SEARCH_BUDGET, should_stop);
+		std::vector<char> prime = finder.Find();
+
+		for (AttributeTblIndex i = 0; i < attribute_table.size(); i++)
+			attribute_table[i].prime = prime[i] != 0;
+
+		if (run) {
+			run->progress.keys_found += finder.KeysFound();
+			ReportProgress(*run);
+		}
+
+	}
+
+	// =========================================================================
+	// Copies the relations of a normalized component database into 
+	// relation_table, mapping attribute and functional dependency indexes
+	// back to this database's.
+	//
+	// "component_db":
+	//		Normalized database of the component.
+	//
+	// "attributes":
+	//		Attribute table index of every attribute of the component
+	//		database.
+	//
+	// "func_deps":
+	//		Functional dependency table index of every functional dependency
+	//		of the component database.
+	//
+	// "link_attributes":
+	//		Attributes of the linking relation. Relations whose attributes
+	//		are all in it are skipped: they only hold part of a candidate
+	//		key of the component, which the linking relation holds as the
+	//		whole schema's global relation would.
+	// =========================================================================
+	void Database::MergeComponentRelations(const Database & component_db,
+		const SortedAttributeList & attributes, const FuncDepTblIndexList & func_deps,
+		const AttributeSet & link_attributes) {
+
+		auto to_global = [&](const AttributeSet & attribute_set) {
+
+			AttributeSet global;
+
+			for (AttributeTblIndex attr : attribute_set)
+				global.insert(attributes[attr]);
+
+			return global;
+
+		};
+
+		for (const Relation & component_relation : component_db.relation_table) {
+
+			Relation relation(relation_table.get_allocator());
+
+			relation.attributes = to_global(component_relation.attributes);
+
+			if (IsSubsetOf(relation.attributes, link_attributes))
+				continue;
+
+			relation.primary_key = to_global(component_relation.primary_key);
+
+			for (const CandidateKey & candidate_key : component_relation.candidate_keys)
+				relation.candidate_keys.push_back(to_global(candidate_key));
+
+			for (const AttributeSetClosure & closure : component_relation.closure) {
+				relation.closure.push_back(std::make_pair(func_deps[closure.first],
+					to_global(closure.second)));
+			}
+
+			NameRelation(relation);
+			relation_table.push_back(std::move(relation));
+
+		}
+
+		for (AttributeTblIndex i = 0; i < attributes.size(); i++)
+			attribute_table[attributes[i]].prime = component_db.attribute_table[i].prime;
+
+	}
+
+	// =========================================================================
+	// Multi-threaded 2NF
+	// =========================================================================
+	void Database::MultiThreaded2nf(NormalizationQueue & 
+		normalization_queue, unsigned int max_threads, NormalizationRun & run) {
+
+		MultiThreadedNormalize(normalization_queue, max_threads, 
+			&Database::RelationTo2nf, run);
+
+	}
+
+	// =========================================================================
+	// Multi-threaded 3NF
+	// =========================================================================
+	RelationTable Database::MultiThreaded3nf(NormalizationQueue &
+		normalization_queue, unsigned int max_threads) {
+
+		return RelationTable();
+
+	}
+
+	// =========================================================================
+	// Multi-threaded 4NF
+	// =========================================================================
+	void Database::MultiThreaded4nf(NormalizationQueue &
+		normalization_queue, unsigned int max_threads, NormalizationRun & run) {
+
+		MultiThreadedNormalize(normalization_queue, max_threads,
+			&Database::RelationTo4nf, run);
+
+	}
+
+	// =========================================================================
+	// Normalizes every relation in a normalization queue using up to 
+	// max_threads threads that share the queue. A relation for which
+	// "relation_step" returns only 1 relation is final and is added to 
+	// relation_table. Otherwise, the returned relations are queued. The 
+	// budget is checked before every relation is popped; once it is 
+	// exhausted, workers finish the relation they hold and stop, and 
+	// relations still queued are kept as they are.
+	//
+	// "normalization_queue":
+	//		Queue of relations to normalize.
+	//
+	// "max_threads":
+	//		Maximum number of threads to spawn.
+	//
+	// "relation_step":
+	//		Member function that normalizes one relation, e.g., 
+	//		RelationTo2nf().
+	//
+	// "run":
+	//		Budget, progress, and status of the run. Only accessed while
+	//		holding the queue's lock.
+	// =========================================================================
+	void Database::MultiThreadedNormalize(NormalizationQueue &
+		normalization_queue, unsigned int max_threads, 
+		RelationStep relation_step, NormalizationRun & run) {
+
+		std::mutex queue_mutex;
+		std::condition_variable queue_cv;
+		unsigned int busy_workers = 0;
+
+		// At least one worker must drain the queue.
+		if (max_threads == 0)
+			max_threads = 1;
+		std::exception_ptr error;
+
+		// When tracing, the trace id of the thread that queued every 
+		// relation, 0 for relations queued before the workers start. A 
+		// worker that pops a relation queued by another worker records a
+		// steal.
+		std::deque<std::uint32_t> producers;
+
+		if (tracer)
+			producers.assign(normalization_queue.size(), 0);
+
+		run.progress.relations_queued += normalization_queue.size();
+
+		// Every worker allocates from its own arena. The queue keeps 
+		// allocating from the caller's arena, which is only touched while
+		// holding queue_mutex.
+		std::vector<std::unique_ptr<NormalizationArena>> arenas;
+
+		for (unsigned int t = 0; t < max_threads; t++)
+			arenas.push_back(std::unique_ptr<NormalizationArena>(new NormalizationArena()));
+
+		auto worker = [&](NormalizationArena * arena) {
+
+			ScopedNormalizationResource scope(arena->Resource());
+			TraceScope trace(tracer, "worker", "worker");
+			std::uint32_t thread_id = tracer ? tracer->ThreadId() : 0;
+			std::size_t arena_bytes = arena->Stats().upstream_bytes;
+			std::unique_lock<std::mutex> lock(queue_mutex);
+
+			run.worker_bytes += arena_bytes;
+
+			while (true) {
+
+				// Wait until there is work or until no busy worker can
+				// produce any more.
+				queue_cv.wait(lock, [&]() {
+					return !normalization_queue.empty() || busy_workers == 0 || error
+						|| run.status != Complete;
+				});
+
+				if (run.status == Complete && !error && !normalization_queue.empty())
+					run.status = CheckBudget(run);
+
+				if (error || normalization_queue.empty() || run.status != Complete) {
+					queue_cv.notify_all();
+					break;
+				}
+
+				Relation next = std::move(normalization_queue.front());
+				normalization_queue.pop();
+				busy_workers++;
+
+				if (tracer) {
+
+					tracer->Instant("pop", "queue", "size", normalization_queue.size());
+
+					if (producers.front() != 0 && producers.front() != thread_id)
+						tracer->Instant("steal", "queue", "from_thread", producers.front());
+
+					producers.pop_front();
+
+				}
+
+				lock.unlock();
+
+				RelationTable decomposed_relations(arena->Resource());
+				std::exception_ptr step_error;
+
+				try {
+
+					decomposed_relations = (this->*relation_step)(next);
+
+					if (decomposed_relations.size() < 1)
+						throw std::runtime_error("Internal error. Normalization should never return 0 decomposed relations.");
+
+				}
+				catch (...) {
+					step_error = std::current_exception();
+				}
+
+				lock.lock();
+				busy_workers--;
+
+				std::size_t arena_bytes_after = arena->Stats().upstream_bytes;
+				run.worker_bytes += arena_bytes_after - arena_bytes;
+				arena_bytes = arena_bytes_after;
+
+				if (step_error) {
+					error = step_error;
+				}
+				else if (decomposed_relations.size() == 1) {
+					NameRelation(decomposed_relations.front());
+					relation_table.push_back(std::move(decomposed_relations.front()));
+				}
+				else {
+
+					for (Relation & decomposed_relation : decomposed_relations)
+						normalization_queue.push(std::move(decomposed_relation));
+
+					if (tracer) {
+						producers.insert(producers.end(), decomposed_relations.size(), thread_id);
+						tracer->Instant("push", "queue", "size", normalization_queue.size());
+					}
+
+				}
+
+				if (!step_error)
+					RecordNormalizedRelation(run, decomposed_relations);
+
+				queue_cv.notify_all();
+
+			}
+
+		};
+
+		std::vector<std::thread> threads;
+
+		for (unsigned int t = 0; t < max_threads; t++)
+			threads.push_back(std::thread(worker, arenas[t].get()));
+
+		for (std::thread & thread : threads)
+			thread.join();
+
+		for (const std::unique_ptr<NormalizationArena> & arena : arenas)
+			allocation_stats += arena->Stats();
+
+		if (error)
+			std::rethrow_exception(error);
+
+		KeepQueuedRelations(normalization_queue);
+
+	}
+
+	// =========================================================================
+	// Names a final Relation "r1", "r2", etc. unless it already has a name.
+	//
+	// "relation":
+	//		Relation to name.
+	//
+	// Side effects:
+	//		Increments private data member "relation_num".
+	// =========================================================================
+	void Database::NameRelation(Relation & relation) {
+
+		if (relation.name.empty())
+			relation.name = "r" + std::to_string(relation_num++);
+
+	}
+
+	// =========================================================================
+	// Normalizes database to 2NF or 4NF one independent component at a time.
+	// =========================================================================
+	void Database::NormalizeComponents(NormalForm target, unsigned int max_threads) {
+
+		if (target != NormalForm::Two && target != NormalForm::Four)
+			throw std::invalid_argument("Components can only be normalized to 2NF or 4NF!");
+
+		if (normal_form >= target)
+			return;
+
+		SchemaPartition partition(attribute_table.size(), func_dep_table, mvd_table);
+		const std::vector<SortedAttributeList> & components = partition.Components();
+
+		if (components.size() <= 1 || !relation_table.empty()) {
+
+			// Nothing to split, or an earlier run already decomposed the
+			// database as a whole.
+			if (target == NormalForm::Two)
+				NormalizeTo2nf(max_threads);
+			else
+				NormalizeTo4nf(max_threads);
+
+			return;
+
+		}
+
+		TraceScope trace(tracer, "NormalizeComponents", "phase", "components", 
+			components.size());
+
+		std::vector<AttributeTblIndex> local_index(attribute_table.size(), 0);
+		std::vector<Database> component_dbs(components.size());
+		std::vector<CandidateKey> component_keys(components.size());
+		std::vector<std::size_t> order(components.size());
+
+		for (const SortedAttributeList & component : components) {
+
+			for (AttributeTblIndex i = 0; i < component.size(); i++)
+				local_index[component[i]] = i;
+
+		}
+
+		for (std::size_t c = 0; c < components.size(); c++) {
+			BuildComponentDatabase(partition, c, local_index, component_dbs[c]);
+			order[c] = c;
+		}
+
+		// Hand out the largest components first so that a large component
+		// does not start last and leave the other workers idle.
+		std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+			return components[a].size() > components[b].size();
+		});
+
+		unsigned int num_workers = max_threads < components.size() 
+			? max_threads : static_cast<unsigned int>(components.size());
+
+		if (num_workers < 1)
+			num_workers = 1;
+
+		unsigned int threads_per_component = max_threads / num_workers > 1 
+			? max_threads / num_workers : 1;
+		std::atomic<std::size_t> next_component(0);
+		std::mutex error_mutex;
+		std::exception_ptr error;
+
+		auto worker = [&]() {
+
+			for (std::size_t i = next_component++; i < order.size(); i = next_component++) {
+
+				Database & component_db = component_dbs[order[i]];
+				TraceScope trace(tracer, "component", "component", "attributes",
+					components[order[i]].size());
+
+				try {
+
+					if (target == NormalForm::Two)
+						component_db.NormalizeTo2nf(threads_per_component);
+					else
+						component_db.NormalizeTo4nf(threads_per_component);
+
+					// A candidate key of the whole component, i.e., of the
+					// component's global relation.
+					Relation component_relation;
+
+					for (AttributeTblIndex attr = 0; attr < components[order[i]].size(); attr++)
+						component_relation.attributes.insert(attr);
+
+					component_db.ComputeCandidateKey(component_relation);
+					component_keys[order[i]] = component_relation.candidate_keys.front();
+
+				}
+				catch (...) {
+
+					std::lock_guard<std::mutex> lock(error_mutex);
+
+					if (!error)
+						error = std::current_exception();
+
+				}
+
+			}
+
+		};
+
+		if (num_workers == 1) {
+			worker();
+		}
+		else {
+
+			std::vector<std::thread> threads;
+
+			for (unsigned int t = 0; t < num_workers; t++)
+				threads.push_back(std::thread(worker));
+
+			for (std::thread & thread : threads)
+				thread.join();
+
+		}
+
+		if (error)
+			std::rethrow_exception(error);
+
+		// The linking relation joins the components back together. It is
+		// all key, so it is in 2NF and 4NF, and plays the part of the whole
+		// schema's global relation.
+		Relation link(relation_table.get_allocator());
+
+		for (std::size_t c = 0; c < components.size(); c++) {
+
+			for (AttributeTblIndex attr : component_keys[c])
+				link.attributes.insert(components[c][attr]);
+
+		}
+
+		for (AttributeTblIndex attr : partition.Isolated())
+			link.attributes.insert(attr);
+
+		// Merge in component order, so that the result does not depend on
+		// the number of threads. Component relations inside the linking
+		// relation are dropped.
+		allocation_stats = AllocationStats();
+
+		for (std::size_t c = 0; c < components.size(); c++) {
+			MergeComponentRelations(component_dbs[c], components[c], partition.FuncDeps()[c],
+				link.attributes);
+			allocation_stats += component_dbs[c].allocation_stats;
+		}
+
+		for (AttributeTblIndex attr : partition.Isolated())
+			attribute_table[attr].prime = true;
+
+		// The linking relation itself is only redundant if a component
+		// relation already holds all of its attributes.
+		bool is_redundant = false;
+
+		for (const Relation & relation : relation_table)
+			is_redundant = is_redundant || IsSubsetOf(link.attributes, relation.attributes);
+
+		if (!is_redundant) {
+
+			link.candidate_keys.push_back(link.attributes);
+			AssignPrimaryKey(link);
+			ComputeFuncDepSetClosure(link);
+			NameRelation(link);
+			relation_table.push_back(std::move(link));
+
+		}
+
+		normal_form = target;
+		ReleasePackedFuncDepTable();
+
+	}
+
+	// =========================================================================
+	// Normalizes database to 2NF.
+	// =========================================================================
+	void Database::NormalizeTo2nf(unsigned int max_threads) { 
+		
+		NormalizeTo2nf(NormalizationBudget(), max_threads);
+
+	}
+
+	// =========================================================================
+	// Normalizes database to 2NF within a budget.
+	// =========================================================================
+	NormalizationStatus Database::NormalizeTo2nf(const NormalizationBudget &
+		budget, unsigned int max_threads) { 
+		
+		if (normal_form >= NormalForm::Two)
+			return Complete;
+
+		// 0 threads would spawn no worker and leave the queue undrained.
+		if (max_threads == 0)
+			max_threads = 1;
+
+		TraceScope trace(tracer, "NormalizeTo2nf", "phase", "max_threads", max_threads);
+
+		// Workers only read the packed functional dependencies.
+		GetPackedFuncDepTable();
+
+		// Everything allocated while normalizing comes from this run's
+		// arenas and is released at once when the run ends. Final relations
+		// are copied out into relation_table.
+		NormalizationArena arena;
+		ScopedNormalizationResource scope(arena.Resource());
+		NormalizationQueue normalization_queue(
+			std::pmr::polymorphic_allocator<Relation>(arena.Resource()));
+		NormalizationRun run(budget, arena);
+
+		allocation_stats = AllocationStats();
+
+		// Generate global relation and add it to relation_table, unless an
+		// earlier run stopped early and left a partial result to resume. A
+		// global relation whose closure the budget cut short is dropped,
+		// so the next run starts over.
+		if (relation_table.empty()) {
+
+			GlobalRelation gbl_relation = GenerateGlobalRelation(max_threads, &run);
+
+			if (run.status == Complete)
+				relation_table.push_back(std::move(gbl_relation));
 
-		for (AttributeSet::const_iterator a_it = a.begin();
-			a_it != a.end(); a_it++) {
+		}
+
+		if (run.status == Complete) {
+
+			MarkPrimeAttributes(&run);
+
+			// Queue relations for normalization. The budget is checked
+			// again before the first relation is popped.
+			QueuePreNormalizedRelations(normalization_queue);
 
-			if (b.find(*a_it) == b.end())
-				return false;
+			if (max_threads == 1) {
+				// Normalize using this existing thread.
+				SingleThreaded2nf(normalization_queue, run);
+			}
+			else {
+				// Normalize using additional threads.
+				MultiThreaded2nf(normalization_queue, max_threads, run);
+
+			}
 
 		}
 
-		return true;
+		if (run.status == Complete)
+			normal_form = NormalForm::Two;
+
+		allocation_stats += arena.Stats();
+		ReleasePackedFuncDepTable();
+
+		return run.status;
 
 	}
 
 	// =========================================================================
-	// Uses attribute_index_map to find index of an attribute by using its name.
-	//
-	// "attr_name":
-	//		Name of attribute to find in attribute table.
-	//
-	// Returns the index into the attribute table at which the attribute is 
-	// located.
+	// Normalizes database to 3NF.
 	// =========================================================================
-	AttributeTblIndex Database::LookUpAttributeTblIndex(const std::string &
-		attr_name) {
+	void Database::NormalizeTo3nf(unsigned int max_threads) { 
+			
+	}
 
-		auto it = attribute_index_map.find(attr_name);
+	// =========================================================================
+	// Normalizes database to 4NF.
+	// =========================================================================
+	void Database::NormalizeTo4nf(unsigned int max_threads) {
 
-		if (it != attribute_index_map.end())
-			return it->second;
-		return -1;
+		NormalizeTo4nf(NormalizationBudget(), max_threads);
 
 	}
 
 	// =========================================================================
-	// Marks all prime attributes in attribute_table.
-	//
-	// Precondition: 
-	//		The global relation is generated and at index 0
-	//		in private member "relation_table".
-	//
-	// Side effects:
-	//		Attributes in private member "attribute_table" are modified by
-	//		setting "prime" to true.
+	// Normalizes database to 4NF within a budget.
 	// =========================================================================
-	void Database::MarkPrimeAttributes() {
+	NormalizationStatus Database::NormalizeTo4nf(const NormalizationBudget &
+		budget, unsigned int max_threads) {
 
-		for (AttributeTblIndex i = 0; i < attribute_table.size(); i++) {
+		if (normal_form >= NormalForm::Four)
+			return Complete;
 
-			if (relation_table.front().primary_key.find(i)
-				!= relation_table.front().primary_key.end()) {
+		// 0 threads would spawn no worker and leave the queue undrained.
+		if (max_threads == 0)
+			max_threads = 1;
 
-				// The current attribute exists in the global relation's
-				// primary key.
+		TraceScope trace(tracer, "NormalizeTo4nf", "phase", "max_threads", max_threads);
 
-				attribute_table[i].prime = true; // Mark as prime attribute.
+		// Workers only read the packed functional dependencies.
+		GetPackedFuncDepTable();
 
-			}
+		NormalizationArena arena;
+		ScopedNormalizationResource scope(arena.Resource());
+		NormalizationQueue normalization_queue(
+			std::pmr::polymorphic_allocator<Relation>(arena.Resource()));
+		NormalizationRun run(budget, arena);
 
-		}
+		allocation_stats = AllocationStats();
 
-	}
+		// Start from the global relation unless relations have already been
+		// decomposed, e.g., by NormalizeTo2nf() or by an earlier run that
+		// stopped early. A global relation whose closure the budget cut
+		// short is dropped.
+		if (relation_table.empty()) {
 
-	// =========================================================================
-	// Multi-threaded 2NF
-	// =========================================================================
-	RelationTable Database::MultiThreaded2nf(NormalizationQueue & 
-		normalization_queue, unsigned int max_threads) {
+			GlobalRelation gbl_relation = GenerateGlobalRelation(max_threads, &run);
 
-		unsigned int num_threads = 0;
+			if (run.status == Complete)
+				relation_table.push_back(std::move(gbl_relation));
 
-		while (!normalization_queue.empty() || num_threads > 0) {
+		}
 
-			if (num_threads == max_threads) {
-				// wait until a thread finishes
-				// process all done threads
-				// decrement num_threads by done threads
-			}
+		if (run.status == Complete) {
 
-			Relation &next = normalization_queue.front();
-			normalization_queue.pop();
-			RelationTo2nf(next); // Generates a new thread to normalize relation.					
+			QueuePreNormalizedRelations(normalization_queue);
+
+			if (max_threads == 1)
+				SingleThreaded4nf(normalization_queue, run);
+			else
+				MultiThreaded4nf(normalization_queue, max_threads, run);
 
 		}
 
-		return RelationTable();
+		if (run.status == Complete)
+			normal_form = NormalForm::Four;
+
+		allocation_stats += arena.Stats();
+		ReleasePackedFuncDepTable();
+
+		return run.status;
 
 	}
 
 	// =========================================================================
-	// Multi-threaded 3NF
+	// Prints database.
 	// =========================================================================
-	RelationTable Database::MultiThreaded3nf(NormalizationQueue &
-		normalization_queue, unsigned int max_threads) {
+	void Database::Print() {
 
-		return RelationTable();
+		Print(std::cout);
 
 	}
 
 	// =========================================================================
-	// Normalizes database to 2NF.
+	// Prints database to a stream.
 	// =========================================================================
-	void Database::NormalizeTo2nf(unsigned int max_threads) { 
-		
-		if (normal_form >= NormalForm::Two)
-			return;
+	void Database::Print(std::ostream & stream) {
 
-		int num_threads = 0;
-		NormalizationQueue normalization_queue;
+		stream << "Database:\n\nName: ";
+		PrintName(stream);
 
-		// Generate global relation and add it to relation_table.
-		relation_table.push_back(GenerateGlobalRelation());
-		MarkPrimeAttributes();
+		stream << "\n\nAttributes:\n";
+		PrintAttrTable(stream);
 
-		return;
-
-		// Queue global relation for normalization.
-		QueuePreNormalizedRelations(normalization_queue);
-
-		if (max_threads == 1) {
-			// Normalize using this existing thread.
-			SingleThreaded2nf(normalization_queue);
-		}
-		else {
-			// Normalize using additional threads.
-			MultiThreaded2nf(normalization_queue, max_threads);
+		stream << "\n\nFunctional Dependencies:\n";
+		PrintFuncDepTable(stream);
 
+		if (!mvd_table.empty()) {
+			stream << "\nMultivalued Dependencies:\n";
+			PrintMultiValuedDepTable(stream);
 		}
 
-		return;
+		stream << "\nDecomposed Relations:\n\n";
+		PrintRelationTable(stream);
 
 	}
 
 	// =========================================================================
-	// Normalizes database to 3NF.
+	// Prints one relation to a stream.
 	// =========================================================================
-	void Database::NormalizeTo3nf(unsigned int max_threads) { 
-			
+	void Database::Print(std::ostream & stream, const Relation & relation) {
+
+		PrintRelation(stream, relation);
+
 	}
 
 	// =========================================================================
-	// Prints database.
+	// Prints the allocation counts of the last normalization run.
 	// =========================================================================
-	void Database::Print() {
-
-		std::cout << "Database:\n\nName: ";
-		PrintName();
+	void Database::PrintAllocationStats() {
 
-		std::cout << "\n\nAttributes:\n";
-		PrintAttrTable();
-
-		std::cout << "\n\nFunctional Dependencies:\n";
-		PrintFuncDepTable();
-
-		std::cout << "\nDecomposed Relations:\n\n";
-		PrintRelationTable();
+		std::cout << "Normalization allocations: " << allocation_stats.allocations
+			<< " (" << allocation_stats.bytes << " bytes) served by arenas from "
+			<< allocation_stats.upstream_allocations << " heap allocation(s) ("
+			<< allocation_stats.upstream_bytes << " bytes)\n";
 
 	}
 
 	// =========================================================================
 	// Prints an Attribute.
 	// 
+	// "stream":
+	//		Stream to print to.
+	//
 	// "attribute":
 	//		The attribute to print.
 	//
@@ -547,14 +1820,14 @@ namespace DbNormalizerCpp {
 	//		If true, prints extra information about "attribute", e.g, whether
 	//		the attribute is prime or not.
 	// =========================================================================
-	void Database::PrintAttribute(const Attribute & attribute, 
-		bool verbose = false) {
+	void Database::PrintAttribute(std::ostream & stream, 
+		const Attribute & attribute, bool verbose = false) {
 
-		std::cout << attribute.name;
+		stream << attribute.name;
 
 		if (verbose) {
 			std::string prime_str = attribute.prime == true ? "*prime*" : "";
-			std::cout << " : " << prime_str;
+			stream << " : " << prime_str;
 		}
 
 	}
@@ -562,6 +1835,9 @@ namespace DbNormalizerCpp {
 	// =========================================================================
 	// Prints an Attribute From an AttributeTblIndex.
 	//
+	// "stream":
+	//		Stream to print to.
+	//
 	// "index":
 	//		Index of attribute to print.
 	//
@@ -569,83 +1845,94 @@ namespace DbNormalizerCpp {
 	//		If true, prints extra information about "attribute", e.g, whether it
 	//		is prime or not.
 	// =========================================================================
-	void Database::PrintAttributeFromIndex(AttributeTblIndex index, 
-		bool verbose = false) {
+	void Database::PrintAttributeFromIndex(std::ostream & stream, 
+		AttributeTblIndex index, bool verbose = false) {
 
-		PrintAttribute(attribute_table[index], verbose);
+		PrintAttribute(stream, attribute_table[index], verbose);
 
 	}
 
 	// =========================================================================
 	// Prints an AttributeSet.
 	//
+	// "stream":
+	//		Stream to print to.
+	//
 	// "attribute_set":
 	//		Set of attributes to print.
 	// =========================================================================
-	void Database::PrintAttrSet(const AttributeSet & attribute_set) {
+	void Database::PrintAttrSet(std::ostream & stream, 
+		const AttributeSet & attribute_set) {
 
-		std::cout << "{ ";
+		stream << "{ ";
 
 		for (AttributeSet::const_iterator it = attribute_set.begin(); it != attribute_set.end(); it++) {
 
-			PrintAttributeFromIndex(*it);
+			PrintAttributeFromIndex(stream, *it);
 			std::string comma = std::next(it, 1) != attribute_set.end() ? ", " : "";
-			std::cout << comma;
+			stream << comma;
 
 		}
 
-		std::cout << " }";
+		stream << " }";
 
 	}
 
 	// =========================================================================
 	// Prints an AttributeSetClosure.
 	//
+	// "stream":
+	//		Stream to print to.
+	//
 	// "attribute_set_closure":
 	//		Closure of an attribute set to print.
 	// =========================================================================
-	void Database::PrintAttributeSetClosure(const AttributeSetClosure & 
-		attribute_set_closure) {
+	void Database::PrintAttributeSetClosure(std::ostream & stream, 
+		const AttributeSetClosure & attribute_set_closure) {
 
-		PrintAttrSet(func_dep_table[attribute_set_closure.first].first);
-		std::cout << " -> ";
-		PrintAttrSet(attribute_set_closure.second);
+		PrintAttrSet(stream, func_dep_table[attribute_set_closure.first].first);
+		stream << " -> ";
+		PrintAttrSet(stream, attribute_set_closure.second);
 
 	}
 
 	// =========================================================================
 	// Prints this database's attribute table.
 	// =========================================================================
-	void Database::PrintAttrTable() {
+	void Database::PrintAttrTable(std::ostream & stream) {
 
-		std::cout << "{ ";
+		stream << "{ ";
 
 		for (AttributeTable::const_iterator it = attribute_table.begin();
 			it != attribute_table.end(); it++) {
 
-			PrintAttribute(*it);
+			PrintAttribute(stream, *it);
 			std::string comma = std::next(it, 1) != attribute_table.end() ? ", " : "";
-			std::cout << comma;
+			stream << comma;
 
 		}
 
-		std::cout << " }";
+		stream << " }";
 
 	}
 
 	// =========================================================================
 	// Prints a CandidateKeyList.
 	//
+	// "stream":
+	//		Stream to print to.
+	//
 	// "ck_list":
 	//		List of candidate keys to print.
 	// =========================================================================
-	void Database::PrintCandidateKeyList(const CandidateKeyList & ck_list) {
+	void Database::PrintCandidateKeyList(std::ostream & stream, 
+		const CandidateKeyList & ck_list) {
 
 		for (CandidateKeyList::const_iterator it = ck_list.begin();
 			it != ck_list.end(); it++) {
 
-			PrintAttrSet(*it);
-			std::cout << "\n";
+			PrintAttrSet(stream, *it);
+			stream << "\n";
 
 		}
 
@@ -654,31 +1941,37 @@ namespace DbNormalizerCpp {
 	// =========================================================================
 	// Prints a FuncDep.
 	//
+	// "stream":
+	//		Stream to print to.
+	//
 	// "func_dep":
 	//		The functional dependency to print.
 	// =========================================================================
-	void Database::PrintFuncDep(const FuncDep & func_dep) {
+	void Database::PrintFuncDep(std::ostream & stream, const FuncDep & func_dep) {
 
-		PrintAttrSet(func_dep.first);
-		std::cout << " -> ";
-		PrintAttrSet(func_dep.second);
+		PrintAttrSet(stream, func_dep.first);
+		stream << " -> ";
+		PrintAttrSet(stream, func_dep.second);
 
 	}
 
 	// =========================================================================
 	// Prints a FuncDepSetClosure.
 	// 
+	// "stream":
+	//		Stream to print to.
+	//
 	// "func_dep_set_closure":
 	//		Closure of set of functional dependencies to print.
 	// =========================================================================
-	void Database::PrintFuncDepSetClosure(const FuncDepSetClosure &
-		func_dep_set_closure) {
+	void Database::PrintFuncDepSetClosure(std::ostream & stream, 
+		const FuncDepSetClosure & func_dep_set_closure) {
 
 		for (FuncDepSetClosure::const_iterator it = func_dep_set_closure.begin();
 			it != func_dep_set_closure.end(); it++) {
 
-			PrintAttributeSetClosure(*it);
-			std::cout << "\n";
+			PrintAttributeSetClosure(stream, *it);
+			stream << "\n";
 
 		}
 
@@ -687,24 +1980,67 @@ namespace DbNormalizerCpp {
 	// =========================================================================
 	// Prints this database's functional dependency table.
 	// =========================================================================
-	void Database::PrintFuncDepTable() {
+	void Database::PrintFuncDepTable(std::ostream & stream) {
 
 		for (FuncDepTable::const_iterator it = func_dep_table.begin();
 			it != func_dep_table.end(); it++) {
 
-			PrintFuncDep(*it);
+			PrintFuncDep(stream, *it);
+			stream << "\n";
+
+		}
+
+	}
+
+	// =========================================================================
+	// Prints the functional dependencies that are not preserved by the
+	// decomposition in relation_table.
+	//
+	// "max_threads":
+	//		Maximum number of threads to spawn to check functional 
+	//		dependencies.
+	// =========================================================================
+	void Database::PrintLostFuncDeps(unsigned int max_threads) {
+
+		FuncDepTblIndexList lost_func_deps = FindLostFuncDeps(max_threads);
+
+		std::cout << "Lost Functional Dependencies:\n";
+
+		if (lost_func_deps.empty())
+			std::cout << "None. The decomposition is dependency-preserving.\n";
+
+		for (FuncDepTblIndex index : lost_func_deps) {
+
+			PrintFuncDep(std::cout, func_dep_table[index]);
 			std::cout << "\n";
 
 		}
 
 	}
 
+	// =========================================================================
+	// Prints this database's multivalued dependency table.
+	// =========================================================================
+	void Database::PrintMultiValuedDepTable(std::ostream & stream) {
+
+		for (MultiValuedDepTable::const_iterator it = mvd_table.begin();
+			it != mvd_table.end(); it++) {
+
+			PrintAttrSet(stream, it->first);
+			stream << " ->> ";
+			PrintAttrSet(stream, it->second);
+			stream << "\n";
+
+		}
+
+	}
+
 	// =========================================================================
 	// Prints this database's name.
 	// =========================================================================
-	void Database::PrintName() {
+	void Database::PrintName(std::ostream & stream) {
 
-		std::cout << name;
+		stream << name;
 
 	}
 
@@ -714,34 +2050,35 @@ namespace DbNormalizerCpp {
 	//	"relation":
 	//		The relation to print.
 	// =========================================================================
-	void Database::PrintRelation(const Relation & relation) {
+	void Database::PrintRelation(std::ostream & stream, 
+		const Relation & relation) {
 
-		std::cout
+		stream
 			<< "========================================\n"
 			<< relation.name << "\n"
 			<< "========================================\n";
 
-		std::cout << "\nAttributes:\n";
-		PrintAttrSet(relation.attributes);
-		std::cout << "\n\nPrimary Key:\n";
-		PrintAttrSet(relation.primary_key);
-		std::cout << "\n\nCandidate Keys:\n";
-		PrintCandidateKeyList(relation.candidate_keys);
-		std::cout << "\nClosure:\n";
-		PrintFuncDepSetClosure(relation.closure);
+		stream << "\nAttributes:\n";
+		PrintAttrSet(stream, relation.attributes);
+		stream << "\n\nPrimary Key:\n";
+		PrintAttrSet(stream, relation.primary_key);
+		stream << "\n\nCandidate Keys:\n";
+		PrintCandidateKeyList(stream, relation.candidate_keys);
+		stream << "\nClosure:\n";
+		PrintFuncDepSetClosure(stream, relation.closure);
 
 	}
 
 	// =========================================================================
 	// Prints this database's relation table.
 	// =========================================================================
-	void Database::PrintRelationTable() {
+	void Database::PrintRelationTable(std::ostream & stream) {
 
 		for (RelationTable::const_iterator it = relation_table.begin();
 			it != relation_table.end(); it++) {
 
-			PrintRelation(*it);
-			std::cout << "\n";
+			PrintRelation(stream, *it);
+			stream << "\n";
 
 		}
 
@@ -770,6 +2107,54 @@ namespace DbNormalizerCpp {
 
 	}
 
+	// =========================================================================
+	// Updates the progress of a normalization run after one relation is
+	// normalized and reports it.
+	//
+	// "run":
+	//		Run to update.
+	//
+	// "decomposed_relations":
+	//		Relations returned for the normalized relation. A single
+	//		relation is final; more are queued.
+	// =========================================================================
+	void Database::RecordNormalizedRelation(NormalizationRun & run,
+		const RelationTable & decomposed_relations) {
+
+		run.progress.relations_done++;
+
+		if (decomposed_relations.size() == 1)
+			run.progress.keys_found += decomposed_relations.front().candidate_keys.size();
+		else
+			run.progress.relations_queued += decomposed_relations.size();
+
+		ReportProgress(run);
+
+	}
+
+	// =========================================================================
+	// Releases the packed functional dependencies, which are only needed
+	// while normalizing. They are packed again by the next
+	// GetPackedFuncDepTable().
+	// =========================================================================
+	void Database::ReleasePackedFuncDepTable() {
+
+		packed_func_dep_table = PackedFuncDepTable();
+		packed_func_dep_table_stale = true;
+
+	}
+
+	// =========================================================================
+	// Calls the progress callback of a run's budget, if any, with the
+	// progress so far.
+	// =========================================================================
+	void Database::ReportProgress(const NormalizationRun & run) {
+
+		if (run.budget.on_progress)
+			run.budget.on_progress(run.progress);
+
+	}
+
 	// =========================================================================
 	// Helper function called by SingleThreaded2nf() and MultiThreaded2nf()
 	// to normalize a specific relation to 2NF.
@@ -779,7 +2164,10 @@ namespace DbNormalizerCpp {
 	// =========================================================================
 	RelationTable Database::RelationTo2nf(Relation & relation) {
 
-		RelationTable decomposed_relations;
+		TraceScope trace(tracer, "RelationTo2nf", "relation", "attributes", 
+			relation.attributes.size());
+		std::pmr::memory_resource * resource = CurrentNormalizationResource();
+		RelationTable decomposed_relations(resource);
 
 		decomposed_relations.push_back(relation);
 
@@ -797,7 +2185,7 @@ namespace DbNormalizerCpp {
 				// The lhs of the current closure is a partial
 				// primary key.
 
-				Relation decomposed_relation;
+				Relation decomposed_relation(resource);
 				bool decomposed = false;
 
 				// Iterate over the rhs of the closure.
@@ -811,7 +2199,10 @@ namespace DbNormalizerCpp {
 					bool is_in_lhs = func_dep_lhs.find(*closure_rhs_it)
 						!= func_dep_lhs.end();
 
-					if (!is_in_lhs && !attribute_table[*closure_rhs_it].prime) {
+					bool is_remaining = decomposed_relations.front().attributes.find(*closure_rhs_it)
+						!= decomposed_relations.front().attributes.end();
+
+					if (!is_in_lhs && is_remaining && !attribute_table[*closure_rhs_it].prime) {
 
 						// The rhs of the closure includes a
 						// non-prime attribute, which is a violation
@@ -821,16 +2212,11 @@ namespace DbNormalizerCpp {
 
 							// Initialize decomposed relation.
 
-							decomposed_relation.name = "r" + relation_num;
-							relation_num++;
-
 							// New relation's PK is the lhs of the closure.
-							decomposed_relation.candidate_keys.push_back(
-								CandidateKey(
-									func_dep_table[relation_closure_it->first].first.begin(),
-									func_dep_table[relation_closure_it->first].first.end()
-								)
-							);
+							decomposed_relation.candidate_keys.emplace_back();
+							decomposed_relation.candidate_keys.back().insert(
+								func_dep_table[relation_closure_it->first].first.begin(),
+								func_dep_table[relation_closure_it->first].first.end());
 
 							AssignPrimaryKey(decomposed_relation);
 
@@ -844,7 +2230,7 @@ namespace DbNormalizerCpp {
 						}
 
 						decomposed_relation.attributes.insert(*closure_rhs_it);
-						decomposed_relations.front().attributes.erase(*closure_rhs_it); // [todo]
+						decomposed_relations.front().attributes.erase(*closure_rhs_it);
 
 					}
 
@@ -857,6 +2243,28 @@ namespace DbNormalizerCpp {
 
 		} // ... Iterate over relation's closures.
 
+		if (decomposed_relations.size() > 1) {
+
+			// Keep only the candidate keys that survived in the remaining
+			// relation.
+			Relation & remaining = decomposed_relations.front();
+			CandidateKeyList candidate_keys(resource);
+
+			for (CandidateKey & candidate_key : remaining.candidate_keys) {
+
+				if (IsSubsetOf(candidate_key, remaining.attributes))
+					candidate_keys.push_back(candidate_key);
+
+			}
+
+			remaining.candidate_keys = candidate_keys;
+
+			// Project closures onto the attributes that each relation kept.
+			for (Relation & decomposed_relation : decomposed_relations)
+				ComputeFuncDepSetClosure(decomposed_relation);
+
+		}
+
 		return decomposed_relations;
 
 	}
@@ -879,6 +2287,151 @@ namespace DbNormalizerCpp {
 	
 	}
 
+	// =========================================================================
+	// Helper function called by SingleThreaded4nf() and MultiThreaded4nf()
+	// to normalize a specific relation to 4NF.
+	//
+	// "relation":
+	//		Relation to normalize to 4NF.
+	//
+	// Returns a RelationTable, i.e., a collection of decomposed relations 
+	// as part of 4NF normalization. Returns only "relation" if it is in 4NF.
+	// Otherwise, returns the two relations X u Y and R \ Y for the first
+	// violating X ->> Y found. If the lhs of a dependency determines more
+	// of "relation" than itself without being a superkey, X is a minimal
+	// subset of it that determines as much and Y is the rest of what it
+	// determines. Otherwise, X is the lhs and Y a block of its dependency
+	// basis.
+	// =========================================================================
+	RelationTable Database::RelationTo4nf(Relation & relation) {
+
+		TraceScope trace(tracer, "RelationTo4nf", "relation", "attributes", 
+			relation.attributes.size());
+		std::pmr::memory_resource * resource = CurrentNormalizationResource();
+		RelationTable decomposed_relations(resource);
+
+		// Lhs of every dependency that lies within relation.
+		std::pmr::vector<const Lhs *> lhs_list(resource);
+
+		for (const FuncDep & func_dep : func_dep_table) {
+
+			if (IsSubsetOf(func_dep.first, relation.attributes))
+				lhs_list.push_back(&func_dep.first);
+
+		}
+
+		for (const MultiValuedDep & mvd : mvd_table) {
+
+			if (IsSubsetOf(mvd.first, relation.attributes))
+				lhs_list.push_back(&mvd.first);
+
+		}
+
+		for (const Lhs * lhs : lhs_list) {
+
+			AttributeSet closure = ComputeClosureOf(*lhs);
+
+			if (IsSubsetOf(relation.attributes, closure))
+				continue; // Lhs is a superkey of relation.
+
+			// X -> X+ \ X, so X ->> (X+ n R) \ X. The attributes X determines
+			// are split off as one block; the dependency basis has a block
+			// per attribute of X+, and splitting on each of them would break
+			// up relations that are already in 4NF. X is first shrunk to a
+			// minimal subset that determines as much of relation, so that
+			// the attributes of X that the rest of X determines leave with
+			// the block instead of staying behind in R \ Y. Only if X
+			// determines nothing else in relation are the blocks of its
+			// dependency basis, i.e., multivalued dependencies, tried.
+			std::pmr::vector<AttributeSet> blocks(resource);
+			AttributeSet x(lhs->begin(), lhs->end(), resource);
+			AttributeSet determined(resource);
+
+			for (AttributeTblIndex attr : relation.attributes) {
+
+				if (closure.find(attr) != closure.end())
+					determined.insert(attr);
+
+			}
+
+			if (determined.size() > lhs->size()) {
+
+				for (AttributeTblIndex attr : *lhs) {
+
+					x.erase(attr);
+
+					if (!IsSubsetOf(determined, ComputeClosureOf(x)))
+						x.insert(attr);
+
+				}
+
+				for (AttributeTblIndex attr : x)
+					determined.erase(attr);
+
+				blocks.push_back(determined);
+
+			}
+			else {
+
+				for (const AttributeSet & block : ComputeDependencyBasis(*lhs))
+					blocks.push_back(block);
+
+			}
+
+			for (const AttributeSet & block : blocks) {
+
+				// X ->> Y n R holds in relation. It is trivial iff Y n R is
+				// empty or X u (Y n R) is all of relation.
+				AttributeSet y(resource);
+
+				for (AttributeTblIndex attr : block) {
+
+					if (relation.attributes.find(attr) != relation.attributes.end())
+						y.insert(attr);
+
+				}
+
+				bool trivial = y.empty() || relation.attributes.size() == x.size() + y.size();
+
+				if (trivial)
+					continue;
+
+				Relation remaining(resource);
+				Relation decomposed_relation(resource);
+
+				remaining.name = relation.name;
+
+				for (AttributeTblIndex attr : relation.attributes) {
+
+					if (y.find(attr) == y.end())
+						remaining.attributes.insert(attr);
+
+				}
+
+				decomposed_relation.attributes.insert(x.begin(), x.end());
+				decomposed_relation.attributes.UnionWith(y);
+
+				decomposed_relations.push_back(remaining);
+				decomposed_relations.push_back(decomposed_relation);
+
+				for (Relation & decomposed : decomposed_relations) {
+					ComputeFuncDepSetClosure(decomposed);
+					ComputeCandidateKey(decomposed);
+					AssignPrimaryKey(decomposed);
+				}
+
+				return decomposed_relations;
+
+			}
+
+		}
+
+		decomposed_relations.push_back(relation);
+
+		return decomposed_relations;
+
+	}
+
 	// =========================================================================
 	// Sets name of database.
 	//
@@ -892,45 +2445,105 @@ namespace DbNormalizerCpp {
 		name = _name;
 	}
 
+	// =========================================================================
+	// Sets the tracer that records normalization events.
+	//
+	// "_tracer":
+	//		Tracer to record to, or null to disable tracing.
+	// =========================================================================
+	void Database::SetTracer(Tracer * _tracer) {
+		tracer = _tracer;
+	}
+
 	// =========================================================================
 	// Single-threaded 2NF.
 	// =========================================================================
 	void Database::SingleThreaded2nf(NormalizationQueue & 
+		normalization_queue, NormalizationRun & run) {
+
+		SingleThreadedNormalize(normalization_queue, &Database::RelationTo2nf, run);
+
+	}
+
+	// =========================================================================
+	// Single-threaded 3NF.
+	// =========================================================================
+	RelationTable Database::SingleThreaded3nf(NormalizationQueue &
 		normalization_queue) {
 
+		return RelationTable();
+
+	}
+
+	// =========================================================================
+	// Single-threaded 4NF.
+	// =========================================================================
+	void Database::SingleThreaded4nf(NormalizationQueue &
+		normalization_queue, NormalizationRun & run) {
+
+		SingleThreadedNormalize(normalization_queue, &Database::RelationTo4nf, run);
+
+	}
+
+	// =========================================================================
+	// Normalizes every relation in a normalization queue using this existing
+	// thread. A relation for which "relation_step" returns only 1 relation 
+	// is final and is added to relation_table. Otherwise, the returned 
+	// relations are queued. The budget is checked before every relation; 
+	// once it is exhausted, relations still queued are kept as they are.
+	//
+	// "normalization_queue":
+	//		Queue of relations to normalize.
+	//
+	// "relation_step":
+	//		Member function that normalizes one relation, e.g., 
+	//		RelationTo2nf().
+	//
+	// "run":
+	//		Budget, progress, and status of the run.
+	// =========================================================================
+	void Database::SingleThreadedNormalize(NormalizationQueue &
+		normalization_queue, RelationStep relation_step, NormalizationRun & run) {
+
+		run.progress.relations_queued += normalization_queue.size();
+
 		while (!normalization_queue.empty())
 		{
-			Relation &next = normalization_queue.front();
+			run.status = CheckBudget(run);
+
+			if (run.status != Complete)
+				break;
+
+			Relation next = std::move(normalization_queue.front());
 			normalization_queue.pop();
-			RelationTable decomposed_relations = RelationTo2nf(next);
+
+			if (tracer)
+				tracer->Instant("pop", "queue", "size", normalization_queue.size());
+
+			RelationTable decomposed_relations = (this->*relation_step)(next);
 
 			if (decomposed_relations.size() < 1) {
-				throw std::runtime_error("Internal error. 2NF should never return 0 decomposed relations.");
+				throw std::runtime_error("Internal error. Normalization should never return 0 decomposed relations.");
 			}
 			else if (decomposed_relations.size() == 1) {
+				NameRelation(decomposed_relations.front());
 				relation_table.push_back(decomposed_relations.front());
 			}
 			else {
 
-				for (RelationTable::iterator it = decomposed_relations.begin();
-					it != decomposed_relations.end(); it = decomposed_relations.erase(it)) {
+				for (Relation & decomposed_relation : decomposed_relations)
+					normalization_queue.push(std::move(decomposed_relation));
 
-					normalization_queue.push(*it);
+				if (tracer)
+					tracer->Instant("push", "queue", "size", normalization_queue.size());
 
-				}
 			}
 
-		}
-
-	}
+			RecordNormalizedRelation(run, decomposed_relations);
 
-	// =========================================================================
-	// Single-threaded 3NF.
-	// =========================================================================
-	RelationTable Database::SingleThreaded3nf(NormalizationQueue &
-		normalization_queue) {
+		}
 
-		return RelationTable();
+		KeepQueuedRelations(normalization_queue);
 
 	}
 
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <cctype>
+
+#include "ddlemitter.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a DdlEmitter and derives the foreign keys and indexes.
+	// =========================================================================
+	DdlEmitter::DdlEmitter(const Database & _db) : db(_db) {
+
+		DeriveAccessPaths();
+
+	}
+
+	// =========================================================================
+	// Returns a comma-separated list of column names.
+	//
+	// "columns":
+	//		Attributes of the columns.
+	// =========================================================================
+	std::string DdlEmitter::ColumnList(const SortedAttributeList & columns) {
+
+		std::string list;
+
+		for (std::size_t i = 0; i < columns.size(); i++) {
+
+			list += i == 0 ? "" : ", ";
+			list += Identifier(db.GetAttributeTable()[columns[i]].name);
+
+		}
+
+		return list;
+
+	}
+
+	// =========================================================================
+	// Derives the foreign keys and secondary indexes from the attributes
+	// every pair of relations shares.
+	// =========================================================================
+	void DdlEmitter::DeriveAccessPaths() {
+
+		const RelationTable & relation_table = db.GetRelationTable();
+
+		for (RelationTblIndex r = 0; r < relation_table.size(); r++) {
+
+			const Relation & relation = relation_table[r];
+			std::vector<SortedAttributeList> index_columns;
+
+			for (RelationTblIndex s = 0; s < relation_table.size(); s++) {
+
+				if (s == r)
+					continue;
+
+				const Relation & other = relation_table[s];
+				SortedAttributeList shared;
+
+				for (AttributeTblIndex attr : relation.attributes) {
+
+					if (other.attributes.count(attr) != 0)
+						shared.push_back(attr);
+
+				}
+
+				if (shared.empty())
+					continue;
+
+				bool references = !other.primary_key.empty()
+					&& !(other.primary_key == relation.primary_key)
+					&& std::all_of(other.primary_key.begin(), other.primary_key.end(),
+						[&](AttributeTblIndex attr) { return relation.attributes.count(attr) != 0; });
+
+				if (references) {
+
+					DdlForeignKey foreign_key;
+					foreign_key.relation = r;
+					foreign_key.referenced = s;
+					foreign_key.columns.assign(other.primary_key.begin(), other.primary_key.end());
+					foreign_keys.push_back(foreign_key);
+
+				}
+
+				if (!HasKeyPrefix(r, shared))
+					index_columns.push_back(shared);
+
+			}
+
+			std::sort(index_columns.begin(), index_columns.end());
+			index_columns.erase(std::unique(index_columns.begin(), index_columns.end()),
+				index_columns.end());
+
+			for (const SortedAttributeList & columns : index_columns) {
+
+				DdlIndex index;
+				index.relation = r;
+				index.columns = columns;
+				indexes.push_back(index);
+
+			}
+
+		}
+
+	}
+
+	// =========================================================================
+	// Writes the DDL script.
+	// =========================================================================
+	void DdlEmitter::Emit(std::ostream & stream) {
+
+		const RelationTable & relation_table = db.GetRelationTable();
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+
+		if (!db.GetName().empty())
+			stream << "-- " << db.GetName() << "\n\n";
+
+		for (RelationTblIndex r = 0; r < relation_table.size(); r++)
+			EmitCreateTable(stream, r);
+
+		for (const DdlForeignKey & foreign_key : foreign_keys) {
+
+			const Relation & relation = relation_table[foreign_key.relation];
+			const Relation & referenced = relation_table[foreign_key.referenced];
+
+			stream << "ALTER TABLE " << Identifier(relation.name)
+				<< " ADD CONSTRAINT " << Identifier("fk_" + relation.name + "_" + referenced.name)
+				<< "\n\tFOREIGN KEY (" << ColumnList(foreign_key.columns)
+				<< ") REFERENCES " << Identifier(referenced.name)
+				<< " (" << ColumnList(foreign_key.columns) << ");\n";
+
+		}
+
+		if (!foreign_keys.empty())
+			stream << "\n";
+
+		for (const DdlIndex & index : indexes) {
+
+			std::string index_name = "idx_" + relation_table[index.relation].name;
+
+			for (AttributeTblIndex attr : index.columns)
+				index_name += "_" + attribute_table[attr].name;
+
+			stream << "CREATE INDEX " << Identifier(index_name) << " ON "
+				<< Identifier(relation_table[index.relation].name)
+				<< " (" << ColumnList(index.columns) << ");\n";
+
+		}
+
+		if (!indexes.empty())
+			stream << "\n";
+
+	}
+
+	// =========================================================================
+	// Writes the CREATE TABLE statement of a relation. Primary key columns
+	// are NOT NULL, and candidate keys other than the primary key become
+	// UNIQUE constraints.
+	//
+	// "stream":
+	//		Stream to write to.
+	//
+	// "relation":
+	//		Index of the relation in the relation table.
+	// =========================================================================
+	void DdlEmitter::EmitCreateTable(std::ostream & stream, RelationTblIndex relation) {
+
+		const Relation & rel = db.GetRelationTable()[relation];
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+		std::vector<std::string> lines;
+
+		for (AttributeTblIndex attr : rel.attributes) {
+
+			lines.push_back(Identifier(attribute_table[attr].name) + " "
+				+ TypeName(attribute_table[attr].type)
+				+ (rel.primary_key.count(attr) != 0 ? " NOT NULL" : ""));
+
+		}
+
+		if (!rel.primary_key.empty()) {
+
+			SortedAttributeList key(rel.primary_key.begin(), rel.primary_key.end());
+			lines.push_back("PRIMARY KEY (" + ColumnList(key) + ")");
+
+		}
+
+		for (const CandidateKey & candidate_key : rel.candidate_keys) {
+
+			if (candidate_key.empty() || candidate_key == rel.primary_key)
+				continue;
+
+			SortedAttributeList key(candidate_key.begin(), candidate_key.end());
+			lines.push_back("UNIQUE (" + ColumnList(key) + ")");
+
+		}
+
+		stream << "CREATE TABLE " << Identifier(rel.name) << " (\n";
+
+		for (std::size_t i = 0; i < lines.size(); i++)
+			stream << "\t" << lines[i] << (i + 1 < lines.size() ? ",\n" : "\n");
+
+		stream << ");\n\n";
+
+	}
+
+	// =========================================================================
+	// Returns true if the primary key or a UNIQUE constraint of a relation
+	// has a set of columns as its leading columns, so that its index
+	// already serves lookups on them.
+	//
+	// "relation":
+	//		Index of the relation in the relation table.
+	//
+	// "columns":
+	//		Columns to look up.
+	// =========================================================================
+	bool DdlEmitter::HasKeyPrefix(RelationTblIndex relation,
+		const SortedAttributeList & columns) {
+
+		const Relation & rel = db.GetRelationTable()[relation];
+
+		auto has_prefix = [&](const AttributeSet & key) {
+
+			// Key columns are emitted in ascending order.
+			SortedAttributeList key_columns(key.begin(), key.end());
+
+			return key_columns.size() >= columns.size()
+				&& std::equal(columns.begin(), columns.end(), key_columns.begin());
+
+		};
+
+		if (has_prefix(rel.primary_key))
+			return true;
+
+		return std::any_of(rel.candidate_keys.begin(), rel.candidate_keys.end(), has_prefix);
+
+	}
+
+	// =========================================================================
+	// Returns a name as an SQL identifier. Names that are not plain SQL
+	// names are double-quoted.
+	//
+	// "name":
+	//		Name of a table, column, constraint, or index.
+	// =========================================================================
+	std::string DdlEmitter::Identifier(const std::string & name) {
+
+		bool plain = !name.empty()
+			&& (std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_')
+			&& std::all_of(name.begin(), name.end(), [](char c) {
+				return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+			});
+
+		if (plain)
+			return name;
+
+		std::string quoted = "\"";
+
+		for (char c : name) {
+
+			// A double quote is escaped by doubling it.
+			if (c == '"')
+				quoted += '"';
+
+			quoted += c;
+
+		}
+
+		return quoted + "\"";
+
+	}
+
+	// =========================================================================
+	// Returns the SQL type of an attribute type.
+	//
+	// "type":
+	//		Type of an attribute.
+	// =========================================================================
+	std::string DdlEmitter::TypeName(AttributeType type) {
+
+		switch (type) {
+		case Int:
+			return "INTEGER";
+		case Float:
+			return "DOUBLE PRECISION";
+		default:
+			return "VARCHAR(255)";
+		}
+
+	}
+
+}
@@ -0,0 +1,463 @@
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+#include "attribute.h"
+#include "fdcomparer.h"
+
+namespace DbNormalizerCpp {
+
+	namespace {
+
+		// =====================================================================
+		// Functional dependencies indexed for linear-time closures. Every
+		// list is stored back to back in one array, and "uses" lists, for
+		// every attribute, the dependencies whose lhs holds it. Dependencies
+		// with an empty lhs fire unconditionally. Disabled dependencies
+		// never fire. Build() must be called after the last Insert().
+		// =====================================================================
+		struct FuncDepIndex {
+
+			std::size_t num_attributes;
+			std::vector<std::uint32_t> lhs_begin{ 0 };
+			std::vector<AttributeTblIndex> lhs_attrs;
+			std::vector<std::uint32_t> rhs_begin{ 0 };
+			std::vector<AttributeTblIndex> rhs_attrs;
+			std::vector<char> enabled;
+			std::vector<std::uint32_t> uses_begin;
+			std::vector<std::uint32_t> uses;
+			std::vector<std::uint32_t> unconditional;
+
+			explicit FuncDepIndex(std::size_t _num_attributes)
+				: num_attributes(_num_attributes) {}
+
+			std::size_t Size() const { return enabled.size(); }
+
+			std::uint32_t LhsSize(std::size_t f) const {
+				return lhs_begin[f + 1] - lhs_begin[f];
+			}
+
+			void Insert(const std::vector<AttributeTblIndex> & lhs,
+				const std::vector<AttributeTblIndex> & rhs) {
+
+				if (lhs.empty())
+					unconditional.push_back(static_cast<std::uint32_t>(Size()));
+
+				lhs_attrs.insert(lhs_attrs.end(), lhs.begin(), lhs.end());
+				rhs_attrs.insert(rhs_attrs.end(), rhs.begin(), rhs.end());
+				lhs_begin.push_back(static_cast<std::uint32_t>(lhs_attrs.size()));
+				rhs_begin.push_back(static_cast<std::uint32_t>(rhs_attrs.size()));
+				enabled.push_back(1);
+
+			}
+
+			void Build() {
+
+				uses_begin.assign(num_attributes + 1, 0);
+
+				for (AttributeTblIndex attr : lhs_attrs)
+					uses_begin[attr + 1]++;
+
+				for (std::size_t attr = 0; attr < num_attributes; attr++)
+					uses_begin[attr + 1] += uses_begin[attr];
+
+				std::vector<std::uint32_t> next(uses_begin.begin(), uses_begin.end() - 1);
+				uses.resize(lhs_attrs.size());
+
+				for (std::size_t f = 0; f < Size(); f++) {
+
+					for (std::uint32_t i = lhs_begin[f]; i < lhs_begin[f + 1]; i++)
+						uses[next[lhs_attrs[i]]++] = static_cast<std::uint32_t>(f);
+
+				}
+
+			}
+
+		};
+
+		// =====================================================================
+		// Per-thread buffers of a closure. Only the entries a closure
+		// touched are reset by the next one.
+		// =====================================================================
+		struct ClosureScratch {
+
+			std::vector<char> in_closure;			// By attribute.
+			std::vector<char> is_target;			// By attribute.
+			std::vector<AttributeTblIndex> members;	// Attributes in closure.
+			std::vector<std::uint32_t> missing;		// Lhs attributes not in
+													// closure, by dependency.
+			std::vector<std::uint32_t> touched;		// Dependencies counted.
+
+			explicit ClosureScratch(const FuncDepIndex & index)
+				: in_closure(index.num_attributes, 0),
+				is_target(index.num_attributes, 0), missing(index.Size()) {
+
+				for (std::size_t f = 0; f < index.Size(); f++)
+					missing[f] = index.LhsSize(f);
+
+			}
+
+		};
+
+		// =====================================================================
+		// Computes the closure of "attributes" into "scratch.in_closure",
+		// stopping as soon as it holds every attribute of "targets".
+		//
+		// Returns true if the closure holds every attribute of "targets".
+		// =====================================================================
+		bool ComputeClosure(const FuncDepIndex & index,
+			const std::vector<AttributeTblIndex> & attributes,
+			const std::vector<AttributeTblIndex> & targets, ClosureScratch & scratch) {
+
+			for (AttributeTblIndex attr : scratch.members)
+				scratch.in_closure[attr] = 0;
+
+			for (std::uint32_t f : scratch.touched)
+				scratch.missing[f] = index.LhsSize(f);
+
+			scratch.members.clear();
+			scratch.touched.clear();
+
+			std::size_t targets_left = 0;
+
+			for (AttributeTblIndex attr : targets) {
+
+				if (!scratch.is_target[attr]) {
+					scratch.is_target[attr] = 1;
+					targets_left++;
+				}
+
+			}
+
+			auto add = [&](AttributeTblIndex attr) {
+
+				if (!scratch.in_closure[attr]) {
+
+					scratch.in_closure[attr] = 1;
+					scratch.members.push_back(attr);
+
+					if (scratch.is_target[attr])
+						targets_left--;
+
+				}
+
+			};
+
+			for (AttributeTblIndex attr : attributes)
+				add(attr);
+
+			auto fire = [&](std::uint32_t f) {
+
+				for (std::uint32_t i = index.rhs_begin[f]; i < index.rhs_begin[f + 1]; i++)
+					add(index.rhs_attrs[i]);
+
+			};
+
+			for (std::uint32_t f : index.unconditional) {
+
+				if (index.enabled[f])
+					fire(f);
+
+			}
+
+			// "members" doubles as the work list.
+			for (std::size_t next = 0; next < scratch.members.size() && targets_left != 0; next++) {
+
+				AttributeTblIndex attr = scratch.members[next];
+
+				for (std::uint32_t i = index.uses_begin[attr]; i < index.uses_begin[attr + 1]; i++) {
+
+					std::uint32_t f = index.uses[i];
+
+					if (scratch.missing[f] == index.LhsSize(f))
+						scratch.touched.push_back(f);
+
+					if (--scratch.missing[f] == 0 && index.enabled[f])
+						fire(f);
+
+				}
+
+			}
+
+			for (AttributeTblIndex attr : targets)
+				scratch.is_target[attr] = 0;
+
+			return targets_left == 0;
+
+		}
+
+	}
+
+	// =========================================================================
+	// Constructs a FuncDepComparer by matching the attributes of both
+	// databases by name.
+	// =========================================================================
+	FuncDepComparer::FuncDepComparer(const Database & _a, const Database & _b,
+		unsigned int _max_threads)
+		: a(_a), b(_b), max_threads(_max_threads) {
+
+		for (const Database * db : { &a, &b }) {
+
+			for (const Attribute & attr : db->GetAttributeTable()) {
+
+				if (name_index.insert(std::make_pair(attr.name,
+					static_cast<AttributeTblIndex>(names.size()))).second)
+					names.push_back(attr.name);
+
+			}
+
+		}
+
+	}
+
+	// =========================================================================
+	// Compares the functional dependencies in both directions.
+	// =========================================================================
+	FuncDepComparison FuncDepComparer::Compare() {
+
+		FuncDepComparison comparison;
+		std::vector<char> in_a(names.size(), 0);
+		std::vector<char> in_b(names.size(), 0);
+
+		for (const Attribute & attr : a.GetAttributeTable())
+			in_a[name_index[attr.name]] = 1;
+
+		for (const Attribute & attr : b.GetAttributeTable())
+			in_b[name_index[attr.name]] = 1;
+
+		for (AttributeTblIndex attr = 0; attr < names.size(); attr++) {
+
+			if (!in_b[attr])
+				comparison.only_in_a.push_back(names[attr]);
+			else if (!in_a[attr])
+				comparison.only_in_b.push_back(names[attr]);
+
+		}
+
+		comparison.not_implied_by_b = FindNotImplied(a, b, comparison.closures_computed);
+		comparison.not_implied_by_a = FindNotImplied(b, a, comparison.closures_computed);
+
+		return comparison;
+
+	}
+
+	// =========================================================================
+	// Finds a nonredundant set of functional dependencies of one database
+	// that, added to another database, makes it imply all of the first.
+	//
+	// "from":
+	//		Database whose functional dependencies are checked.
+	//
+	// "to":
+	//		Database whose functional dependencies must imply them.
+	//
+	// "closures_computed":
+	//		Incremented by the number of closures computed.
+	//
+	// Returns the functional dependencies of "from", with the rhs
+	// attributes that "to" does not imply, that are not implied by the
+	// others, in functional dependency table order.
+	// =========================================================================
+	std::vector<SimpleFuncDep> FuncDepComparer::FindNotImplied(const Database &
+		from, const Database & to, std::size_t & closures_computed) {
+
+		const FuncDepTable & from_table = from.GetFuncDepTable();
+		FuncDepIndex index(names.size());
+
+		for (const FuncDep & func_dep : to.GetFuncDepTable())
+			index.Insert(Translate(to, func_dep.first), Translate(to, func_dep.second));
+
+		index.Build();
+
+		// Batch: the closure of every lhs of "from" under "to". Each thread
+		// checks an interleaved slice and only writes to its own slots.
+		std::vector<std::vector<AttributeTblIndex>> missing(from_table.size());
+		unsigned int num_threads = max_threads;
+
+		if (num_threads > from_table.size())
+			num_threads = static_cast<unsigned int>(from_table.size());
+
+		if (num_threads < 1)
+			num_threads = 1;
+
+		auto check = [&](unsigned int first) {
+
+			ClosureScratch scratch(index);
+
+			for (std::size_t i = first; i < from_table.size(); i += num_threads) {
+
+				std::vector<AttributeTblIndex> rhs = Translate(from, from_table[i].second);
+
+				if (ComputeClosure(index, Translate(from, from_table[i].first), rhs, scratch))
+					continue;
+
+				for (AttributeTblIndex attr : rhs) {
+
+					if (!scratch.in_closure[attr])
+						missing[i].push_back(attr);
+
+				}
+
+			}
+
+		};
+
+		if (num_threads == 1)
+			check(0);
+		else {
+
+			std::vector<std::thread> threads;
+
+			for (unsigned int t = 0; t < num_threads; t++)
+				threads.push_back(std::thread(check, t));
+
+			for (std::thread & thread : threads)
+				thread.join();
+
+		}
+
+		closures_computed += from_table.size();
+
+		// Every missing attribute becomes a dependency of its own, and all
+		// of them are added to "to". Then, in order, a dependency is
+		// disabled for good if the enabled ones imply it.
+		std::vector<std::vector<AttributeTblIndex>> candidate_lhs;
+		std::vector<AttributeTblIndex> candidate_attr;
+		std::vector<std::size_t> candidate_of;
+		std::size_t first_candidate = index.Size();
+
+		for (std::size_t i = 0; i < from_table.size(); i++) {
+
+			if (missing[i].empty())
+				continue;
+
+			std::vector<AttributeTblIndex> lhs = Translate(from, from_table[i].first);
+
+			for (AttributeTblIndex attr : missing[i]) {
+				index.Insert(lhs, { attr });
+				candidate_lhs.push_back(lhs);
+				candidate_attr.push_back(attr);
+				candidate_of.push_back(i);
+			}
+
+		}
+
+		std::vector<SimpleFuncDep> not_implied;
+
+		if (candidate_attr.empty())
+			return not_implied;
+
+		index.Build();
+
+		ClosureScratch scratch(index);
+
+		for (std::size_t c = 0; c < candidate_attr.size(); c++) {
+
+			index.enabled[first_candidate + c] = 0;
+			closures_computed++;
+
+			if (!ComputeClosure(index, candidate_lhs[c], { candidate_attr[c] }, scratch))
+				index.enabled[first_candidate + c] = 1;
+
+		}
+
+		// Regroup the kept dependencies by the dependency of "from" they
+		// came from.
+		std::size_t last = from_table.size();
+
+		for (std::size_t c = 0; c < candidate_attr.size(); c++) {
+
+			if (!index.enabled[first_candidate + c])
+				continue;
+
+			if (candidate_of[c] != last) {
+
+				not_implied.emplace_back();
+
+				for (AttributeTblIndex attr : candidate_lhs[c])
+					not_implied.back().first.push_back(names[attr]);
+
+				last = candidate_of[c];
+
+			}
+
+			not_implied.back().second.push_back(names[candidate_attr[c]]);
+
+		}
+
+		return not_implied;
+
+	}
+
+	// =========================================================================
+	// Prints a comparison.
+	// =========================================================================
+	void FuncDepComparer::Print(const FuncDepComparison & comparison) {
+
+		auto print_func_deps = [&](const std::string & title,
+			const std::vector<SimpleFuncDep> & func_deps) {
+
+			std::cout << title << "\n";
+
+			if (func_deps.empty())
+				std::cout << "None.\n";
+
+			for (const SimpleFuncDep & func_dep : func_deps) {
+
+				PrintAttrNames(func_dep.first);
+				std::cout << " -> ";
+				PrintAttrNames(func_dep.second);
+				std::cout << "\n";
+
+			}
+
+		};
+
+		std::cout << "Functional Dependency Comparison:\n\n"
+			<< "Attributes only in " << a.GetName() << ":\n";
+		PrintAttrNames(comparison.only_in_a);
+		std::cout << "\nAttributes only in " << b.GetName() << ":\n";
+		PrintAttrNames(comparison.only_in_b);
+		std::cout << "\n\n";
+
+		print_func_deps("Not implied by " + b.GetName() + ":", comparison.not_implied_by_b);
+		std::cout << "\n";
+		print_func_deps("Not implied by " + a.GetName() + ":", comparison.not_implied_by_a);
+
+		std::cout << "\n" << (comparison.Equivalent() ? "Equivalent." : "Not equivalent.")
+			<< " (" << comparison.closures_computed << " closures)\n";
+
+	}
+
+	// =========================================================================
+	// Prints attribute names as a set.
+	// =========================================================================
+	void FuncDepComparer::PrintAttrNames(const std::vector<std::string> &
+		attr_names) {
+
+		std::cout << "{ ";
+
+		for (std::size_t i = 0; i < attr_names.size(); i++)
+			std::cout << (i != 0 ? ", " : "") << attr_names[i];
+
+		std::cout << " }";
+
+	}
+
+	// =========================================================================
+	// Translates a set of attributes of one of the databases to indexes
+	// into "names".
+	// =========================================================================
+	std::vector<AttributeTblIndex> FuncDepComparer::Translate(const Database &
+		db, const AttributeSet & attribute_set) {
+
+		std::vector<AttributeTblIndex> translated;
+
+		for (AttributeTblIndex attr : attribute_set)
+			translated.push_back(name_index.at(db.GetAttributeTable()[attr].name));
+
+		return translated;
+
+	}
+
+}
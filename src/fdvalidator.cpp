@@ -0,0 +1,308 @@
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "csvreader.h"
+#include "fdvalidator.h"
+
+namespace DbNormalizerCpp {
+
+	namespace {
+
+		// =====================================================================
+		// Number of rows read before columns are encoded and functional 
+		// dependencies are checked.
+		// =====================================================================
+		const std::size_t BATCH_ROWS = 65536;
+
+		using CodeTuple = std::vector<ValueCode>;
+
+		// =====================================================================
+		// Hashes a tuple of value codes.
+		// =====================================================================
+		struct CodeTupleHash {
+
+			std::size_t operator()(const CodeTuple & tuple) const {
+
+				std::size_t hash = tuple.size();
+
+				for (ValueCode code : tuple)
+					hash ^= code + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+				return hash;
+
+			}
+
+		};
+
+		// =====================================================================
+		// Rhs codes of the first row seen with some lhs codes.
+		// =====================================================================
+		struct FirstSeen {
+
+			CodeTuple rhs;
+			std::size_t row;
+
+		};
+
+		// =====================================================================
+		// Validation state of one functional dependency. Columns are indexes
+		// into the encoded columns.
+		// =====================================================================
+		struct FuncDepState {
+
+			std::vector<std::size_t> lhs_columns;
+			std::vector<std::size_t> rhs_columns;
+			std::unordered_map<CodeTuple, FirstSeen, CodeTupleHash> seen;
+
+		};
+
+		// =====================================================================
+		// Calls "task" for every index in [0, "count") using up to 
+		// "max_threads" threads. Each index is handled by exactly one 
+		// thread.
+		// =====================================================================
+		void ParallelFor(std::size_t count, unsigned int max_threads,
+			const std::function<void(std::size_t)> & task) {
+
+			std::size_t num_threads = max_threads < count ? max_threads : count;
+
+			if (num_threads <= 1) {
+
+				for (std::size_t i = 0; i < count; i++)
+					task(i);
+
+				return;
+
+			}
+
+			std::vector<std::thread> threads;
+
+			for (std::size_t t = 0; t < num_threads; t++) {
+
+				threads.push_back(std::thread([&, t]() {
+
+					for (std::size_t i = t; i < count; i += num_threads)
+						task(i);
+
+				}));
+
+			}
+
+			for (std::thread & thread : threads)
+				thread.join();
+
+		}
+
+	}
+
+	// =========================================================================
+	// Prints validation results.
+	//
+	// "results":
+	//		Results returned by Validate().
+	// =========================================================================
+	void FuncDepValidator::Print(const FuncDepValidationResultList & results) {
+
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+
+		std::cout << "Functional Dependency Validation:\n";
+
+		for (const FuncDepValidationResult & result : results) {
+
+			PrintAttrSet(func_dep_table[result.fd_tbl_index].first);
+			std::cout << " -> ";
+			PrintAttrSet(func_dep_table[result.fd_tbl_index].second);
+			std::cout << " : " << result.violating_rows << " of " 
+				<< result.rows_checked << " rows violate (" << std::fixed
+				<< std::setprecision(2) << result.ViolationRate() * 100 << "%)\n";
+
+			for (const FuncDepViolation & violation : result.violations) {
+				std::cout << "\trow " << violation.row << " conflicts with row " 
+					<< violation.conflicting_row << "\n";
+			}
+
+		}
+
+	}
+
+	// =========================================================================
+	// Prints an AttributeSet by attribute names.
+	//
+	// "attribute_set":
+	//		Set of attributes to print.
+	// =========================================================================
+	void FuncDepValidator::PrintAttrSet(const AttributeSet & attribute_set) {
+
+		std::cout << "{ ";
+
+		for (AttributeSet::const_iterator it = attribute_set.begin(); it != attribute_set.end(); it++) {
+
+			std::cout << db.GetAttributeTable()[*it].name;
+			std::string comma = std::next(it, 1) != attribute_set.end() ? ", " : "";
+			std::cout << comma;
+
+		}
+
+		std::cout << " }";
+
+	}
+
+	// =========================================================================
+	// Validates every functional dependency against a .csv stream.
+	//
+	// Rows are read in batches. For each batch, every referenced column is
+	// encoded by one thread with the column's own dictionary, then every 
+	// functional dependency is checked by one thread against its own hash
+	// map, so no locking is needed.
+	//
+	// "stream":
+	//		Stream that contains the .csv data.
+	//
+	// Returns one result per functional dependency, in functional dependency
+	// table order.
+	// =========================================================================
+	FuncDepValidationResultList FuncDepValidator::Validate(std::istream & stream) {
+
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+
+		CsvReader reader(stream);
+		std::vector<std::string> header;
+
+		if (!reader.ReadRow(header))
+			throw std::runtime_error("Expected a header row but reached end of file!");
+
+		// Map every attribute referenced by a functional dependency to an 
+		// encoded column.
+		std::unordered_map<std::string, std::size_t> header_positions;
+
+		for (std::size_t i = 0; i < header.size(); i++)
+			header_positions.insert(std::make_pair(header[i], i));
+
+		std::unordered_map<AttributeTblIndex, std::size_t> encoded_column_of;
+		std::vector<std::size_t> encoded_positions;
+		std::vector<FuncDepState> states(func_dep_table.size());
+
+		auto encoded_column = [&](AttributeTblIndex attr) {
+
+			auto it = encoded_column_of.find(attr);
+
+			if (it != encoded_column_of.end())
+				return it->second;
+
+			auto position = header_positions.find(attribute_table[attr].name);
+
+			if (position == header_positions.end()) {
+				throw std::runtime_error("Expected a column named '" 
+					+ attribute_table[attr].name + "' but found none!");
+			}
+
+			encoded_positions.push_back(position->second);
+			encoded_column_of.insert(std::make_pair(attr, encoded_positions.size() - 1));
+
+			return encoded_positions.size() - 1;
+
+		};
+
+		for (FuncDepTblIndex i = 0; i < func_dep_table.size(); i++) {
+
+			for (AttributeTblIndex attr : func_dep_table[i].first)
+				states[i].lhs_columns.push_back(encoded_column(attr));
+
+			for (AttributeTblIndex attr : func_dep_table[i].second)
+				states[i].rhs_columns.push_back(encoded_column(attr));
+
+		}
+
+		FuncDepValidationResultList results(func_dep_table.size());
+
+		for (FuncDepTblIndex i = 0; i < func_dep_table.size(); i++)
+			results[i].fd_tbl_index = i;
+
+		std::vector<ColumnDictionary> dictionaries(encoded_positions.size());
+		std::vector<std::vector<ValueCode>> codes(encoded_positions.size());
+		std::vector<std::vector<std::string>> batch;
+		std::size_t rows_read = 0;
+
+		while (true) {
+
+			// Read the next batch of rows.
+			batch.clear();
+
+			std::vector<std::string> fields;
+
+			while (batch.size() < BATCH_ROWS && reader.ReadRow(fields)) {
+
+				if (fields.size() == 1 && fields[0].empty())
+					continue; // Empty line.
+
+				if (fields.size() != header.size()) {
+					throw std::runtime_error("Expected " + std::to_string(header.size())
+						+ " fields on row " + std::to_string(rows_read + batch.size() + 1)
+						+ " but got " + std::to_string(fields.size()) + "!");
+				}
+
+				batch.push_back(std::move(fields));
+
+			}
+
+			if (batch.empty())
+				break;
+
+			// Encode columns in parallel.
+			ParallelFor(encoded_positions.size(), max_threads, [&](std::size_t c) {
+
+				codes[c].resize(batch.size());
+
+				for (std::size_t r = 0; r < batch.size(); r++)
+					codes[c][r] = dictionaries[c].Encode(batch[r][encoded_positions[c]]);
+
+			});
+
+			// Check functional dependencies in parallel.
+			ParallelFor(states.size(), max_threads, [&](std::size_t f) {
+
+				FuncDepState & state = states[f];
+				FuncDepValidationResult & result = results[f];
+				CodeTuple lhs(state.lhs_columns.size());
+				CodeTuple rhs(state.rhs_columns.size());
+
+				for (std::size_t r = 0; r < batch.size(); r++) {
+
+					for (std::size_t k = 0; k < lhs.size(); k++)
+						lhs[k] = codes[state.lhs_columns[k]][r];
+
+					for (std::size_t k = 0; k < rhs.size(); k++)
+						rhs[k] = codes[state.rhs_columns[k]][r];
+
+					std::size_t row = rows_read + r + 1;
+					auto inserted = state.seen.insert(std::make_pair(lhs, FirstSeen{ rhs, row }));
+
+					if (!inserted.second && inserted.first->second.rhs != rhs) {
+
+						result.violating_rows++;
+
+						if (result.violations.size() < max_reported_violations)
+							result.violations.push_back({ row, inserted.first->second.row });
+
+					}
+
+				}
+
+				result.rows_checked += batch.size();
+
+			});
+
+			rows_read += batch.size();
+
+		}
+
+		return results;
+
+	}
+
+}
@@ -0,0 +1,764 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "joinsimulator.h"
+
+namespace DbNormalizerCpp {
+
+	namespace {
+
+		using Clock = std::chrono::steady_clock;
+		using Column = std::vector<std::int64_t>;
+
+		// Empty bucket or end of a hash chain.
+		const std::uint32_t NO_ROW = std::numeric_limits<std::uint32_t>::max();
+
+		// =====================================================================
+		// Returns the seconds elapsed since "start".
+		// =====================================================================
+		double SecondsSince(Clock::time_point start) {
+
+			return std::chrono::duration<double>(Clock::now() - start).count();
+
+		}
+
+		// =====================================================================
+		// Returns the number of threads that split "count" items when at
+		// most "max_threads" may run, at least 1.
+		// =====================================================================
+		std::size_t NumThreads(std::size_t count, unsigned int max_threads) {
+
+			std::size_t num_threads = max_threads < count ? max_threads : count;
+
+			return num_threads == 0 ? 1 : num_threads;
+
+		}
+
+		// =====================================================================
+		// Calls "task" once per thread with a contiguous range [first, last)
+		// of [0, "count"). Ranges are in thread order and cover "count".
+		// =====================================================================
+		void ParallelRanges(std::size_t count, std::size_t num_threads,
+			const std::function<void(std::size_t, std::size_t, std::size_t)> & task) {
+
+			if (num_threads <= 1) {
+				task(0, count, 0);
+				return;
+			}
+
+			std::vector<std::thread> threads;
+
+			for (std::size_t t = 0; t < num_threads; t++) {
+
+				std::size_t first = count * t / num_threads;
+				std::size_t last = count * (t + 1) / num_threads;
+
+				threads.push_back(std::thread([&task, first, last, t]() {
+					task(first, last, t);
+				}));
+
+			}
+
+			for (std::thread & thread : threads)
+				thread.join();
+
+		}
+
+		// =====================================================================
+		// Calls "task" for every index in [0, "count") using up to
+		// "max_threads" threads. Each index is handled by exactly one
+		// thread.
+		// =====================================================================
+		void ParallelFor(std::size_t count, unsigned int max_threads,
+			const std::function<void(std::size_t)> & task) {
+
+			std::size_t num_threads = NumThreads(count, max_threads);
+
+			if (num_threads <= 1) {
+
+				for (std::size_t i = 0; i < count; i++)
+					task(i);
+
+				return;
+
+			}
+
+			std::vector<std::thread> threads;
+
+			for (std::size_t t = 0; t < num_threads; t++) {
+
+				threads.push_back(std::thread([&, t]() {
+
+					for (std::size_t i = t; i < count; i += num_threads)
+						task(i);
+
+				}));
+
+			}
+
+			for (std::thread & thread : threads)
+				thread.join();
+
+		}
+
+		// =====================================================================
+		// Returns the root of a row's class in a union-find forest, halving
+		// the path on the way.
+		// =====================================================================
+		std::uint32_t FindRoot(std::vector<std::uint32_t> & parent, std::uint32_t row) {
+
+			while (parent[row] != row) {
+				parent[row] = parent[parent[row]];
+				row = parent[row];
+			}
+
+			return row;
+
+		}
+
+		// =====================================================================
+		// Hashes the values of some columns in one row.
+		// =====================================================================
+		std::uint64_t HashRow(const std::vector<const Column *> & key_columns,
+			std::size_t row) {
+
+			std::uint64_t hash = key_columns.size();
+
+			for (const Column * column : key_columns)
+				hash ^= static_cast<std::uint64_t>((*column)[row]) + 0x9e3779b97f4a7c15
+					+ (hash << 6) + (hash >> 2);
+
+			// Mixes the bits, so that partitions and buckets, which use
+			// different bits, are both uniform.
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccd;
+			hash ^= hash >> 33;
+
+			return hash;
+
+		}
+
+		// =====================================================================
+		// Returns the indexes of the distinct rows of some columns, in
+		// ascending lexicographic order of their values.
+		// =====================================================================
+		std::vector<std::uint32_t> SortedDistinctRows(const std::vector<const Column *> &
+			columns, std::size_t rows) {
+
+			std::vector<std::uint32_t> order(rows);
+
+			for (std::size_t row = 0; row < rows; row++)
+				order[row] = static_cast<std::uint32_t>(row);
+
+			auto compare = [&columns](std::uint32_t a, std::uint32_t b) {
+
+				for (const Column * column : columns) {
+
+					if ((*column)[a] != (*column)[b])
+						return (*column)[a] < (*column)[b];
+
+				}
+
+				return false;
+
+			};
+
+			auto equal = [&compare](std::uint32_t a, std::uint32_t b) {
+				return !compare(a, b) && !compare(b, a);
+			};
+
+			std::sort(order.begin(), order.end(), compare);
+			order.erase(std::unique(order.begin(), order.end(), equal), order.end());
+
+			return order;
+
+		}
+
+		// =====================================================================
+		// Returns the columns of a table in its attributes' order.
+		// =====================================================================
+		std::vector<const Column *> AllColumns(const ColumnarTable & table) {
+
+			std::vector<const Column *> columns;
+
+			for (const Column & column : table.columns)
+				columns.push_back(&column);
+
+			return columns;
+
+		}
+
+	}
+
+	// =========================================================================
+	// Constructs a JoinSimulator.
+	// =========================================================================
+	JoinSimulator::JoinSimulator(const Database & _db, JoinSimulationConfig _config)
+		: config(_config), db(_db) {
+
+		if (config.domain == 0)
+			throw std::invalid_argument("A join simulation needs at least one value per attribute!");
+
+		if (config.rows >= NO_ROW)
+			throw std::invalid_argument("Too many rows for a join simulation!");
+
+	}
+
+	// =========================================================================
+	// Generates the global relation: random rows on which the chase enforces
+	// every functional dependency, without duplicates.
+	//
+	// Every attribute keeps a union-find forest over the rows. Two rows are
+	// in the same class iff they hold the same value, and the value of a row
+	// is the root of its class. Making rows agree only ever merges classes,
+	// so the chase ends.
+	//
+	// "chase_passes":
+	//		Receives the number of passes over the functional dependency
+	//		table.
+	// =========================================================================
+	ColumnarTable JoinSimulator::GenerateGlobal(std::size_t & chase_passes) {
+
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+		std::size_t num_attributes = attribute_table.size();
+		std::mt19937_64 rng(config.seed);
+		std::vector<std::vector<std::uint32_t>> parent(num_attributes,
+			std::vector<std::uint32_t>(config.rows));
+
+		// Rows drawing the same value start in the same class, rooted at
+		// the first of them.
+		for (AttributeTblIndex attr = 0; attr < num_attributes; attr++) {
+
+			std::vector<std::uint32_t> first_row(config.domain, NO_ROW);
+
+			for (std::uint32_t row = 0; row < config.rows; row++) {
+
+				std::size_t value = rng() % config.domain;
+
+				if (first_row[value] == NO_ROW)
+					first_row[value] = row;
+
+				parent[attr][row] = first_row[value];
+
+			}
+
+		}
+
+		bool merged;
+		chase_passes = 0;
+
+		do {
+
+			merged = false;
+			chase_passes++;
+
+			for (const FuncDep & func_dep : func_dep_table) {
+
+				// Numbers the groups of rows that agree on the lhs, one
+				// lhs attribute at a time.
+				std::vector<std::uint32_t> group(config.rows, 0);
+
+				for (AttributeTblIndex attr : func_dep.first) {
+
+					std::unordered_map<std::uint64_t, std::uint32_t> refined;
+
+					for (std::uint32_t row = 0; row < config.rows; row++) {
+
+						std::uint64_t key = (std::uint64_t(group[row]) << 32)
+							| FindRoot(parent[attr], row);
+						auto inserted = refined.emplace(key,
+							static_cast<std::uint32_t>(refined.size()));
+
+						group[row] = inserted.first->second;
+
+					}
+
+				}
+
+				// Every row of a group gets the rhs values of the group's
+				// first row.
+				std::vector<std::uint32_t> first_row(config.rows, NO_ROW);
+
+				for (std::uint32_t row = 0; row < config.rows; row++) {
+
+					if (first_row[group[row]] == NO_ROW) {
+						first_row[group[row]] = row;
+						continue;
+					}
+
+					for (AttributeTblIndex attr : func_dep.second) {
+
+						std::uint32_t a = FindRoot(parent[attr], first_row[group[row]]);
+						std::uint32_t b = FindRoot(parent[attr], row);
+
+						if (a == b)
+							continue;
+
+						// The smaller row index stays the root, so values
+						// do not depend on the merge order.
+						parent[attr][a < b ? b : a] = a < b ? a : b;
+						merged = true;
+
+					}
+
+				}
+
+			}
+
+		} while (merged);
+
+		std::vector<Column> values(num_attributes, Column(config.rows));
+
+		for (AttributeTblIndex attr = 0; attr < num_attributes; attr++) {
+
+			for (std::uint32_t row = 0; row < config.rows; row++)
+				values[attr][row] = FindRoot(parent[attr], row);
+
+		}
+
+		std::vector<const Column *> columns;
+
+		for (const Column & column : values)
+			columns.push_back(&column);
+
+		std::vector<std::uint32_t> distinct = SortedDistinctRows(columns, config.rows);
+		ColumnarTable global;
+
+		global.name = db.GetName();
+		global.rows = distinct.size();
+
+		for (AttributeTblIndex attr = 0; attr < num_attributes; attr++) {
+
+			Column column(distinct.size());
+
+			for (std::size_t i = 0; i < distinct.size(); i++)
+				column[i] = values[attr][distinct[i]];
+
+			global.attributes.push_back(attr);
+			global.columns.push_back(std::move(column));
+
+		}
+
+		return global;
+
+	}
+
+	// =========================================================================
+	// Natural join of two tables on their shared attributes. The smaller
+	// table is the build side and the larger is probed.
+	//
+	// "left", "right":
+	//		Tables to join. Must share at least one attribute.
+	//
+	// "join":
+	//		Receives the row counts and bytes of the join. Its "relation"
+	//		and "on" are left to the caller.
+	//
+	// Returns the joined table. Its attributes are both tables' attributes,
+	// ascending, and its rows follow the probe side's order.
+	// =========================================================================
+	ColumnarTable JoinSimulator::HashJoin(const ColumnarTable & left,
+		const ColumnarTable & right, SimulatedJoin & join) {
+
+		const ColumnarTable & build = right.rows <= left.rows ? right : left;
+		const ColumnarTable & probe = right.rows <= left.rows ? left : right;
+
+		// Key columns of both sides, in the order of the shared attributes,
+		// and the source of every output column.
+		std::vector<const Column *> build_key;
+		std::vector<const Column *> probe_key;
+		std::vector<std::pair<bool, const Column *>> sources;	// From build?
+		ColumnarTable output;
+		std::size_t b = 0;
+		std::size_t p = 0;
+
+		while (b < build.attributes.size() || p < probe.attributes.size()) {
+
+			bool in_build = b < build.attributes.size() && (p == probe.attributes.size()
+				|| build.attributes[b] <= probe.attributes[p]);
+			bool in_probe = p < probe.attributes.size() && (b == build.attributes.size()
+				|| probe.attributes[p] <= build.attributes[b]);
+
+			if (in_build && in_probe) {
+				build_key.push_back(&build.columns[b]);
+				probe_key.push_back(&probe.columns[p]);
+			}
+
+			output.attributes.push_back(in_probe ? probe.attributes[p] : build.attributes[b]);
+			sources.push_back(in_probe ? std::make_pair(false, &probe.columns[p])
+				: std::make_pair(true, &build.columns[b]));
+
+			b += in_build ? 1 : 0;
+			p += in_probe ? 1 : 0;
+
+		}
+
+		std::size_t num_threads = NumThreads(probe.rows, config.max_threads);
+		std::size_t num_partitions = NumThreads(build.rows, config.max_threads);
+		std::vector<std::uint64_t> hashes(build.rows);
+		std::vector<std::vector<std::uint32_t>> buckets(num_partitions);
+		std::vector<std::uint32_t> next(build.rows, NO_ROW);
+
+		// Build: hashes the build side in ranges, then every thread chains
+		// the rows of its own partition. Partitions use the low bits of a
+		// hash and buckets the bits above them.
+		ParallelRanges(build.rows, NumThreads(build.rows, config.max_threads),
+			[&](std::size_t first, std::size_t last, std::size_t) {
+
+			for (std::size_t row = first; row < last; row++)
+				hashes[row] = HashRow(build_key, row);
+
+		});
+
+		ParallelRanges(num_partitions, num_partitions,
+			[&](std::size_t, std::size_t, std::size_t partition) {
+
+			std::size_t count = 0;
+
+			for (std::uint64_t hash : hashes)
+				count += hash % num_partitions == partition ? 1 : 0;
+
+			std::size_t num_buckets = 1;
+
+			while (num_buckets < 2 * count)
+				num_buckets *= 2;
+
+			std::vector<std::uint32_t> & heads = buckets[partition];
+			heads.assign(num_buckets, NO_ROW);
+
+			// Rows are pushed in descending order, so every chain is
+			// ascending.
+			for (std::size_t row = build.rows; row-- > 0; ) {
+
+				if (hashes[row] % num_partitions != partition)
+					continue;
+
+				std::size_t bucket = (hashes[row] / num_partitions) & (num_buckets - 1);
+				next[row] = heads[bucket];
+				heads[bucket] = static_cast<std::uint32_t>(row);
+
+			}
+
+		});
+
+		// Probe: every thread probes a contiguous range into its own list
+		// of matching (probe row, build row) pairs.
+		std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> matches(num_threads);
+
+		ParallelRanges(probe.rows, num_threads,
+			[&](std::size_t first, std::size_t last, std::size_t t) {
+
+			for (std::size_t row = first; row < last; row++) {
+
+				std::uint64_t hash = HashRow(probe_key, row);
+				const std::vector<std::uint32_t> & heads = buckets[hash % num_partitions];
+				std::uint32_t match = heads[(hash / num_partitions) & (heads.size() - 1)];
+
+				for (; match != NO_ROW; match = next[match]) {
+
+					bool equal = hashes[match] == hash;
+
+					for (std::size_t k = 0; equal && k < build_key.size(); k++)
+						equal = (*build_key[k])[match] == (*probe_key[k])[row];
+
+					if (equal)
+						matches[t].push_back(std::make_pair(static_cast<std::uint32_t>(row), match));
+
+				}
+
+			}
+
+		});
+
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+
+		for (const auto & thread_matches : matches)
+			pairs.insert(pairs.end(), thread_matches.begin(), thread_matches.end());
+
+		// Materializes the output one column per task.
+		output.rows = pairs.size();
+		output.columns.resize(sources.size());
+
+		ParallelFor(sources.size(), config.max_threads, [&](std::size_t c) {
+
+			Column & column = output.columns[c];
+			column.resize(pairs.size());
+
+			for (std::size_t i = 0; i < pairs.size(); i++)
+				column[i] = (*sources[c].second)[sources[c].first ? pairs[i].second : pairs[i].first];
+
+		});
+
+		std::size_t hash_table_bytes = hashes.size() * sizeof(std::uint64_t)
+			+ next.size() * sizeof(std::uint32_t);
+
+		for (const std::vector<std::uint32_t> & heads : buckets)
+			hash_table_bytes += heads.size() * sizeof(std::uint32_t);
+
+		join.probe_rows = probe.rows;
+		join.build_rows = build.rows;
+		join.output_rows = output.rows;
+		join.hash_table_bytes = hash_table_bytes;
+		join.output_bytes = output.Bytes();
+
+		return output;
+
+	}
+
+	// =========================================================================
+	// Prints a report.
+	// =========================================================================
+	void JoinSimulator::Print(const JoinSimulationReport & report) {
+
+		auto seconds = [](double value) {
+
+			std::ostringstream text;
+			text << std::fixed << std::setprecision(4) << value << " s";
+
+			return text.str();
+
+		};
+
+		auto print_table = [&](const SimulatedTable & table, const std::string & verb) {
+
+			std::cout << table.name << ": " << table.rows << " rows x " << table.columns
+				<< " columns = " << table.bytes << " bytes, " << verb << " in "
+				<< seconds(table.seconds) << "\n";
+
+		};
+
+		double ratio = report.global.bytes == 0 ? 1.0
+			: static_cast<double>(report.normalized_bytes) / report.global.bytes;
+		std::ostringstream percent;
+
+		percent << std::fixed << std::setprecision(1) << ratio * 100;
+
+		std::cout << "Join Simulation:\n\nGlobal relation:\n";
+		print_table(report.global, "generated");
+		std::cout << "Chase passes: " << report.chase_passes << "\n";
+
+		std::cout << "\nRelations:\n";
+
+		for (const SimulatedTable & table : report.relations)
+			print_table(table, "projected");
+
+		std::cout << "\nJoins:\n";
+
+		for (const SimulatedJoin & join : report.joins) {
+
+			std::cout << join.relation << " on {" << join.on << "}: probe "
+				<< join.probe_rows << " rows, build " << join.build_rows << " rows -> "
+				<< join.output_rows << " rows, hash table " << join.hash_table_bytes
+				<< " bytes, output " << join.output_bytes << " bytes, "
+				<< seconds(join.seconds) << "\n";
+
+		}
+
+		std::cout << "\nNormalized bytes: " << report.normalized_bytes << " ("
+			<< percent.str() << "% of global)\n"
+			<< "Join time: " << seconds(report.join_seconds) << "\n"
+			<< "Peak join bytes: " << report.peak_join_bytes << "\n";
+
+		if (!report.reconstructed)
+			std::cout << "Not reconstructed: the relations do not all share attributes\n";
+		else
+			std::cout << "Reconstructed rows: " << report.reconstructed_rows
+				<< (report.matches ? " (matches the global relation)\n"
+				: " (does NOT match the global relation)\n");
+
+	}
+
+	// =========================================================================
+	// Projects the global relation onto a relation's attributes, without
+	// duplicates.
+	//
+	// "global":
+	//		Table returned by GenerateGlobal().
+	//
+	// "relation":
+	//		Relation of the relation table.
+	// =========================================================================
+	ColumnarTable JoinSimulator::Project(const ColumnarTable & global,
+		const Relation & relation) {
+
+		ColumnarTable table;
+		std::vector<const Column *> columns;
+
+		table.name = relation.name;
+
+		// The global relation's columns are in attribute order.
+		for (AttributeTblIndex attr : relation.attributes) {
+			table.attributes.push_back(attr);
+			columns.push_back(&global.columns[attr]);
+		}
+
+		std::vector<std::uint32_t> distinct = SortedDistinctRows(columns, global.rows);
+
+		table.rows = distinct.size();
+
+		for (const Column * source : columns) {
+
+			Column column(distinct.size());
+
+			for (std::size_t i = 0; i < distinct.size(); i++)
+				column[i] = (*source)[distinct[i]];
+
+			table.columns.push_back(std::move(column));
+
+		}
+
+		return table;
+
+	}
+
+	// =========================================================================
+	// Generates the rows, materializes the tables, and reconstructs the
+	// global relation.
+	// =========================================================================
+	JoinSimulationReport JoinSimulator::Simulate() {
+
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+		const RelationTable & relation_table = db.GetRelationTable();
+		JoinSimulationReport report;
+
+		Clock::time_point start = Clock::now();
+		ColumnarTable global = GenerateGlobal(report.chase_passes);
+
+		report.global.seconds = SecondsSince(start);
+		report.global.name = global.name;
+		report.global.rows = global.rows;
+		report.global.columns = global.columns.size();
+		report.global.bytes = global.Bytes();
+
+		// Relations are projected independently, one per task.
+		std::vector<ColumnarTable> tables(relation_table.size());
+		report.relations.resize(relation_table.size());
+
+		ParallelFor(relation_table.size(), config.max_threads, [&](std::size_t i) {
+
+			Clock::time_point projected = Clock::now();
+			tables[i] = Project(global, relation_table[i]);
+
+			SimulatedTable & table = report.relations[i];
+			table.seconds = SecondsSince(projected);
+			table.name = tables[i].name;
+			table.rows = tables[i].rows;
+			table.columns = tables[i].columns.size();
+			table.bytes = tables[i].Bytes();
+
+		});
+
+		for (const SimulatedTable & table : report.relations)
+			report.normalized_bytes += table.bytes;
+
+		if (tables.empty())
+			return report;
+
+		// Starts with the largest relation, then joins in the relation
+		// sharing the most attributes with the result so far.
+		std::vector<bool> joined(tables.size(), false);
+		std::size_t largest = 0;
+
+		for (std::size_t i = 1; i < tables.size(); i++) {
+
+			if (tables[i].rows > tables[largest].rows)
+				largest = i;
+
+		}
+
+		ColumnarTable result = tables[largest];
+		joined[largest] = true;
+		report.reconstructed = true;
+
+		for (std::size_t step = 1; step < tables.size(); step++) {
+
+			std::size_t best = tables.size();
+			std::size_t best_shared = 0;
+
+			for (std::size_t i = 0; i < tables.size(); i++) {
+
+				if (joined[i])
+					continue;
+
+				std::vector<AttributeTblIndex> shared;
+				std::set_intersection(result.attributes.begin(), result.attributes.end(),
+					tables[i].attributes.begin(), tables[i].attributes.end(),
+					std::back_inserter(shared));
+
+				if (shared.size() > best_shared) {
+					best = i;
+					best_shared = shared.size();
+				}
+
+			}
+
+			if (best == tables.size()) {
+				report.reconstructed = false;
+				break;
+			}
+
+			SimulatedJoin join;
+			join.relation = tables[best].name;
+
+			for (AttributeTblIndex attr : tables[best].attributes) {
+
+				if (std::binary_search(result.attributes.begin(), result.attributes.end(), attr))
+					join.on += (join.on.empty() ? "" : ", ") + attribute_table[attr].name;
+
+			}
+
+			start = Clock::now();
+			ColumnarTable output = HashJoin(result, tables[best], join);
+			join.seconds = SecondsSince(start);
+
+			report.peak_join_bytes = std::max(report.peak_join_bytes, result.Bytes()
+				+ tables[best].Bytes() + join.hash_table_bytes + join.output_bytes);
+			report.join_seconds += join.seconds;
+			report.joins.push_back(join);
+
+			result = std::move(output);
+			joined[best] = true;
+
+		}
+
+		report.reconstructed_rows = result.rows;
+
+		if (!report.reconstructed)
+			return report;
+
+		// The reconstruction matches iff it has the global relation's
+		// attributes and, sorted like the global relation, the same rows.
+		report.matches = result.attributes == global.attributes
+			&& result.rows == global.rows;
+
+		if (report.matches) {
+
+			std::vector<std::uint32_t> order = SortedDistinctRows(AllColumns(result), result.rows);
+
+			report.matches = order.size() == global.rows;
+
+			for (std::size_t c = 0; report.matches && c < global.columns.size(); c++) {
+
+				for (std::size_t i = 0; report.matches && i < order.size(); i++)
+					report.matches = result.columns[c][order[i]] == global.columns[c][i];
+
+			}
+
+		}
+
+		return report;
+
+	}
+
+}
@@ -1,7 +1,17 @@
+#include <cstdlib>
 #include <iostream>
 #include <string>
 
+#include "advisor.h"
 #include "database.h"
+#include "ddlemitter.h"
+#include "fdcomparer.h"
+#include "joinsimulator.h"
+#include "oracle.h"
+#include "relationstream.h"
+#include "server.h"
+#include "storageestimator.h"
+#include "tracer.h"
 #include "txtparser.h"
 
 #define DOC_FOLDER "doc"
@@ -17,27 +27,249 @@
 //		more than once.
 //	*	Consider artificial keys if no natural PK exists. in AssignPrimaryKey(),
 //		must add the necessary functional depedency?
-//	*	Add types to input files.
-//	*	Add AttributeType to Attribute struct.
 // =============================================================================
 
-int main()
+// =============================================================================
+// Parses a normal form argument. Only "2nf" and "4nf" can be normalized to.
+//
+// "text":
+//		Argument to parse.
+//
+// "normal_form":
+//		Receives the normal form.
+//
+// Returns false, after printing a usage error, if "text" is neither.
+// =============================================================================
+static bool ParseNormalForm(const std::string & text, 
+	DbNormalizerCpp::NormalForm & normal_form)
+{
+	if (text == "2nf")
+		normal_form = DbNormalizerCpp::NormalForm::Two;
+	else if (text == "4nf")
+		normal_form = DbNormalizerCpp::NormalForm::Four;
+	else {
+		std::cerr << "Unsupported normal form '" << text 
+			<< "': expected 2nf or 4nf\n";
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char * argv[])
 {
 	using namespace DbNormalizerCpp;
 
+	std::string mode = argc > 1 ? argv[1] : "";
+
+	if (mode == "--oracle") {
+
+		// --oracle [num_schemas] [max_threads] [seed]
+		std::size_t num_schemas = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+		unsigned int max_threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+		unsigned int seed = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1;
+
+		DifferentialOracle oracle(seed, max_threads);
+		OracleCaseResultList results = oracle.Run(num_schemas);
+		oracle.Print(results);
+
+		for (const OracleCaseResult & result : results) {
+
+			if (result.mismatches != 0)
+				return 1;
+
+		}
+
+		return 0;
+
+	}
+
+	if (mode == "--advise" && argc > 3) {
+
+		// --advise <schema_file> <workload_file> [max_threads] [statistics_file]
+		unsigned int max_threads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1;
+		TxtParser parser;
+		parser.Open(argv[2]);
+
+		Database db = parser.Parse();
+		db.NormalizeTo2nf(max_threads);
+
+		DecompositionAdvisor advisor(db);
+		advisor.LoadWorkload(argv[3]);
+
+		if (argc > 5) {
+			StorageEstimator estimator(db);
+			estimator.LoadStatistics(argv[5]);
+			advisor.SetStatistics(estimator);
+		}
+
+		advisor.Print(advisor.Advise(max_threads));
+
+		return 0;
+
+	}
+
+	if (mode == "--ddl" && argc > 2) {
+
+		// --ddl <schema_file> [2nf|4nf] [max_threads]
+		NormalForm normal_form;
+		unsigned int max_threads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1;
+
+		if (!ParseNormalForm(argc > 3 ? argv[3] : "2nf", normal_form))
+			return 2;
+
+		TxtParser parser;
+		parser.Open(argv[2]);
+
+		Database db = parser.Parse();
+
+		if (normal_form == NormalForm::Four)
+			db.NormalizeTo4nf(max_threads);
+		else
+			db.NormalizeTo2nf(max_threads);
+
+		DdlEmitter emitter(db);
+		emitter.Emit(std::cout);
+
+		return 0;
+
+	}
+
+	if (mode == "--diff" && argc > 3) {
+
+		// --diff <schema_file_a> <schema_file_b> [max_threads]
+		unsigned int max_threads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1;
+		TxtParser parser_a;
+		TxtParser parser_b;
+		parser_a.Open(argv[2]);
+		parser_b.Open(argv[3]);
+
+		Database db_a = parser_a.Parse();
+		Database db_b = parser_b.Parse();
+
+		FuncDepComparer comparer(db_a, db_b, max_threads);
+		FuncDepComparison comparison = comparer.Compare();
+		comparer.Print(comparison);
+
+		return comparison.Equivalent() ? 0 : 1;
+
+	}
+
+	if (mode == "--serve") {
+
+		// --serve [socket_path|-] [num_workers] [2nf|4nf]
+		std::string socket_path = argc > 2 ? argv[2] : "-";
+		unsigned int num_workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+		NormalForm normal_form;
+
+		if (!ParseNormalForm(argc > 4 ? argv[4] : "2nf", normal_form))
+			return 2;
+
+		NormalizationServer server(normal_form, num_workers);
+
+		if (socket_path == "-")
+			server.Serve(std::cin, std::cout);
+		else
+			server.ServeSocket(socket_path);
+
+		server.PrintStats(std::cerr);
+
+		return 0;
+
+	}
+
+	if (mode == "--simulate" && argc > 2) {
+
+		// --simulate <schema_file> [rows] [domain] [max_threads]
+		JoinSimulationConfig config;
+		config.rows = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : config.rows;
+		config.domain = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : config.domain;
+		config.max_threads = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 1;
+		TxtParser parser;
+		parser.Open(argv[2]);
+
+		Database db = parser.Parse();
+		db.NormalizeTo2nf(config.max_threads);
+
+		JoinSimulator simulator(db, config);
+		JoinSimulationReport report = simulator.Simulate();
+		simulator.Print(report);
+
+		return report.matches ? 0 : 1;
+
+	}
+
+	if (mode == "--stream" && argc > 2) {
+
+		// --stream <schema_file> [2nf|4nf]
+		NormalForm normal_form;
+
+		if (!ParseNormalForm(argc > 3 ? argv[3] : "2nf", normal_form))
+			return 2;
+
+		TxtParser parser;
+		parser.Open(argv[2]);
+
+		Database db = parser.Parse();
+		RelationStream stream(db, normal_form);
+
+		for (const Relation & relation : stream) {
+			db.Print(std::cout, relation);
+			std::cout << "\n" << std::flush;
+		}
+
+		return 0;
+
+	}
+
+	if (mode == "--storage" && argc > 3) {
+
+		// --storage <schema_file> <statistics_file> [2nf|4nf]
+		NormalForm normal_form;
+
+		if (!ParseNormalForm(argc > 4 ? argv[4] : "2nf", normal_form))
+			return 2;
+
+		TxtParser parser;
+		parser.Open(argv[2]);
+
+		Database db = parser.Parse();
+
+		if (normal_form == NormalForm::Four)
+			db.NormalizeTo4nf();
+		else
+			db.NormalizeTo2nf();
+
+		StorageEstimator estimator(db);
+		estimator.LoadStatistics(argv[3]);
+		estimator.Print(estimator.Estimate());
+
+		return 0;
+
+	}
+
+	// --trace <trace_file> [max_threads]
+	bool tracing = mode == "--trace" && argc > 2;
+	unsigned int max_threads = tracing && argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1;
+	Tracer tracer;
+
 	Database db;
 
 	{
 
 		TxtParser parser;
+		parser.SetTracer(tracing ? &tracer : nullptr);
 		parser.Open(std::string(DOC_FOLDER) + "\\" + EMP_PROJ_FILENAME);
 		db = parser.Parse(); 
 
 	}	// Discard parser; it is not needed anymore.
 
-	db.NormalizeTo2nf();
+	db.NormalizeTo2nf(max_threads);
 	db.Print();
 
+	if (tracing)
+		tracer.Write(std::string(argv[2]));
+
 	return 0;
 }
 
@@ -0,0 +1,251 @@
+#include "minkeyfinder.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a MinimumKeyFinder.
+	// =========================================================================
+	MinimumKeyFinder::MinimumKeyFinder(const PackedFuncDepTable & _func_deps,
+		std::size_t _search_budget, StopPredicate _should_stop)
+		: best_size(0), budget_exhausted(false), closures_computed(0),
+		func_deps(_func_deps), num_words(_func_deps.GetNumWords()),
+		search_budget(_search_budget), should_stop(std::move(_should_stop)),
+		stopped(false) {
+
+	}
+
+	// =========================================================================
+	// Computes the closure of a packed set of attributes with respect to all
+	// functional dependencies, counting it against the search budget.
+	// Intersected with a relation, it is the closure with respect to the
+	// functional dependencies projected onto the relation.
+	// =========================================================================
+	PackedAttributeSet MinimumKeyFinder::ComputeClosureOf(const
+		PackedAttributeSet & attributes) {
+
+		closures_computed++;
+		return func_deps.ComputeClosureOf(attributes);
+
+	}
+
+	// =========================================================================
+	// Finds a smallest candidate key of a relation.
+	// =========================================================================
+	AttributeSet MinimumKeyFinder::Find(const AttributeSet & attributes) {
+
+		budget_exhausted = false;
+		closures_computed = 0;
+		stopped = false;
+		relation = PackAttributes(attributes, num_words);
+
+		const PackedAttributeSet & in_lhs = func_deps.GetInLhs();
+		const PackedAttributeSet & in_rhs = func_deps.GetInRhs();
+
+		// Attributes never on a rhs are in every key.
+		PackedAttributeSet core(num_words, 0);
+		PackedAttributeSet rhs_only(num_words, 0);
+		PackedAttributeSet rest(num_words, 0);
+
+		for (std::size_t w = 0; w < num_words; w++) {
+			core[w] = relation[w] & ~in_rhs[w];
+			rhs_only[w] = relation[w] & in_rhs[w] & ~in_lhs[w];
+			rest[w] = relation[w] & ~rhs_only[w];
+		}
+
+		// Every key determines the rest of the relation, so it determines
+		// the rhs-only attributes that the rest determines and has to hold
+		// the others.
+		PackedAttributeSet determined = ComputeClosureOf(rest);
+
+		for (std::size_t w = 0; w < num_words; w++)
+			core[w] |= rhs_only[w] & ~determined[w];
+
+		candidates.clear();
+
+		for (AttributeTblIndex attr : attributes) {
+
+			if (HasPackedAttribute(in_lhs, attr) && HasPackedAttribute(in_rhs, attr))
+				candidates.push_back(attr);
+
+		}
+
+		remaining.assign(candidates.size() + 1, PackedAttributeSet(num_words, 0));
+
+		for (std::size_t i = candidates.size(); i-- > 0;) {
+			remaining[i] = remaining[i + 1];
+			InsertPackedAttribute(remaining[i], candidates[i]);
+		}
+
+		// Upper bound: the core plus every candidate, reduced to a key.
+		best = core;
+
+		for (std::size_t w = 0; w < num_words; w++)
+			best[w] |= remaining[0][w];
+
+		ReduceToKey(best);
+		best_size = CountPackedAttributes(best);
+
+		// Once stopped, the superkey is returned as it is.
+		if (!stopped) {
+
+			PackedAttributeSet x = core;
+			Search(x, CountPackedAttributes(core), 0);
+
+			// A key found after the budget ran out may still hold an
+			// attribute a later branch would have dropped.
+			if (budget_exhausted && !stopped)
+				ReduceToKey(best);
+
+		}
+
+		AttributeSet key;
+
+		for (AttributeTblIndex attr : attributes) {
+
+			if (HasPackedAttribute(best, attr))
+				key.insert(attr);
+
+		}
+
+		return key;
+
+	}
+
+	// =========================================================================
+	// Returns whether a packed set of attributes functionally determines
+	// every attribute of the relation.
+	// =========================================================================
+	bool MinimumKeyFinder::IsSuperkey(const PackedAttributeSet & attributes) {
+
+		PackedAttributeSet closure = ComputeClosureOf(attributes);
+
+		for (std::size_t w = 0; w < num_words; w++) {
+
+			if ((relation[w] & ~closure[w]) != 0)
+				return false;
+
+		}
+
+		return true;
+
+	}
+
+	// =========================================================================
+	// Returns whether the search has to stop, recording whether the budget
+	// ran out or the stop predicate stopped it.
+	// =========================================================================
+	bool MinimumKeyFinder::OutOfBudget() {
+
+		if (closures_computed >= search_budget)
+			budget_exhausted = true;
+		else if (!stopped && should_stop && should_stop())
+			stopped = true;
+
+		return budget_exhausted || stopped;
+
+	}
+
+	// =========================================================================
+	// Greedily reduces a superkey of the relation to a candidate key,
+	// removing candidates in ascending order. Core attributes are in every
+	// key, so only candidates are tried. Takes one closure per candidate,
+	// which the search budget does not count, but the stop predicate is
+	// checked before every one of them; once it stops the reduction, "key"
+	// is left a superkey.
+	//
+	// "key":
+	//		Superkey to reduce in place.
+	// =========================================================================
+	void MinimumKeyFinder::ReduceToKey(PackedAttributeSet & key) {
+
+		for (AttributeTblIndex attr : candidates) {
+
+			if (!HasPackedAttribute(key, attr))
+				continue;
+
+			if (!stopped && should_stop && should_stop())
+				stopped = true;
+
+			if (stopped)
+				return;
+
+			ErasePackedAttribute(key, attr);
+
+			if (!IsSuperkey(key))
+				InsertPackedAttribute(key, attr);
+
+		}
+
+	}
+
+	// =========================================================================
+	// Searches for a key smaller than "best", grown from "x" with candidates
+	// at index "next" or later.
+	//
+	// "x":
+	//		Current set, restored before returning.
+	//
+	// "size":
+	//		Number of attributes in "x".
+	//
+	// "next":
+	//		Index into "candidates" of the first attribute that may be
+	//		added.
+	// =========================================================================
+	void MinimumKeyFinder::Search(PackedAttributeSet & x, std::size_t size,
+		std::size_t next) {
+
+		if (OutOfBudget())
+			return;
+
+		PackedAttributeSet closure = ComputeClosureOf(x);
+		bool is_superkey = true;
+
+		for (std::size_t w = 0; w < num_words && is_superkey; w++)
+			is_superkey = (relation[w] & ~closure[w]) == 0;
+
+		if (is_superkey) {
+
+			if (size < best_size) {
+				best = x;
+				best_size = size;
+			}
+
+			return;
+
+		}
+
+		// Adding one more attribute would not beat the best key, or no
+		// candidate is left.
+		if (size + 1 >= best_size || next == candidates.size())
+			return;
+
+		// Bound: even every candidate left does not complete a key.
+		PackedAttributeSet all = x;
+
+		for (std::size_t w = 0; w < num_words; w++)
+			all[w] |= remaining[next][w];
+
+		if (!IsSuperkey(all))
+			return;
+
+		for (std::size_t i = next; i < candidates.size(); i++) {
+
+			AttributeTblIndex attr = candidates[i];
+
+			// A key never holds an attribute the rest of it determines.
+			if (HasPackedAttribute(closure, attr))
+				continue;
+
+			InsertPackedAttribute(x, attr);
+			Search(x, size + 1, i + 1);
+			ErasePackedAttribute(x, attr);
+
+			if (budget_exhausted || stopped || size + 1 >= best_size)
+				return;
+
+		}
+
+	}
+
+}
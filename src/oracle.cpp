@@ -0,0 +1,981 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+
+#include "minkeyfinder.h"
+#include "oracle.h"
+#include "staticschema.h"
+
+namespace DbNormalizerCpp {
+
+	namespace {
+
+		using ReferenceSet = std::set<AttributeTblIndex>;
+		using Clock = std::chrono::steady_clock;
+
+		// =====================================================================
+		// Returns the seconds elapsed since "start".
+		// =====================================================================
+		double SecondsSince(Clock::time_point start) {
+
+			return std::chrono::duration<double>(Clock::now() - start).count();
+
+		}
+
+		// =====================================================================
+		// Reference closure: a subset test per functional dependency and a
+		// fixed point over the whole functional dependency table.
+		// =====================================================================
+		ReferenceSet ReferenceClosure(const FuncDepTable & func_dep_table,
+			const ReferenceSet & attributes) {
+
+			ReferenceSet closure = attributes;
+			bool changed = true;
+
+			while (changed) {
+
+				changed = false;
+
+				for (const FuncDep & func_dep : func_dep_table) {
+
+					ReferenceSet lhs(func_dep.first.begin(), func_dep.first.end());
+
+					if (!std::includes(closure.begin(), closure.end(), lhs.begin(), lhs.end()))
+						continue;
+
+					for (AttributeTblIndex attr : func_dep.second)
+						changed = closure.insert(attr).second || changed;
+
+				}
+
+			}
+
+			return closure;
+
+		}
+
+		// =====================================================================
+		// Returns the attributes whose bits are set in "mask".
+		// =====================================================================
+		ReferenceSet FromMask(const std::vector<AttributeTblIndex> & attributes,
+			std::uint32_t mask) {
+
+			ReferenceSet set;
+
+			for (std::size_t i = 0; i < attributes.size(); i++) {
+
+				if ((mask >> i) & 1)
+					set.insert(attributes[i]);
+
+			}
+
+			return set;
+
+		}
+
+		// =====================================================================
+		// Reference candidate keys of the projection of the functional
+		// dependencies onto "attributes", found by enumerating every subset
+		// in order of increasing size.
+		// =====================================================================
+		std::vector<ReferenceSet> ReferenceCandidateKeys(const FuncDepTable &
+			func_dep_table, const ReferenceSet & attributes) {
+
+			std::vector<AttributeTblIndex> list(attributes.begin(), attributes.end());
+			std::vector<std::uint32_t> key_masks;
+			std::vector<ReferenceSet> keys;
+
+			for (std::size_t size = 0; size <= list.size(); size++) {
+
+				for (std::uint32_t mask = 0; mask < (std::uint32_t(1) << list.size()); mask++) {
+
+					if (static_cast<std::size_t>(__builtin_popcount(mask)) != size)
+						continue;
+
+					bool has_key_subset = false;
+
+					for (std::uint32_t key_mask : key_masks)
+						has_key_subset = has_key_subset || (key_mask & ~mask) == 0;
+
+					if (has_key_subset)
+						continue;
+
+					ReferenceSet candidate = FromMask(list, mask);
+					ReferenceSet closure = ReferenceClosure(func_dep_table, candidate);
+
+					if (std::includes(closure.begin(), closure.end(),
+						attributes.begin(), attributes.end())) {
+
+						key_masks.push_back(mask);
+						keys.push_back(candidate);
+
+					}
+
+				}
+
+			}
+
+			return keys;
+
+		}
+
+		// =====================================================================
+		// Returns a relation table in a form that does not depend on the
+		// order of relations or of attributes within sets.
+		// =====================================================================
+		std::vector<std::pair<ReferenceSet, ReferenceSet>> CanonicalRelations(
+			const RelationTable & relation_table) {
+
+			std::vector<std::pair<ReferenceSet, ReferenceSet>> relations;
+
+			for (const Relation & relation : relation_table) {
+
+				relations.push_back(std::make_pair(
+					ReferenceSet(relation.attributes.begin(), relation.attributes.end()),
+					ReferenceSet(relation.primary_key.begin(), relation.primary_key.end())));
+
+			}
+
+			std::sort(relations.begin(), relations.end());
+
+			return relations;
+
+		}
+
+		// =====================================================================
+		// Returns the attributes of every relation.
+		// =====================================================================
+		ReferenceSet CoveredAttributes(const RelationTable & relation_table) {
+
+			ReferenceSet covered;
+
+			for (const Relation & relation : relation_table)
+				covered.insert(relation.attributes.begin(), relation.attributes.end());
+
+			return covered;
+
+		}
+
+		// Functional dependencies of every "static schema" schema.
+		const std::size_t STATIC_FUNC_DEPS = 8;
+
+		// Relation name, attributes and primary key.
+		using NamedRelation = std::tuple<std::string, ReferenceSet, ReferenceSet>;
+
+		// =====================================================================
+		// Returns the attributes whose bits are set in a StaticAttributeSet.
+		// =====================================================================
+		ReferenceSet FromStaticSet(StaticAttributeSet set) {
+
+			ReferenceSet attributes;
+
+			for (AttributeTblIndex attr = 0; attr < 64; attr++) {
+
+				if ((set >> attr) & 1)
+					attributes.insert(attr);
+
+			}
+
+			return attributes;
+
+		}
+
+		// =====================================================================
+		// Generates a schema of "NumAttributes" attributes and 
+		// STATIC_FUNC_DEPS functional dependencies, normalizes it to 2NF with
+		// both a StaticSchema and a Database, and compares the relation 
+		// tables, names included.
+		//
+		// "rng":
+		//		Schema generator.
+		//
+		// "result":
+		//		Result to count the case into. The Database is the reference.
+		// =====================================================================
+		template <std::size_t NumAttributes>
+		void CheckStaticSchemaOf(std::mt19937 & rng, OracleCaseResult & result) {
+
+			std::array<std::string, NumAttributes> names;
+			std::array<std::string, STATIC_FUNC_DEPS> texts;
+			std::array<std::string_view, NumAttributes> name_views;
+			std::array<std::string_view, STATIC_FUNC_DEPS> text_views;
+			Database db;
+
+			db.SetName("oracle");
+
+			for (std::size_t i = 0; i < NumAttributes; i++) {
+				names[i] = "a" + std::to_string(i);
+				name_views[i] = names[i];
+				db.InsertAttribute(names[i]);
+			}
+
+			// Dependencies are non-trivial, with small sides, so that the
+			// StaticSchema's unbudgeted key and prime searches stay small
+			// even on 64 attributes.
+			for (std::size_t i = 0; i < STATIC_FUNC_DEPS; i++) {
+
+				SimpleFuncDep func_dep;
+				std::size_t lhs_size = 1 + rng() % 2;
+				std::size_t rhs_size = 1 + rng() % 2;
+
+				while (func_dep.first.size() < lhs_size) {
+
+					std::string attr = names[rng() % NumAttributes];
+
+					if (std::find(func_dep.first.begin(), func_dep.first.end(), attr) == func_dep.first.end())
+						func_dep.first.push_back(attr);
+
+				}
+
+				while (func_dep.second.size() < rhs_size) {
+
+					std::string attr = names[rng() % NumAttributes];
+
+					if (std::find(func_dep.first.begin(), func_dep.first.end(), attr) == func_dep.first.end()
+						&& std::find(func_dep.second.begin(), func_dep.second.end(), attr) == func_dep.second.end())
+						func_dep.second.push_back(attr);
+
+				}
+
+				for (std::size_t j = 0; j < func_dep.first.size(); j++)
+					texts[i] += (j == 0 ? "" : ",") + func_dep.first[j];
+
+				texts[i] += "->";
+
+				for (std::size_t j = 0; j < func_dep.second.size(); j++)
+					texts[i] += (j == 0 ? "" : ",") + func_dep.second[j];
+
+				text_views[i] = texts[i];
+				db.InsertFuncDep(func_dep);
+
+			}
+
+			Clock::time_point start = Clock::now();
+			auto schema = StaticSchema<NumAttributes, STATIC_FUNC_DEPS>(name_views,
+				text_views).NormalizeTo2nf();
+			result.optimized_seconds += SecondsSince(start);
+
+			start = Clock::now();
+			db.NormalizeTo2nf();
+			result.reference_seconds += SecondsSince(start);
+
+			std::vector<NamedRelation> expected;
+			std::vector<NamedRelation> actual;
+
+			for (const Relation & relation : db.GetRelationTable()) {
+
+				expected.push_back(NamedRelation(relation.name,
+					ReferenceSet(relation.attributes.begin(), relation.attributes.end()),
+					ReferenceSet(relation.primary_key.begin(), relation.primary_key.end())));
+
+			}
+
+			for (std::size_t i = 0; i < schema.GetNumRelations(); i++) {
+
+				const auto & relation = schema.GetRelation(i);
+
+				actual.push_back(NamedRelation(relation.number == 0 ? std::string("global_relation")
+					: "r" + std::to_string(relation.number), FromStaticSet(relation.attributes),
+					FromStaticSet(relation.primary_key)));
+
+			}
+
+			std::sort(expected.begin(), expected.end());
+			std::sort(actual.begin(), actual.end());
+
+			result.cases++;
+
+			if (expected != actual || !schema.IsIn2nf())
+				result.mismatches++;
+
+		}
+
+	}
+
+	// =========================================================================
+	// Constructs a DifferentialOracle.
+	// =========================================================================
+	DifferentialOracle::DifferentialOracle(unsigned int seed,
+		unsigned int _max_threads, std::size_t _max_attributes,
+		std::size_t _max_func_deps)
+		: max_attributes(_max_attributes), max_func_deps(_max_func_deps),
+		max_threads(_max_threads), rng(seed) {
+
+		if (max_attributes < 1 || max_attributes > 16)
+			throw std::invalid_argument("Expected between 1 and 16 attributes per schema!");
+
+	}
+
+	// =========================================================================
+	// Checks that ComputeCandidateKey() returns a superkey none of whose
+	// attributes can be removed.
+	// =========================================================================
+	void DifferentialOracle::CheckCandidateKey(Database & db,
+		OracleCaseResult & result) {
+
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+		ReferenceSet universe;
+
+		for (AttributeTblIndex i = 0; i < db.GetAttributeTable().size(); i++)
+			universe.insert(i);
+
+		Relation relation;
+		relation.attributes.insert(universe.begin(), universe.end());
+
+		Clock::time_point start = Clock::now();
+		db.ComputeCandidateKey(relation);
+		result.optimized_seconds += SecondsSince(start);
+
+		start = Clock::now();
+		std::vector<ReferenceSet> keys = ReferenceCandidateKeys(func_dep_table, universe);
+		result.reference_seconds += SecondsSince(start);
+
+		ReferenceSet key(relation.candidate_keys.front().begin(),
+			relation.candidate_keys.front().end());
+
+		result.cases++;
+
+		if (std::find(keys.begin(), keys.end(), key) == keys.end())
+			result.mismatches++;
+
+	}
+
+	// =========================================================================
+	// Checks ComputeClosureOf() on random attribute sets.
+	// =========================================================================
+	void DifferentialOracle::CheckClosure(Database & db,
+		OracleCaseResult & result) {
+
+		const std::size_t SETS_PER_SCHEMA = 16;
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+		std::size_t num_attributes = db.GetAttributeTable().size();
+
+		for (std::size_t i = 0; i < SETS_PER_SCHEMA; i++) {
+
+			AttributeSet attributes;
+			std::uint32_t mask = rng() & ((std::uint32_t(1) << num_attributes) - 1);
+
+			for (AttributeTblIndex attr = 0; attr < num_attributes; attr++) {
+
+				if ((mask >> attr) & 1)
+					attributes.insert(attr);
+
+			}
+
+			Clock::time_point start = Clock::now();
+			AttributeSet closure = db.ComputeClosureOf(attributes);
+			result.optimized_seconds += SecondsSince(start);
+
+			start = Clock::now();
+			ReferenceSet expected = ReferenceClosure(func_dep_table,
+				ReferenceSet(attributes.begin(), attributes.end()));
+			result.reference_seconds += SecondsSince(start);
+
+			result.cases++;
+
+			if (ReferenceSet(closure.begin(), closure.end()) != expected)
+				result.mismatches++;
+
+		}
+
+	}
+
+	// =========================================================================
+	// Checks ComputeClosuresOf() on a batch of random attribute sets that
+	// spans several BatchClosure blocks.
+	// =========================================================================
+	void DifferentialOracle::CheckBatchClosure(Database & db,
+		OracleCaseResult & result) {
+
+		const std::size_t SETS_PER_SCHEMA = BatchClosure::BLOCK_SIZE + 44;
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+		std::size_t num_attributes = db.GetAttributeTable().size();
+		std::vector<AttributeSet> attribute_sets(SETS_PER_SCHEMA);
+
+		for (AttributeSet & attributes : attribute_sets) {
+
+			std::uint32_t mask = rng() & ((std::uint32_t(1) << num_attributes) - 1);
+
+			for (AttributeTblIndex attr = 0; attr < num_attributes; attr++) {
+
+				if ((mask >> attr) & 1)
+					attributes.insert(attr);
+
+			}
+
+		}
+
+		Clock::time_point start = Clock::now();
+		std::vector<AttributeSet> closures = db.ComputeClosuresOf(attribute_sets);
+		result.optimized_seconds += SecondsSince(start);
+
+		for (std::size_t i = 0; i < SETS_PER_SCHEMA; i++) {
+
+			start = Clock::now();
+			ReferenceSet expected = ReferenceClosure(func_dep_table,
+				ReferenceSet(attribute_sets[i].begin(), attribute_sets[i].end()));
+			result.reference_seconds += SecondsSince(start);
+
+			result.cases++;
+
+			if (i >= closures.size()
+				|| ReferenceSet(closures[i].begin(), closures[i].end()) != expected)
+				result.mismatches++;
+
+		}
+
+	}
+
+	// =========================================================================
+	// Checks NormalizeComponents() against NormalizeTo2nf() of the same
+	// schema, made of independent sub-schemas so that it splits into
+	// several components. The two may differ relation for relation: an
+	// attribute that fully depends on a key of its component may depend on
+	// part of the larger key of the whole schema, and only the whole
+	// schema's global relation keeps every prime attribute. So the check is
+	// that the components cover every attribute, that the linking relation
+	// is held by a relation of NormalizeTo2nf(), i.e., by its global
+	// relation, and that, like that global relation, it holds no other
+	// relation.
+	// =========================================================================
+	void DifferentialOracle::CheckComponents(OracleCaseResult & result) {
+
+		Database db = GenerateComponentSchema();
+		Database baseline = db;
+
+		Clock::time_point start = Clock::now();
+		db.NormalizeComponents(NormalForm::Two, max_threads);
+		result.optimized_seconds += SecondsSince(start);
+
+		start = Clock::now();
+		baseline.NormalizeTo2nf(1);
+		result.reference_seconds += SecondsSince(start);
+
+		// A schema of a single component falls back to NormalizeTo2nf(),
+		// whose relations come in the order the threads finish them.
+		// Otherwise the linking relation is merged last.
+		const RelationTable & relation_table = db.GetRelationTable();
+		std::set<ReferenceSet> relations, baseline_relations;
+		bool matches = !relation_table.empty()
+			&& CoveredAttributes(relation_table).size() == db.GetAttributeTable().size();
+
+		for (const Relation & relation : relation_table)
+			relations.insert(ReferenceSet(relation.attributes.begin(), relation.attributes.end()));
+
+		for (const Relation & relation : baseline.GetRelationTable()) {
+			baseline_relations.insert(ReferenceSet(relation.attributes.begin(),
+				relation.attributes.end()));
+		}
+
+		if (matches && relations != baseline_relations) {
+
+			ReferenceSet link(relation_table.back().attributes.begin(),
+				relation_table.back().attributes.end());
+			bool held = false;
+
+			for (const Relation & relation : baseline.GetRelationTable()) {
+
+				ReferenceSet attributes(relation.attributes.begin(), relation.attributes.end());
+				held = held || std::includes(attributes.begin(), attributes.end(),
+					link.begin(), link.end());
+
+			}
+
+			for (std::size_t i = 0; i + 1 < relation_table.size(); i++) {
+
+				ReferenceSet attributes(relation_table[i].attributes.begin(),
+					relation_table[i].attributes.end());
+				matches = matches && !std::includes(link.begin(), link.end(),
+					attributes.begin(), attributes.end());
+
+			}
+
+			matches = matches && held;
+
+		}
+
+		result.cases++;
+
+		if (!matches)
+			result.mismatches++;
+
+	}
+
+	// =========================================================================
+	// Checks a multi-threaded NormalizeTo2nf() against a single-threaded run
+	// of the same schema, and checks that the relations cover every 
+	// attribute.
+	// =========================================================================
+	void DifferentialOracle::CheckDecomposition(Database & db,
+		Database & baseline, OracleCaseResult & result) {
+
+		Clock::time_point start = Clock::now();
+		db.NormalizeTo2nf(max_threads);
+		result.optimized_seconds += SecondsSince(start);
+
+		start = Clock::now();
+		baseline.NormalizeTo2nf(1);
+		result.reference_seconds += SecondsSince(start);
+
+		bool matches = CanonicalRelations(db.GetRelationTable())
+			== CanonicalRelations(baseline.GetRelationTable());
+
+		result.cases++;
+
+		if (!matches || CoveredAttributes(db.GetRelationTable()).size()
+			!= db.GetAttributeTable().size())
+			result.mismatches++;
+
+	}
+
+	// =========================================================================
+	// Checks NormalizeTo4nf() on a schema with functional dependencies only,
+	// where 4NF is BCNF: every relation is in BCNF with respect to the
+	// functional dependencies whose lhs it holds, and the relations cover
+	// every attribute. Also checks that a schema already in BCNF, i.e.,
+	// whose every lhs is a superkey, is left as one relation.
+	// =========================================================================
+	void DifferentialOracle::CheckFourthNormalForm(Database & db,
+		OracleCaseResult & result) {
+
+		Database bcnf = GenerateBcnfSchema();
+
+		Clock::time_point start = Clock::now();
+		db.NormalizeTo4nf(max_threads);
+		bcnf.NormalizeTo4nf(max_threads);
+		result.optimized_seconds += SecondsSince(start);
+
+		start = Clock::now();
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+		bool matches = CoveredAttributes(db.GetRelationTable()).size()
+			== db.GetAttributeTable().size();
+
+		for (const Relation & relation : db.GetRelationTable()) {
+
+			ReferenceSet attributes(relation.attributes.begin(), relation.attributes.end());
+
+			for (const FuncDep & func_dep : func_dep_table) {
+
+				ReferenceSet lhs(func_dep.first.begin(), func_dep.first.end());
+
+				if (!std::includes(attributes.begin(), attributes.end(), lhs.begin(), lhs.end()))
+					continue;
+
+				ReferenceSet closure = ReferenceClosure(func_dep_table, lhs);
+				bool is_superkey = std::includes(closure.begin(), closure.end(),
+					attributes.begin(), attributes.end());
+				bool determines_other = false;
+
+				for (AttributeTblIndex attr : attributes)
+					determines_other = determines_other || (closure.count(attr) && !lhs.count(attr));
+
+				matches = matches && (is_superkey || !determines_other);
+
+			}
+
+		}
+
+		// Relations that share a candidate key K were split needlessly: K
+		// determines their union, which is in BCNF too.
+		std::set<ReferenceSet> keys;
+
+		for (const Relation & relation : db.GetRelationTable()) {
+
+			for (const CandidateKey & key : relation.candidate_keys)
+				matches = keys.insert(ReferenceSet(key.begin(), key.end())).second && matches;
+
+		}
+
+		const RelationTable & bcnf_relations = bcnf.GetRelationTable();
+
+		matches = matches && bcnf_relations.size() == 1
+			&& bcnf_relations.front().attributes.size() == bcnf.GetAttributeTable().size();
+
+		result.reference_seconds += SecondsSince(start);
+		result.cases++;
+
+		if (!matches)
+			result.mismatches++;
+
+	}
+
+	// =========================================================================
+	// Checks the closures and candidate keys of the global relation.
+	// =========================================================================
+	void DifferentialOracle::CheckGlobalClosure(Database & db,
+		OracleCaseResult & result) {
+
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+		std::size_t num_attributes = db.GetAttributeTable().size();
+
+		Clock::time_point start = Clock::now();
+		GlobalRelation gbl_relation = db.GenerateGlobalRelation(max_threads);
+		result.optimized_seconds += SecondsSince(start);
+
+		start = Clock::now();
+		std::vector<ReferenceSet> expected;
+		std::vector<ReferenceSet> expected_keys;
+
+		for (const FuncDep & func_dep : func_dep_table) {
+
+			ReferenceSet lhs(func_dep.first.begin(), func_dep.first.end());
+			expected.push_back(ReferenceClosure(func_dep_table, lhs));
+
+			if (expected.back().size() == num_attributes)
+				expected_keys.push_back(lhs);
+
+		}
+
+		result.reference_seconds += SecondsSince(start);
+
+		bool matches = gbl_relation.closure.size() == expected.size();
+
+		for (FuncDepTblIndex i = 0; matches && i < gbl_relation.closure.size(); i++) {
+
+			const AttributeSetClosure & closure = gbl_relation.closure[i];
+			matches = closure.first == i && ReferenceSet(closure.second.begin(),
+				closure.second.end()) == expected[i];
+
+		}
+
+		std::vector<ReferenceSet> keys;
+
+		for (const CandidateKey & key : gbl_relation.candidate_keys)
+			keys.push_back(ReferenceSet(key.begin(), key.end()));
+
+		// Without a lhs superkey, the only key is a smallest candidate key.
+		if (expected_keys.empty() && keys.size() == 1) {
+
+			ReferenceSet universe;
+
+			for (AttributeTblIndex i = 0; i < num_attributes; i++)
+				universe.insert(i);
+
+			start = Clock::now();
+			std::vector<ReferenceSet> smallest = ReferenceCandidateKeys(func_dep_table, universe);
+			result.reference_seconds += SecondsSince(start);
+
+			if (std::find(smallest.begin(), smallest.end(), keys.front()) != smallest.end()
+				&& keys.front().size() == smallest.front().size())
+				expected_keys = keys;
+
+		}
+
+		result.cases++;
+
+		if (!matches || keys != expected_keys)
+			result.mismatches++;
+
+	}
+
+	// =========================================================================
+	// Checks that MinimumKeyFinder returns a candidate key of smallest size
+	// of a random relation.
+	// =========================================================================
+	void DifferentialOracle::CheckMinimumKey(Database & db,
+		OracleCaseResult & result) {
+
+		ReferenceSet attributes;
+
+		for (AttributeTblIndex i = 0; i < db.GetAttributeTable().size(); i++) {
+
+			if (rng() % 4 != 0)
+				attributes.insert(i);
+
+		}
+
+		AttributeSet relation_attributes(attributes.begin(), attributes.end());
+
+		Clock::time_point start = Clock::now();
+		MinimumKeyFinder finder(db.GetPackedFuncDepTable());
+		AttributeSet found = finder.Find(relation_attributes);
+		result.optimized_seconds += SecondsSince(start);
+
+		start = Clock::now();
+		std::vector<ReferenceSet> keys = ReferenceCandidateKeys(db.GetFuncDepTable(), attributes);
+		result.reference_seconds += SecondsSince(start);
+
+		ReferenceSet key(found.begin(), found.end());
+
+		result.cases++;
+
+		if (std::find(keys.begin(), keys.end(), key) == keys.end()
+			|| key.size() != keys.front().size())
+			result.mismatches++;
+
+	}
+
+	// =========================================================================
+	// Checks MarkPrimeAttributes() against the union of all candidate keys.
+	// =========================================================================
+	void DifferentialOracle::CheckPrimeAttributes(Database & db,
+		OracleCaseResult & result) {
+
+		ReferenceSet universe;
+
+		for (AttributeTblIndex i = 0; i < db.GetAttributeTable().size(); i++)
+			universe.insert(i);
+
+		Clock::time_point start = Clock::now();
+		db.MarkPrimeAttributes();
+		result.optimized_seconds += SecondsSince(start);
+
+		start = Clock::now();
+		ReferenceSet expected;
+
+		for (const ReferenceSet & key : ReferenceCandidateKeys(db.GetFuncDepTable(), universe))
+			expected.insert(key.begin(), key.end());
+
+		result.reference_seconds += SecondsSince(start);
+
+		bool matches = true;
+
+		for (AttributeTblIndex i = 0; i < db.GetAttributeTable().size(); i++)
+			matches = matches && db.GetAttributeTable()[i].prime == (expected.count(i) != 0);
+
+		result.cases++;
+
+		if (!matches)
+			result.mismatches++;
+
+	}
+
+	// =========================================================================
+	// Checks StaticSchema against NormalizeTo2nf() on a schema of 8, 16, 32 
+	// or 64 attributes.
+	// =========================================================================
+	void DifferentialOracle::CheckStaticSchema(OracleCaseResult & result) {
+
+		switch (rng() % 4) {
+		case 0:
+			CheckStaticSchemaOf<8>(rng, result);
+			break;
+		case 1:
+			CheckStaticSchemaOf<16>(rng, result);
+			break;
+		case 2:
+			CheckStaticSchemaOf<32>(rng, result);
+			break;
+		default:
+			CheckStaticSchemaOf<64>(rng, result);
+			break;
+		}
+
+	}
+
+	// =========================================================================
+	// Generates a random schema in BCNF: one to three random keys, each the
+	// lhs of a functional dependency on every other attribute.
+	// =========================================================================
+	Database DifferentialOracle::GenerateBcnfSchema() {
+
+		Database db;
+		std::size_t num_attributes = 2 + rng() % (max_attributes - 1);
+		std::size_t num_keys = 1 + rng() % 3;
+
+		db.SetName("oracle");
+
+		for (std::size_t i = 0; i < num_attributes; i++)
+			db.InsertAttribute("a" + std::to_string(i));
+
+		for (std::size_t k = 0; k < num_keys; k++) {
+
+			SimpleFuncDep func_dep;
+			std::set<std::size_t> key;
+			std::size_t key_size = 1 + rng() % 2;
+
+			for (std::size_t j = 0; j < key_size; j++)
+				key.insert(rng() % num_attributes);
+
+			for (std::size_t attr = 0; attr < num_attributes; attr++) {
+
+				if (key.count(attr))
+					func_dep.first.push_back("a" + std::to_string(attr));
+				else
+					func_dep.second.push_back("a" + std::to_string(attr));
+
+			}
+
+			if (!func_dep.second.empty())
+				db.InsertFuncDep(func_dep);
+
+		}
+
+		return db;
+
+	}
+
+	// =========================================================================
+	// Generates a random schema of two to four sub-schemas that share no
+	// attribute, plus attributes in no functional dependency. Every
+	// sub-schema is generated as by GenerateSchema().
+	// =========================================================================
+	Database DifferentialOracle::GenerateComponentSchema() {
+
+		Database db;
+		std::size_t num_components = 2 + rng() % 3;
+		std::size_t num_attributes = 0;
+
+		db.SetName("oracle");
+
+		for (std::size_t c = 0; c < num_components; c++) {
+
+			std::size_t first = num_attributes;
+			std::size_t size = 1 + rng() % (max_attributes / num_components + 1);
+			std::size_t num_func_deps = 1 + rng() % max_func_deps;
+
+			num_attributes += size;
+
+			for (std::size_t i = first; i < num_attributes; i++)
+				db.InsertAttribute("a" + std::to_string(i));
+
+			for (std::size_t i = 0; i < num_func_deps; i++) {
+
+				SimpleFuncDep func_dep;
+				std::size_t lhs_size = 1 + rng() % 3;
+
+				for (std::size_t j = 0; j < lhs_size; j++)
+					func_dep.first.push_back("a" + std::to_string(first + rng() % size));
+
+				for (std::size_t attr = first; attr < num_attributes; attr++) {
+
+					if (rng() % 4 == 0)
+						func_dep.second.push_back("a" + std::to_string(attr));
+
+				}
+
+				if (func_dep.second.empty())
+					func_dep.second.push_back("a" + std::to_string(first + rng() % size));
+
+				db.InsertFuncDep(func_dep);
+
+			}
+
+		}
+
+		for (std::size_t i = rng() % 3; i > 0; i--, num_attributes++)
+			db.InsertAttribute("a" + std::to_string(num_attributes));
+
+		return db;
+
+	}
+
+	// =========================================================================
+	// Generates a random schema. Lhs sets are small and rhs sets are drawn
+	// from the remaining attributes, so that schemas have several candidate
+	// keys and partial dependencies.
+	// =========================================================================
+	Database DifferentialOracle::GenerateSchema() {
+
+		Database db;
+		std::size_t num_attributes = 1 + rng() % max_attributes;
+		std::size_t num_func_deps = rng() % (max_func_deps + 1);
+
+		db.SetName("oracle");
+
+		for (std::size_t i = 0; i < num_attributes; i++)
+			db.InsertAttribute("a" + std::to_string(i));
+
+		for (std::size_t i = 0; i < num_func_deps; i++) {
+
+			SimpleFuncDep func_dep;
+			std::size_t lhs_size = 1 + rng() % 3;
+
+			for (std::size_t j = 0; j < lhs_size; j++)
+				func_dep.first.push_back("a" + std::to_string(rng() % num_attributes));
+
+			for (std::size_t attr = 0; attr < num_attributes; attr++) {
+
+				if (rng() % 4 == 0)
+					func_dep.second.push_back("a" + std::to_string(attr));
+
+			}
+
+			if (func_dep.second.empty())
+				func_dep.second.push_back("a" + std::to_string(rng() % num_attributes));
+
+			db.InsertFuncDep(func_dep);
+
+		}
+
+		return db;
+
+	}
+
+	// =========================================================================
+	// Prints oracle results.
+	// =========================================================================
+	void DifferentialOracle::Print(const OracleCaseResultList & results) {
+
+		std::cout << std::left << std::setw(20) << "Engine"
+			<< std::right << std::setw(10) << "Cases"
+			<< std::setw(12) << "Mismatches"
+			<< std::setw(16) << "Reference (s)"
+			<< std::setw(16) << "Optimized (s)"
+			<< std::setw(10) << "Speedup" << "\n";
+
+		for (const OracleCaseResult & result : results) {
+
+			std::cout << std::left << std::setw(20) << result.engine
+				<< std::right << std::setw(10) << result.cases
+				<< std::setw(12) << result.mismatches
+				<< std::fixed << std::setprecision(4)
+				<< std::setw(16) << result.reference_seconds
+				<< std::setw(16) << result.optimized_seconds
+				<< std::setprecision(2)
+				<< std::setw(9) << result.Speedup() << "x\n";
+
+			std::cout.unsetf(std::ios::fixed);
+
+		}
+
+	}
+
+	// =========================================================================
+	// Generates schemas and checks every engine on each of them.
+	// =========================================================================
+	OracleCaseResultList DifferentialOracle::Run(std::size_t num_schemas) {
+
+		OracleCaseResultList results(10);
+
+		results[0].engine = "closure";
+		results[1].engine = "batch closure";
+		results[2].engine = "global closure";
+		results[3].engine = "candidate key";
+		results[4].engine = "minimum key";
+		results[5].engine = "prime attributes";
+		results[6].engine = "2nf";
+		results[7].engine = "static schema";
+		results[8].engine = "components";
+		results[9].engine = "4nf";
+
+		for (std::size_t i = 0; i < num_schemas; i++) {
+
+			Database db = GenerateSchema();
+			Database baseline = db;
+			Database fourth = db;
+
+			CheckClosure(db, results[0]);
+			CheckBatchClosure(db, results[1]);
+			CheckGlobalClosure(db, results[2]);
+			CheckCandidateKey(db, results[3]);
+			CheckMinimumKey(db, results[4]);
+			CheckPrimeAttributes(db, results[5]);
+			CheckDecomposition(db, baseline, results[6]);
+			CheckStaticSchema(results[7]);
+			CheckComponents(results[8]);
+			CheckFourthNormalForm(fourth, results[9]);
+
+		}
+
+		return results;
+
+	}
+
+}
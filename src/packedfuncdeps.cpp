@@ -0,0 +1,197 @@
+#include "packedfuncdeps.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Returns the number of attributes in a packed set.
+	// =========================================================================
+	std::size_t CountPackedAttributes(const PackedAttributeSet & packed) {
+
+		std::size_t count = 0;
+
+		for (std::uint64_t word : packed)
+			count += static_cast<std::size_t>(__builtin_popcountll(word));
+
+		return count;
+
+	}
+
+	// =========================================================================
+	// Removes an attribute from a packed set.
+	// =========================================================================
+	void ErasePackedAttribute(PackedAttributeSet & packed, AttributeTblIndex attr) {
+
+		packed[attr / 64] &= ~(std::uint64_t(1) << (attr % 64));
+
+	}
+
+	// =========================================================================
+	// Returns whether a packed set contains an attribute.
+	// =========================================================================
+	bool HasPackedAttribute(const PackedAttributeSet & packed, AttributeTblIndex attr) {
+
+		return (packed[attr / 64] >> (attr % 64)) & 1;
+
+	}
+
+	// =========================================================================
+	// Adds an attribute to a packed set.
+	// =========================================================================
+	void InsertPackedAttribute(PackedAttributeSet & packed, AttributeTblIndex attr) {
+
+		packed[attr / 64] |= std::uint64_t(1) << (attr % 64);
+
+	}
+
+	// =========================================================================
+	// Packs a set of attributes.
+	// =========================================================================
+	PackedAttributeSet PackAttributes(const AttributeSet & attribute_set,
+		std::size_t num_words) {
+
+		PackedAttributeSet packed(num_words, 0);
+
+		for (AttributeTblIndex attr : attribute_set)
+			InsertPackedAttribute(packed, attr);
+
+		return packed;
+
+	}
+
+	// =========================================================================
+	// Unpacks a packed set of attributes.
+	// =========================================================================
+	AttributeSet UnpackAttributes(const PackedAttributeSet & packed) {
+
+		AttributeSet attribute_set;
+
+		for (std::size_t w = 0; w < packed.size(); w++) {
+
+			for (std::uint64_t word = packed[w]; word != 0; word &= word - 1) {
+
+				attribute_set.insert(static_cast<AttributeTblIndex>(w * 64
+					+ static_cast<std::size_t>(__builtin_ctzll(word))));
+
+			}
+
+		}
+
+		return attribute_set;
+
+	}
+
+	// =========================================================================
+	// Constructs a PackedFuncDepTable by packing every functional dependency
+	// and recording which attributes appear on a lhs or a rhs.
+	// =========================================================================
+	PackedFuncDepTable::PackedFuncDepTable(const FuncDepTable & func_dep_table,
+		std::size_t _num_attributes)
+		: num_attributes(_num_attributes), num_func_deps(func_dep_table.size()),
+		num_words((_num_attributes + 63) / 64) {
+
+		in_lhs.assign(num_words, 0);
+		in_rhs.assign(num_words, 0);
+		offsets.reserve(2 * num_func_deps + 1);
+
+		for (const FuncDep & func_dep : func_dep_table) {
+			AppendWords(func_dep.first, in_lhs);
+			AppendWords(func_dep.second, in_rhs);
+		}
+
+		offsets.push_back(words.size());
+		words.shrink_to_fit();
+
+		universe.assign(num_words, ~std::uint64_t(0));
+
+		if (num_attributes % 64 != 0)
+			universe.back() = (std::uint64_t(1) << (num_attributes % 64)) - 1;
+
+	}
+
+	// =========================================================================
+	// Appends the nonzero words of a lhs or rhs to "words" and records where
+	// they start.
+	//
+	// "attribute_set":
+	//		Lhs or rhs to pack. Iterated in ascending order, so the
+	//		attributes of one word are consecutive.
+	//
+	// "in_side":
+	//		in_lhs or in_rhs, to which the attributes are added.
+	// =========================================================================
+	void PackedFuncDepTable::AppendWords(const AttributeSet & attribute_set,
+		PackedAttributeSet & in_side) {
+
+		std::size_t first = words.size();
+
+		offsets.push_back(first);
+
+		for (AttributeTblIndex attr : attribute_set) {
+
+			std::size_t index = attr / 64;
+
+			if (words.size() == first || words.back().index != index)
+				words.push_back({ index, 0 });
+
+			words.back().bits |= std::uint64_t(1) << (attr % 64);
+			InsertPackedAttribute(in_side, attr);
+
+		}
+
+	}
+
+	// =========================================================================
+	// Computes the closure of a packed set of attributes: fires every
+	// functional dependency not fired yet until no attribute is added.
+	// =========================================================================
+	PackedAttributeSet PackedFuncDepTable::ComputeClosureOf(const
+		PackedAttributeSet & attributes) const {
+
+		PackedAttributeSet closure = attributes;
+		std::vector<char> fired(num_func_deps, 0);
+		bool new_insertion;
+
+		do {
+
+			new_insertion = false;
+
+			for (std::size_t i = 0; i < num_func_deps; i++) {
+
+				if (!fired[i])
+					fired[i] = Fire(i, closure, new_insertion);
+
+			}
+
+		} while (new_insertion);
+
+		return closure;
+
+	}
+
+	// =========================================================================
+	// Fires a functional dependency on a closure being computed.
+	// =========================================================================
+	bool PackedFuncDepTable::Fire(std::size_t fd_tbl_index,
+		PackedAttributeSet & closure, bool & new_insertion) const {
+
+		const PackedWord * lhs = words.data() + offsets[2 * fd_tbl_index];
+		const PackedWord * rhs = words.data() + offsets[2 * fd_tbl_index + 1];
+		const PackedWord * end = words.data() + offsets[2 * fd_tbl_index + 2];
+
+		for (const PackedWord * word = lhs; word != rhs; word++) {
+
+			if ((word->bits & ~closure[word->index]) != 0)
+				return false;
+
+		}
+
+		for (const PackedWord * word = rhs; word != end; word++) {
+			new_insertion = new_insertion || (word->bits & ~closure[word->index]) != 0;
+			closure[word->index] |= word->bits;
+		}
+
+		return true;
+
+	}
+
+}
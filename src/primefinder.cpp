@@ -0,0 +1,273 @@
+#include "primefinder.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a PrimeAttributeFinder by classifying the attributes.
+	// =========================================================================
+	PrimeAttributeFinder::PrimeAttributeFinder(const PackedFuncDepTable &
+		_func_deps, std::size_t _search_budget, StopPredicate _should_stop)
+		: budget_exhausted(false), closures_computed(0), func_deps(_func_deps),
+		search_budget(_search_budget), should_stop(std::move(_should_stop)),
+		stopped(false) {
+
+		const PackedAttributeSet & in_lhs = func_deps.GetInLhs();
+		const PackedAttributeSet & in_rhs = func_deps.GetInRhs();
+		const PackedAttributeSet & universe = func_deps.GetUniverse();
+
+		core.assign(func_deps.GetNumWords(), 0);
+
+		for (std::size_t w = 0; w < core.size(); w++)
+			core[w] = universe[w] & ~in_rhs[w];
+
+		for (AttributeTblIndex attr = 0; attr < func_deps.GetNumAttributes(); attr++) {
+
+			if (HasPackedAttribute(in_lhs, attr) && HasPackedAttribute(in_rhs, attr))
+				both_sides.push_back(attr);
+
+		}
+
+	}
+
+	// =========================================================================
+	// Computes the closure of a packed set of attributes, counting it
+	// against the search budget.
+	// =========================================================================
+	PackedAttributeSet PrimeAttributeFinder::ComputeClosureOf(const
+		PackedAttributeSet & attributes) {
+
+		closures_computed++;
+		return func_deps.ComputeClosureOf(attributes);
+
+	}
+
+	// =========================================================================
+	// Determines the prime attributes.
+	// =========================================================================
+	std::vector<char> PrimeAttributeFinder::Find() {
+
+		budget_exhausted = false;
+		closures_computed = 0;
+		keys.clear();
+		stopped = false;
+		prime.assign(func_deps.GetNumAttributes(), 0);
+
+		for (AttributeTblIndex attr = 0; attr < func_deps.GetNumAttributes(); attr++) {
+
+			// Attributes never on a rhs are in every candidate key.
+
+			if (HasPackedAttribute(core, attr))
+				prime[attr] = 1;
+
+		}
+
+		// Greedy pass: reduce core + both-sides attributes to a candidate
+		// key, trying to remove the attribute last. Each pass yields a
+		// candidate key and usually proves several attributes at once.
+		for (AttributeTblIndex attr : both_sides) {
+
+			if (prime[attr])
+				continue;
+
+			if (OutOfBudget())
+				break;
+
+			PackedAttributeSet key = core;
+
+			for (AttributeTblIndex other : both_sides)
+				InsertPackedAttribute(key, other);
+
+			if (!ReduceToKey(key, attr))
+				break;
+
+			MarkKey(key);
+
+		}
+
+		// Exhaustive pass for attributes the greedy pass did not prove.
+		for (AttributeTblIndex attr : both_sides) {
+
+			if (prime[attr])
+				continue;
+
+			PackedAttributeSet x = core;
+
+			if (!SearchWitness(x, 0, attr) && (budget_exhausted || stopped))
+				prime[attr] = 1;	// Unresolved, so assume prime.
+
+		}
+
+		return prime;
+
+	}
+
+	// =========================================================================
+	// Returns whether a packed set of attributes functionally determines all
+	// attributes.
+	// =========================================================================
+	bool PrimeAttributeFinder::IsSuperkey(const PackedAttributeSet & attributes) {
+
+		return ComputeClosureOf(attributes) == func_deps.GetUniverse();
+
+	}
+
+	// =========================================================================
+	// Marks every attribute of a candidate key as prime.
+	// =========================================================================
+	void PrimeAttributeFinder::MarkKey(const PackedAttributeSet & key) {
+
+		keys.insert(key);
+
+		for (AttributeTblIndex attr = 0; attr < func_deps.GetNumAttributes(); attr++) {
+
+			if (HasPackedAttribute(key, attr))
+				prime[attr] = 1;
+
+		}
+
+	}
+
+	// =========================================================================
+	// Returns whether the search has to stop, recording whether the budget
+	// ran out or the stop predicate stopped it.
+	// =========================================================================
+	bool PrimeAttributeFinder::OutOfBudget() {
+
+		if (closures_computed >= search_budget)
+			budget_exhausted = true;
+		else if (!stopped && should_stop && should_stop())
+			stopped = true;
+
+		return budget_exhausted || stopped;
+
+	}
+
+	// =========================================================================
+	// Greedily reduces a superkey to a candidate key. Core attributes are in
+	// every candidate key, so only both-sides attributes are tried. The stop
+	// predicate is checked before every closure, but the search budget does
+	// not count them.
+	//
+	// "key":
+	//		Superkey to reduce in place.
+	//
+	// "last":
+	//		Attribute that is tried last, so that it stays in the candidate
+	//		key whenever the other attributes allow it.
+	//
+	// Returns false if the stop predicate stopped the reduction, in which
+	// case "key" is a superkey that may not be minimal.
+	// =========================================================================
+	bool PrimeAttributeFinder::ReduceToKey(PackedAttributeSet & key,
+		AttributeTblIndex last) {
+
+		auto stop = [this]() {
+
+			if (!stopped && should_stop && should_stop())
+				stopped = true;
+
+			return stopped;
+
+		};
+
+		for (AttributeTblIndex attr : both_sides) {
+
+			if (attr == last || !HasPackedAttribute(key, attr))
+				continue;
+
+			if (stop())
+				return false;
+
+			ErasePackedAttribute(key, attr);
+
+			if (!IsSuperkey(key))
+				InsertPackedAttribute(key, attr);
+
+		}
+
+		if (HasPackedAttribute(key, last)) {
+
+			if (stop())
+				return false;
+
+			ErasePackedAttribute(key, last);
+
+			if (!IsSuperkey(key))
+				InsertPackedAttribute(key, last);
+
+		}
+
+		return true;
+
+	}
+
+	// =========================================================================
+	// Searches for a set X, grown from "x" with both-sides attributes at
+	// index "next" or later, such that X is not a superkey while X + "attr"
+	// is. The branch below X is pruned when the closure of X contains
+	// "attr" (X + "attr" has the same closure as X), and attributes already
+	// in the closure of X are never added (the closure would not change).
+	//
+	// "x":
+	//		Current set X, restored before returning.
+	//
+	// "next":
+	//		Index into "both_sides" of the first attribute that may be
+	//		added.
+	//
+	// "attr":
+	//		Attribute being proven prime.
+	//
+	// Returns true if "attr" was proven prime, in which case the candidate
+	// key found is marked.
+	// =========================================================================
+	bool PrimeAttributeFinder::SearchWitness(PackedAttributeSet & x,
+		std::size_t next, AttributeTblIndex attr) {
+
+		if (OutOfBudget())
+			return false;
+
+		PackedAttributeSet closure = ComputeClosureOf(x);
+
+		if (HasPackedAttribute(closure, attr))
+			return false;	// Also covers X being a superkey.
+
+		PackedAttributeSet key = x;
+		InsertPackedAttribute(key, attr);
+
+		if (IsSuperkey(key)) {
+
+			// Every candidate key inside X + attr contains attr, because
+			// X is not a superkey, so "attr" is prime even if the
+			// reduction stops.
+
+			if (ReduceToKey(key, attr))
+				MarkKey(key);
+			else
+				prime[attr] = 1;
+
+			return true;
+
+		}
+
+		for (std::size_t i = next; i < both_sides.size(); i++) {
+
+			AttributeTblIndex other = both_sides[i];
+
+			if (other == attr || HasPackedAttribute(closure, other))
+				continue;
+
+			InsertPackedAttribute(x, other);
+			bool found = SearchWitness(x, i + 1, attr);
+			ErasePackedAttribute(x, other);
+
+			if (found || budget_exhausted || stopped)
+				return found;
+
+		}
+
+		return false;
+
+	}
+
+}
@@ -0,0 +1,104 @@
+#include <stdexcept>
+
+#include "relationstream.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a RelationStream. Nothing is normalized until the first
+	// call to Next().
+	// =========================================================================
+	RelationStream::RelationStream(Database & _db, NormalForm _target)
+		: db(_db), kept_index(0), peak_queue_size(0), started(false),
+		target(_target) {
+
+		if (target != NormalForm::Two && target != NormalForm::Four)
+			throw std::invalid_argument("Relations can only be streamed in 2NF or 4NF!");
+
+	}
+
+	// =========================================================================
+	// Normalizes until the next relation is final.
+	// =========================================================================
+	bool RelationStream::Next(Relation & relation) {
+
+		if (!started)
+			Start();
+
+		if (db.normal_form >= target) {
+
+			if (kept_index == db.relation_table.size())
+				return false;
+
+			relation = db.relation_table[kept_index++];
+
+			return true;
+
+		}
+
+		Database::RelationStep relation_step = target == NormalForm::Two
+			? &Database::RelationTo2nf : &Database::RelationTo4nf;
+
+		while (!normalization_queue.empty()) {
+
+			Relation next = std::move(normalization_queue.front());
+			normalization_queue.pop();
+
+			if (db.tracer)
+				db.tracer->Instant("pop", "queue", "size", normalization_queue.size());
+
+			RelationTable decomposed_relations = (db.*relation_step)(next);
+
+			if (decomposed_relations.size() < 1)
+				throw std::runtime_error("Internal error. Normalization should never return 0 decomposed relations.");
+
+			if (decomposed_relations.size() == 1) {
+
+				db.NameRelation(decomposed_relations.front());
+				relation = std::move(decomposed_relations.front());
+
+				return true;
+
+			}
+
+			for (Relation & decomposed_relation : decomposed_relations)
+				normalization_queue.push(std::move(decomposed_relation));
+
+			if (normalization_queue.size() > peak_queue_size)
+				peak_queue_size = normalization_queue.size();
+
+			if (db.tracer)
+				db.tracer->Instant("push", "queue", "size", normalization_queue.size());
+
+		}
+
+		return false;
+
+	}
+
+	// =========================================================================
+	// Fills the queue the way NormalizeTo2nf() and NormalizeTo4nf() do: with
+	// the relations of an earlier run that stopped early, or else with the
+	// global relation.
+	// =========================================================================
+	void RelationStream::Start() {
+
+		started = true;
+
+		if (db.normal_form >= target)
+			return;
+
+		TraceScope trace(db.tracer, "RelationStream", "phase");
+
+		if (db.relation_table.empty())
+			db.relation_table.push_back(db.GenerateGlobalRelation());
+
+		if (target == NormalForm::Two)
+			db.MarkPrimeAttributes();
+
+		db.QueuePreNormalizedRelations(normalization_queue);
+		peak_queue_size = normalization_queue.size();
+
+	}
+
+}
@@ -0,0 +1,499 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "resultcache.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// First line of every cache entry. Changing the entry format must change
+	// the version so that old entries are treated as misses.
+	// =========================================================================
+	static const std::string CACHE_ENTRY_MAGIC = "DBNORMALIZER_CACHE 1";
+
+	// =========================================================================
+	// Number of temporary entry files this process created.
+	// =========================================================================
+	static std::atomic<unsigned long long> temp_counter(0);
+
+	// =========================================================================
+	// Returns the id of this process.
+	// =========================================================================
+	static long ProcessId() {
+
+#ifdef _WIN32
+		return static_cast<long>(_getpid());
+#else
+		return static_cast<long>(getpid());
+#endif
+
+	}
+
+	// =========================================================================
+	// Returns a random number drawn once per process, which tells apart
+	// processes that reuse a pid, e.g., in different containers sharing the
+	// cache directory.
+	// =========================================================================
+	static unsigned long long TempNonce() {
+
+		static const unsigned long long nonce = []() {
+
+			std::random_device device;
+
+			return (static_cast<unsigned long long>(device()) << 32) | device();
+
+		}();
+
+		return nonce;
+
+	}
+
+	// =========================================================================
+	// Constructs a ResultCache.
+	//
+	// "_directory":
+	//		Cache directory. Created if it does not exist.
+	// =========================================================================
+	ResultCache::ResultCache(const std::string & _directory)
+		: directory(_directory) {
+
+		std::filesystem::create_directories(directory);
+
+	}
+
+	// =========================================================================
+	// Computes the canonical form of a Database's schema.
+	//
+	// "db":
+	//		Database to canonicalize.
+	//
+	// Returns the canonical schema of "db".
+	// =========================================================================
+	ResultCache::CanonicalSchema ResultCache::Canonicalize(const Database & db) {
+
+		CanonicalSchema schema;
+		const AttributeTable & attribute_table = db.attribute_table;
+
+		// Rank attributes by name.
+		for (AttributeTblIndex i = 0; i < attribute_table.size(); i++)
+			schema.attributes.push_back(i);
+
+		std::stable_sort(schema.attributes.begin(), schema.attributes.end(),
+			[&](AttributeTblIndex a, AttributeTblIndex b) {
+				return attribute_table[a].name < attribute_table[b].name;
+			});
+
+		schema.ranks.resize(attribute_table.size());
+
+		for (AttributeTblIndex rank = 0; rank < schema.attributes.size(); rank++)
+			schema.ranks[schema.attributes[rank]] = rank;
+
+		// Dependencies are written with attribute ranks in ascending order.
+		auto dependency_text = [&](const Lhs & lhs, const Rhs & rhs) {
+
+			std::string text;
+
+			for (const AttributeSet * side : { &lhs, &rhs }) {
+
+				std::vector<AttributeTblIndex> ranks;
+
+				for (AttributeTblIndex attr : *side)
+					ranks.push_back(schema.ranks[attr]);
+
+				std::sort(ranks.begin(), ranks.end());
+
+				for (AttributeTblIndex rank : ranks)
+					text += std::to_string(rank) + ",";
+
+				text += side == &lhs ? ">" : "";
+
+			}
+
+			return text;
+
+		};
+
+		std::vector<std::string> func_dep_texts;
+
+		for (const FuncDep & func_dep : db.func_dep_table) {
+			func_dep_texts.push_back(dependency_text(func_dep.first, func_dep.second));
+			schema.func_deps.push_back(static_cast<FuncDepTblIndex>(schema.func_deps.size()));
+		}
+
+		std::stable_sort(schema.func_deps.begin(), schema.func_deps.end(),
+			[&](FuncDepTblIndex a, FuncDepTblIndex b) {
+				return func_dep_texts[a] < func_dep_texts[b];
+			});
+
+		schema.func_dep_ranks.resize(schema.func_deps.size());
+
+		for (FuncDepTblIndex rank = 0; rank < schema.func_deps.size(); rank++)
+			schema.func_dep_ranks[schema.func_deps[rank]] = rank;
+
+		std::vector<std::string> mvd_texts;
+
+		for (const MultiValuedDep & mvd : db.mvd_table)
+			mvd_texts.push_back(dependency_text(mvd.first, mvd.second));
+
+		std::sort(mvd_texts.begin(), mvd_texts.end());
+
+		// Names are length-prefixed so that any character may appear in 
+		// them.
+		std::ostringstream text;
+
+		text << "attributes\n";
+
+		for (AttributeTblIndex attr : schema.attributes) {
+			text << attribute_table[attr].name.size() << ":" 
+				<< attribute_table[attr].name << "\n";
+		}
+
+		text << "func_deps\n";
+
+		for (FuncDepTblIndex i : schema.func_deps)
+			text << func_dep_texts[i] << "\n";
+
+		text << "mvds\n";
+
+		for (const std::string & mvd_text : mvd_texts)
+			text << mvd_text << "\n";
+
+		schema.text = text.str();
+
+		return schema;
+
+	}
+
+	// =========================================================================
+	// Computes the canonical schema hash of a Database.
+	// =========================================================================
+	std::uint64_t ResultCache::ComputeSchemaHash(const Database & db) {
+
+		return HashText(Canonicalize(db).text);
+
+	}
+
+	// =========================================================================
+	// Returns the path of the cache entry for a schema and normal form.
+	// =========================================================================
+	std::string ResultCache::EntryPath(const CanonicalSchema & schema,
+		NormalForm normal_form) {
+
+		std::ostringstream file_name;
+
+		file_name << std::hex << std::setw(16) << std::setfill('0') 
+			<< HashText(schema.text) << "-nf" << std::dec 
+			<< static_cast<int>(normal_form) << ".dbc";
+
+		return (std::filesystem::path(directory) / file_name.str()).string();
+
+	}
+
+	// =========================================================================
+	// Computes the 64-bit FNV-1a hash of a string.
+	// =========================================================================
+	std::uint64_t ResultCache::HashText(const std::string & text) {
+
+		std::uint64_t hash = 14695981039346656037ULL;
+
+		for (unsigned char c : text) {
+			hash ^= c;
+			hash *= 1099511628211ULL;
+		}
+
+		return hash;
+
+	}
+
+	// =========================================================================
+	// Loads the cache entry for a schema and normal form into a Database.
+	//
+	// "db":
+	//		Database to load the normalization results into.
+	//
+	// "schema":
+	//		Canonical schema of "db".
+	//
+	// "normal_form":
+	//		Normal form of the entry to load.
+	//
+	// Returns true if a valid entry was found and loaded. A missing, 
+	// corrupted, or colliding entry is a miss and leaves "db" unchanged.
+	// =========================================================================
+	bool ResultCache::Load(Database & db, const CanonicalSchema & schema,
+		NormalForm normal_form) {
+
+		std::ifstream entry(EntryPath(schema, normal_form), std::ios::binary);
+
+		if (!entry.is_open())
+			return false;
+
+		std::string magic;
+		std::getline(entry, magic);
+
+		if (magic != CACHE_ENTRY_MAGIC)
+			return false;
+
+		std::size_t text_size;
+
+		if (!(entry >> text_size) || entry.get() != '\n')
+			return false;
+
+		std::string text(text_size, '\0');
+
+		// Guards against hash collisions.
+		if (!entry.read(&text[0], text_size) || text != schema.text)
+			return false;
+
+		int stored_normal_form;
+
+		if (!(entry >> stored_normal_form) || stored_normal_form != normal_form)
+			return false;
+
+		std::size_t num_attributes = schema.attributes.size();
+		std::size_t num_func_deps = schema.func_deps.size();
+		bool valid = true;
+
+		// Reads a count followed by that many ranks, mapping every rank 
+		// back to an index of "db".
+		auto read_set = [&](AttributeSet & attribute_set) {
+
+			std::size_t count = 0;
+			valid = valid && (entry >> count);
+
+			for (std::size_t i = 0; valid && i < count; i++) {
+
+				AttributeTblIndex rank;
+				valid = (entry >> rank) && rank < num_attributes;
+
+				if (valid)
+					attribute_set.insert(schema.attributes[rank]);
+
+			}
+
+		};
+
+		AttributeSet prime_attributes;
+		read_set(prime_attributes);
+
+		std::size_t num_relations = 0;
+		valid = valid && (entry >> num_relations);
+
+		RelationTable relation_table;
+
+		for (std::size_t r = 0; valid && r < num_relations; r++) {
+
+			Relation relation;
+			std::size_t name_size = 0;
+
+			valid = (entry >> name_size) && entry.get() == ' ';
+
+			if (!valid)
+				break;
+
+			relation.name.resize(name_size);
+
+			if (name_size > 0)
+				valid = static_cast<bool>(entry.read(&relation.name[0], name_size));
+
+			read_set(relation.attributes);
+			read_set(relation.primary_key);
+
+			std::size_t num_candidate_keys = 0;
+			valid = valid && (entry >> num_candidate_keys);
+
+			for (std::size_t k = 0; valid && k < num_candidate_keys; k++) {
+				relation.candidate_keys.push_back(CandidateKey());
+				read_set(relation.candidate_keys.back());
+			}
+
+			std::size_t num_closures = 0;
+			valid = valid && (entry >> num_closures);
+
+			for (std::size_t c = 0; valid && c < num_closures; c++) {
+
+				FuncDepTblIndex rank;
+				valid = (entry >> rank) && rank < num_func_deps;
+
+				if (!valid)
+					break;
+
+				Rhs closure_rhs;
+				read_set(closure_rhs);
+				relation.closure.push_back(std::make_pair(schema.func_deps[rank], closure_rhs));
+
+			}
+
+			relation_table.push_back(relation);
+
+		}
+
+		if (!valid)
+			return false;
+
+		for (AttributeTblIndex i = 0; i < db.attribute_table.size(); i++)
+			db.attribute_table[i].prime = prime_attributes.find(i) != prime_attributes.end();
+
+		db.relation_table = relation_table;
+		db.relation_num = static_cast<unsigned int>(relation_table.size()) + 1;
+		db.normal_form = normal_form;
+
+		return true;
+
+	}
+
+	// =========================================================================
+	// Normalizes a Database, loading the result from the cache if possible.
+	// =========================================================================
+	bool ResultCache::Normalize(Database & db, NormalForm normal_form,
+		unsigned int max_threads) {
+
+		// NormalizeTo3nf() is a stub, so a 3NF result must not be cached.
+		if (normal_form != NormalForm::Two && normal_form != NormalForm::Four)
+			throw std::invalid_argument("The result cache can only normalize to 2NF or 4NF!");
+
+		CanonicalSchema schema = Canonicalize(db);
+
+		if (Load(db, schema, normal_form)) {
+			hits++;
+			return true;
+		}
+
+		misses++;
+
+		switch (normal_form) {
+		case NormalForm::Two:
+			db.NormalizeTo2nf(max_threads);
+			break;
+		default:
+			db.NormalizeTo4nf(max_threads);
+			break;
+		}
+
+		Store(db, schema, normal_form);
+
+		return false;
+
+	}
+
+	// =========================================================================
+	// Prints the number of cache hits and misses.
+	// =========================================================================
+	void ResultCache::PrintStats() {
+
+		std::cout << "Result cache: " << hits << " hit(s), " << misses 
+			<< " miss(es)\n";
+
+	}
+
+	// =========================================================================
+	// Stores the normalization results of a Database in the cache. The entry
+	// is written to a temporary file that is then renamed over the entry, so
+	// readers never see a partially written entry. The temporary file's
+	// name holds the process id, a per-process counter and a random number,
+	// so that no two writers, in the same process or not, share it.
+	//
+	// "db":
+	//		Normalized database whose results are stored.
+	//
+	// "schema":
+	//		Canonical schema of "db".
+	//
+	// "normal_form":
+	//		Normal form "db" was normalized to.
+	// =========================================================================
+	void ResultCache::Store(const Database & db, const CanonicalSchema & schema,
+		NormalForm normal_form) {
+
+		std::string path = EntryPath(schema, normal_form);
+		std::ostringstream temp_suffix;
+
+		temp_suffix << ".tmp" << ProcessId() << "." << temp_counter++ << "."
+			<< std::hex << TempNonce();
+
+		std::string temp_path = path + temp_suffix.str();
+
+		{
+
+			std::ofstream entry(temp_path, std::ios::binary | std::ios::trunc);
+
+			auto write_set = [&](const AttributeSet & attribute_set) {
+
+				std::vector<AttributeTblIndex> ranks;
+
+				for (AttributeTblIndex attr : attribute_set)
+					ranks.push_back(schema.ranks[attr]);
+
+				std::sort(ranks.begin(), ranks.end());
+
+				entry << ranks.size();
+
+				for (AttributeTblIndex rank : ranks)
+					entry << " " << rank;
+
+				entry << "\n";
+
+			};
+
+			entry << CACHE_ENTRY_MAGIC << "\n" << schema.text.size() << "\n" 
+				<< schema.text << static_cast<int>(normal_form) << "\n";
+
+			AttributeSet prime_attributes;
+
+			for (AttributeTblIndex i = 0; i < db.attribute_table.size(); i++) {
+
+				if (db.attribute_table[i].prime)
+					prime_attributes.insert(i);
+
+			}
+
+			write_set(prime_attributes);
+
+			entry << db.relation_table.size() << "\n";
+
+			for (const Relation & relation : db.relation_table) {
+
+				entry << relation.name.size() << " " << relation.name << "\n";
+				write_set(relation.attributes);
+				write_set(relation.primary_key);
+
+				entry << relation.candidate_keys.size() << "\n";
+
+				for (const CandidateKey & candidate_key : relation.candidate_keys)
+					write_set(candidate_key);
+
+				entry << relation.closure.size() << "\n";
+
+				for (const AttributeSetClosure & closure : relation.closure) {
+					entry << schema.func_dep_ranks[closure.first] << " ";
+					write_set(closure.second);
+				}
+
+			}
+
+			if (!entry.flush()) {
+				entry.close();
+				std::filesystem::remove(temp_path);
+				throw std::runtime_error("Could not write cache entry '" + temp_path + "'!");
+			}
+
+		}
+
+		std::filesystem::rename(temp_path, path);
+
+	}
+
+}
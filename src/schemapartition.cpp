@@ -0,0 +1,166 @@
+#include <limits>
+#include <utility>
+
+#include "schemapartition.h"
+
+namespace DbNormalizerCpp {
+
+	const std::size_t SchemaPartition::NO_COMPONENT =
+		std::numeric_limits<std::size_t>::max();
+
+	// =========================================================================
+	// Constructs a SchemaPartition by uniting the attributes of every
+	// dependency and numbering the resulting sets.
+	// =========================================================================
+	SchemaPartition::SchemaPartition(std::size_t num_attributes,
+		const FuncDepTable & func_dep_table,
+		const MultiValuedDepTable & mvd_table)
+		: component_of(num_attributes, NO_COMPONENT), parent(num_attributes),
+		size(num_attributes, 1) {
+
+		std::vector<char> in_dependency(num_attributes, 0);
+
+		for (AttributeTblIndex attr = 0; attr < num_attributes; attr++)
+			parent[attr] = attr;
+
+		for (const FuncDep & func_dep : func_dep_table)
+			UniteDependency(func_dep);
+
+		for (const MultiValuedDep & mvd : mvd_table)
+			UniteDependency(mvd);
+
+		for (const FuncDep & func_dep : func_dep_table) {
+
+			for (AttributeTblIndex attr : func_dep.first)
+				in_dependency[attr] = 1;
+
+			for (AttributeTblIndex attr : func_dep.second)
+				in_dependency[attr] = 1;
+
+		}
+
+		for (const MultiValuedDep & mvd : mvd_table) {
+
+			for (AttributeTblIndex attr : mvd.first)
+				in_dependency[attr] = 1;
+
+			for (AttributeTblIndex attr : mvd.second)
+				in_dependency[attr] = 1;
+
+		}
+
+		// Number the components in ascending order of their smallest
+		// attribute. Attributes are visited in ascending order, so every
+		// component's attributes end up sorted.
+		std::vector<std::size_t> component_of_root(num_attributes, NO_COMPONENT);
+
+		for (AttributeTblIndex attr = 0; attr < num_attributes; attr++) {
+
+			if (!in_dependency[attr]) {
+				isolated.push_back(attr);
+				continue;
+			}
+
+			AttributeTblIndex root = Find(attr);
+
+			if (component_of_root[root] == NO_COMPONENT) {
+				component_of_root[root] = components.size();
+				components.emplace_back();
+			}
+
+			component_of[attr] = component_of_root[root];
+			components[component_of[attr]].push_back(attr);
+
+		}
+
+		func_deps.resize(components.size());
+		mvds.resize(components.size());
+
+		// A dependency lies in the component of any of its attributes.
+		for (FuncDepTblIndex i = 0; i < func_dep_table.size(); i++) {
+
+			const FuncDep & func_dep = func_dep_table[i];
+
+			if (func_dep.first.empty() && func_dep.second.empty())
+				continue;
+
+			AttributeTblIndex attr = func_dep.first.empty()
+				? *func_dep.second.begin() : *func_dep.first.begin();
+
+			func_deps[component_of[attr]].push_back(i);
+
+		}
+
+		for (MultiValuedDepTblIndex i = 0; i < mvd_table.size(); i++) {
+
+			const MultiValuedDep & mvd = mvd_table[i];
+
+			if (mvd.first.empty() && mvd.second.empty())
+				continue;
+
+			AttributeTblIndex attr = mvd.first.empty()
+				? *mvd.second.begin() : *mvd.first.begin();
+
+			mvds[component_of[attr]].push_back(i);
+
+		}
+
+	}
+
+	// =========================================================================
+	// Returns the root of the set that contains an attribute. Halves the
+	// path along the way.
+	// =========================================================================
+	AttributeTblIndex SchemaPartition::Find(AttributeTblIndex attr) {
+
+		while (parent[attr] != attr) {
+			parent[attr] = parent[parent[attr]];
+			attr = parent[attr];
+		}
+
+		return attr;
+
+	}
+
+	// =========================================================================
+	// Unites the sets that contain two attributes. The smaller set is
+	// attached to the larger one.
+	// =========================================================================
+	void SchemaPartition::Unite(AttributeTblIndex a, AttributeTblIndex b) {
+
+		a = Find(a);
+		b = Find(b);
+
+		if (a == b)
+			return;
+
+		if (size[a] < size[b])
+			std::swap(a, b);
+
+		parent[b] = a;
+		size[a] += size[b];
+
+	}
+
+	// =========================================================================
+	// Unites every attribute of a dependency with its first attribute.
+	// =========================================================================
+	void SchemaPartition::UniteDependency(const std::pair<Lhs, Rhs> & dependency) {
+
+		const Lhs & lhs = dependency.first;
+		const Rhs & rhs = dependency.second;
+
+		if (lhs.empty() && rhs.empty())
+			return;
+
+		AttributeTblIndex first = lhs.empty() ? *rhs.begin() : *lhs.begin();
+
+		for (AttributeTblIndex attr : lhs)
+			Unite(first, attr);
+
+		for (AttributeTblIndex attr : rhs)
+			Unite(first, attr);
+
+	}
+
+}
@@ -0,0 +1,553 @@
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "server.h"
+#include "txtparser.h"
+
+namespace DbNormalizerCpp {
+
+#ifndef _WIN32
+
+	// =========================================================================
+	// Stream buffer over a connected socket, so that a socket session is
+	// served by the same code as a stdin/stdout session. Reading and
+	// writing use separate buffers and may happen on different threads.
+	// =========================================================================
+	class SocketStreamBuf : public std::streambuf {
+
+	public:
+
+		explicit SocketStreamBuf(int _fd) : fd(_fd) {
+			setg(input, input, input);
+			setp(output, output + sizeof(output));
+		};
+
+		~SocketStreamBuf() { sync(); };
+
+	protected:
+
+		int_type overflow(int_type c) override {
+
+			if (Flush() < 0)
+				return traits_type::eof();
+
+			if (!traits_type::eq_int_type(c, traits_type::eof())) {
+				*pptr() = traits_type::to_char_type(c);
+				pbump(1);
+			}
+
+			return traits_type::not_eof(c);
+
+		};
+
+		int sync() override { return Flush(); };
+
+		int_type underflow() override {
+
+			ssize_t n;
+
+			do {
+				n = ::recv(fd, input, sizeof(input), 0);
+			} while (n < 0 && errno == EINTR);
+
+			if (n <= 0)
+				return traits_type::eof();
+
+			setg(input, input, input + n);
+
+			return traits_type::to_int_type(*gptr());
+
+		};
+
+	private:
+
+		// Writes the put area. A peer that has gone away fails the write
+		// instead of raising SIGPIPE.
+		int Flush() {
+
+			for (char * next = pbase(); next < pptr(); ) {
+
+				ssize_t n = ::send(fd, next, pptr() - next, MSG_NOSIGNAL);
+
+				if (n < 0 && errno == EINTR)
+					continue;
+
+				if (n < 0)
+					return -1;
+
+				next += n;
+
+			}
+
+			setp(output, output + sizeof(output));
+
+			return 0;
+
+		};
+
+		int fd;
+		char input[4096];
+		char output[4096];
+
+	};
+
+#endif
+
+	// =========================================================================
+	// Constructs a NormalizationServer and starts its worker threads.
+	// =========================================================================
+	NormalizationServer::NormalizationServer(NormalForm _normal_form,
+		unsigned int num_workers, unsigned int _max_threads,
+		std::size_t _cache_capacity)
+		: cache_capacity(_cache_capacity), max_threads(_max_threads),
+		normal_form(_normal_form), stopping(false) {
+
+		if (normal_form != NormalForm::Two && normal_form != NormalForm::Four)
+			throw std::invalid_argument("The server can only normalize to 2NF or 4NF!");
+
+		if (num_workers == 0)
+			num_workers = std::thread::hardware_concurrency();
+
+		if (num_workers == 0)
+			num_workers = 1;
+
+		for (unsigned int t = 0; t < num_workers; t++)
+			workers.push_back(std::thread(&NormalizationServer::Work, this));
+
+	}
+
+	// =========================================================================
+	// Finishes queued requests and joins the worker threads.
+	// =========================================================================
+	NormalizationServer::~NormalizationServer() {
+
+		{
+			std::lock_guard<std::mutex> lock(tasks_mutex);
+			stopping = true;
+		}
+
+		tasks_cv.notify_all();
+
+		for (std::thread & worker : workers)
+			worker.join();
+
+	}
+
+	// =========================================================================
+	// Normalizes the schema of a request, or looks its response up in the
+	// cache.
+	//
+	// "request":
+	//		Text of the request.
+	//
+	// "cache_hit":
+	//		Set to true if the response was cached.
+	//
+	// Returns the printed, normalized Database.
+	// =========================================================================
+	std::string NormalizationServer::NormalizeRequest(const std::string &
+		request, bool & cache_hit) {
+
+		if (cache_capacity != 0) {
+
+			std::lock_guard<std::mutex> lock(cache_mutex);
+			auto entry = cache_index.find(request);
+
+			if (entry != cache_index.end()) {
+				cache.splice(cache.begin(), cache, entry->second);
+				cache_hit = true;
+				return entry->second->second;
+			}
+
+		}
+
+		std::istringstream stream(request);
+		TxtParser parser;
+		Database db = parser.Parse(stream);
+
+		if (normal_form == NormalForm::Two)
+			db.NormalizeTo2nf(max_threads);
+		else
+			db.NormalizeTo4nf(max_threads);
+
+		std::ostringstream response;
+		db.Print(response);
+
+		std::string body = response.str();
+
+		if (body.empty() || body.back() != '\n')
+			body += "\n";
+
+		if (cache_capacity != 0) {
+
+			std::lock_guard<std::mutex> lock(cache_mutex);
+
+			if (cache_index.find(request) == cache_index.end()) {
+
+				cache.emplace_front(request, body);
+				cache_index[request] = cache.begin();
+
+				if (cache.size() > cache_capacity) {
+					cache_index.erase(cache.back().first);
+					cache.pop_back();
+				}
+
+			}
+
+		}
+
+		return body;
+
+	}
+
+	// =========================================================================
+	// Prints the server's counters.
+	// =========================================================================
+	void NormalizationServer::PrintStats(std::ostream & stream) {
+
+		ServerStats current = Stats();
+		std::uint64_t mean_latency_us = current.requests == 0 ? 0
+			: current.total_latency_us / current.requests;
+
+		stream << "Requests: " << current.requests
+			<< "\nCache hits: " << current.cache_hits
+			<< "\nErrors: " << current.errors
+			<< "\nMean latency (us): " << mean_latency_us
+			<< "\nMax latency (us): " << current.max_latency_us << "\n";
+
+	}
+
+	// =========================================================================
+	// Answers one request. Called by a worker thread.
+	//
+	// "id":
+	//		Number of the request within its session.
+	//
+	// "request":
+	//		Text of the request.
+	//
+	// "received":
+	//		Time at which the request was read.
+	//
+	// Returns the complete response, including its header and terminator.
+	// =========================================================================
+	std::string NormalizationServer::Respond(std::uint64_t id,
+		const std::string & request, Clock::time_point received) {
+
+		bool cache_hit = false;
+		bool failed = false;
+		std::string body;
+
+		try {
+			body = NormalizeRequest(request, cache_hit);
+		}
+		catch (const std::exception & e) {
+			body = std::string("#error ") + e.what() + "\n";
+			failed = true;
+		}
+
+		std::uint64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+			Clock::now() - received).count();
+
+		{
+
+			std::lock_guard<std::mutex> lock(stats_mutex);
+
+			stats.requests++;
+			stats.cache_hits += cache_hit ? 1 : 0;
+			stats.errors += failed ? 1 : 0;
+			stats.total_latency_us += latency_us;
+
+			if (latency_us > stats.max_latency_us)
+				stats.max_latency_us = latency_us;
+
+		}
+
+		return "#response " + std::to_string(id) + " latency_us="
+			+ std::to_string(latency_us) + " cache=" + (cache_hit ? "hit" : "miss")
+			+ "\n" + body + ".\n";
+
+	}
+
+	// =========================================================================
+	// Serves one session. The calling thread reads and submits requests
+	// while a writer thread writes their responses in request order.
+	// =========================================================================
+	bool NormalizationServer::Serve(std::istream & in, std::ostream & out) {
+
+		std::deque<std::future<std::string>> pending;
+		std::mutex pending_mutex;
+		std::condition_variable pending_cv;
+		bool reading = true;
+
+		std::thread writer([&]() {
+
+			std::unique_lock<std::mutex> lock(pending_mutex);
+
+			while (true) {
+
+				pending_cv.wait(lock, [&]() { return !pending.empty() || !reading; });
+
+				if (pending.empty())
+					break;
+
+				std::future<std::string> response = std::move(pending.front());
+				pending.pop_front();
+				lock.unlock();
+
+				out << response.get() << std::flush;
+
+				lock.lock();
+
+			}
+
+		});
+
+		auto enqueue = [&](std::future<std::string> response) {
+
+			{
+				std::lock_guard<std::mutex> lock(pending_mutex);
+				pending.push_back(std::move(response));
+			}
+
+			pending_cv.notify_one();
+
+		};
+
+		std::uint64_t next_id = 1;
+		std::string request;
+		std::string line;
+		bool shutdown = false;
+
+		while (std::getline(in, line)) {
+
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+
+			if (line == ".") {
+
+				std::uint64_t id = next_id++;
+				Clock::time_point received = Clock::now();
+
+				enqueue(Submit([this, id, request, received]() {
+					return Respond(id, request, received);
+				}));
+
+				request.clear();
+
+			}
+			else if (line == ".stats") {
+
+				// Deferred, so the counters include every earlier request
+				// of the session by the time the writer gets to it.
+				enqueue(std::async(std::launch::deferred, [this]() {
+					std::ostringstream response;
+					response << "#stats\n";
+					PrintStats(response);
+					return response.str() + ".\n";
+				}));
+
+			}
+			else if (line == ".shutdown") {
+				shutdown = true;
+				break;
+			}
+			else {
+				request += line + "\n";
+			}
+
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(pending_mutex);
+			reading = false;
+		}
+
+		pending_cv.notify_one();
+		writer.join();
+
+		return shutdown;
+
+	}
+
+	// =========================================================================
+	// Listens on a Unix domain socket and serves every connection on its
+	// own detached thread. Returns once a session asks to shut down and
+	// every open session has ended.
+	// =========================================================================
+	void NormalizationServer::ServeSocket(const std::string & path) {
+
+#ifdef _WIN32
+
+		throw std::runtime_error("Unix domain sockets are not supported on this platform!");
+
+#else
+
+		sockaddr_un address;
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+
+		if (path.size() >= sizeof(address.sun_path))
+			throw std::runtime_error("Socket path '" + path + "' is too long!");
+
+		std::memcpy(address.sun_path, path.c_str(), path.size());
+
+		int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+		if (listen_fd < 0)
+			throw std::runtime_error("Could not create socket '" + path + "'!");
+
+		::unlink(path.c_str());
+
+		if (::bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0
+			|| ::listen(listen_fd, SOMAXCONN) < 0) {
+
+			::close(listen_fd);
+			throw std::runtime_error("Could not listen on socket '" + path + "'!");
+
+		}
+
+		std::atomic<bool> shutdown(false);
+		std::size_t live_sessions = 0;
+		std::condition_variable sessions_cv;
+		std::mutex sessions_mutex;
+
+		while (!shutdown) {
+
+			int fd = ::accept(listen_fd, nullptr, nullptr);
+
+			if (fd < 0 && errno == EINTR)
+				continue;
+
+			if (fd < 0)
+				break;
+
+			{
+				std::lock_guard<std::mutex> lock(sessions_mutex);
+				live_sessions++;
+			}
+
+			// Sessions are detached so that a finished one releases its
+			// thread at once; the count lets the server wait for the rest.
+			std::thread([this, fd, listen_fd, &shutdown, &live_sessions,
+				&sessions_cv, &sessions_mutex]() {
+
+				{
+
+					SocketStreamBuf buffer(fd);
+					std::istream in(&buffer);
+					std::ostream out(&buffer);
+
+					if (Serve(in, out)) {
+
+						// Wakes the accept() above.
+						shutdown = true;
+						::shutdown(listen_fd, SHUT_RDWR);
+
+					}
+
+				}
+
+				::close(fd);
+
+				// Notified under the lock, so the server cannot return and
+				// destroy the condition variable before this thread is done
+				// with it.
+				std::lock_guard<std::mutex> lock(sessions_mutex);
+				live_sessions--;
+				sessions_cv.notify_all();
+
+			}).detach();
+
+		}
+
+		// Open sessions end when their peers disconnect.
+		{
+			std::unique_lock<std::mutex> lock(sessions_mutex);
+			sessions_cv.wait(lock, [&]() { return live_sessions == 0; });
+		}
+
+		::close(listen_fd);
+		::unlink(path.c_str());
+
+#endif
+
+	}
+
+	// =========================================================================
+	// Returns the server's counters.
+	// =========================================================================
+	ServerStats NormalizationServer::Stats() {
+
+		std::lock_guard<std::mutex> lock(stats_mutex);
+
+		return stats;
+
+	}
+
+	// =========================================================================
+	// Queues a task for the worker threads.
+	//
+	// "task":
+	//		Task to run.
+	//
+	// Returns the future result of "task".
+	// =========================================================================
+	std::future<std::string> NormalizationServer::Submit(
+		std::function<std::string()> task) {
+
+		std::shared_ptr<std::packaged_task<std::string()>> packaged =
+			std::make_shared<std::packaged_task<std::string()>>(std::move(task));
+		std::future<std::string> result = packaged->get_future();
+
+		{
+			std::lock_guard<std::mutex> lock(tasks_mutex);
+			tasks.push_back([packaged]() { (*packaged)(); });
+		}
+
+		tasks_cv.notify_one();
+
+		return result;
+
+	}
+
+	// =========================================================================
+	// Runs queued tasks until the server stops and no task is left. Run by
+	// every worker thread.
+	// =========================================================================
+	void NormalizationServer::Work() {
+
+		while (true) {
+
+			std::function<void()> task;
+
+			{
+
+				std::unique_lock<std::mutex> lock(tasks_mutex);
+				tasks_cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+				if (tasks.empty())
+					return;
+
+				task = std::move(tasks.front());
+				tasks.pop_front();
+
+			}
+
+			task();
+
+		}
+
+	}
+
+}
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <atomic>
+
+#include "snapshot.h"
+
+namespace DbNormalizerCpp {
+
+	namespace {
+
+		// =====================================================================
+		// Returns true if two attribute tables are equal.
+		// =====================================================================
+		bool SameAttributeTable(const AttributeTable & a, const AttributeTable & b) {
+
+			if (a.size() != b.size())
+				return false;
+
+			for (std::size_t i = 0; i < a.size(); i++) {
+
+				if (a[i].name != b[i].name || a[i].type != b[i].type || a[i].prime != b[i].prime)
+					return false;
+
+			}
+
+			return true;
+
+		}
+
+		// =====================================================================
+		// Returns true if two relation tables are equal.
+		// =====================================================================
+		bool SameRelationTable(const RelationTable & a, const RelationTable & b) {
+
+			if (a.size() != b.size())
+				return false;
+
+			for (std::size_t i = 0; i < a.size(); i++) {
+
+				if (a[i].name != b[i].name || !(a[i].attributes == b[i].attributes)
+					|| !(a[i].primary_key == b[i].primary_key)
+					|| a[i].candidate_keys != b[i].candidate_keys
+					|| a[i].closure != b[i].closure)
+					return false;
+
+			}
+
+			return true;
+
+		}
+
+	}
+
+	// =========================================================================
+	// Computes the closure of a set of attributes with respect to the
+	// functional dependency table, on packed sets.
+	// =========================================================================
+	AttributeSet DatabaseSnapshot::ComputeClosureOf(const AttributeSet &
+		attributes) const {
+
+		PackedAttributeSet closure = PackAttributes(attributes,
+			(attribute_table->size() + 63) / 64);
+		std::vector<char> fired(num_func_deps, 0);
+		bool new_insertion;
+
+		do {
+
+			new_insertion = false;
+
+			for (std::size_t c = 0; c < func_dep_chunks.size(); c++) {
+
+				const FuncDepChunk & chunk = *func_dep_chunks[c];
+
+				// A chunk's sets only have the words of the attributes that
+				// existed when it was made, which Fire() allows.
+				for (std::size_t i = 0; i < chunk.packed.GetNumFuncDeps(); i++) {
+
+					std::size_t index = c * SnapshotPublisher::FUNC_DEP_CHUNK_SIZE + i;
+
+					if (!fired[index])
+						fired[index] = chunk.packed.Fire(i, closure, new_insertion);
+
+				}
+
+			}
+
+		} while (new_insertion);
+
+		return UnpackAttributes(closure);
+
+	}
+
+	// =========================================================================
+	// Returns a functional dependency.
+	// =========================================================================
+	const FuncDep & DatabaseSnapshot::GetFuncDep(FuncDepTblIndex fd_tbl_index) const {
+
+		return func_dep_chunks[fd_tbl_index / SnapshotPublisher::FUNC_DEP_CHUNK_SIZE]
+			->func_deps[fd_tbl_index % SnapshotPublisher::FUNC_DEP_CHUNK_SIZE];
+
+	}
+
+	// =========================================================================
+	// Constructs a SnapshotPublisher and publishes the first snapshot.
+	// =========================================================================
+	SnapshotPublisher::SnapshotPublisher(const Database & _db)
+		: chunks_copied(0), db(_db) {
+
+		Publish();
+
+	}
+
+	// =========================================================================
+	// Returns the latest snapshot.
+	// =========================================================================
+	DatabaseSnapshotPtr SnapshotPublisher::Current() const {
+
+		return std::atomic_load(&current);
+
+	}
+
+	// =========================================================================
+	// Copies functional dependencies of the Database into a new chunk.
+	//
+	// "first":
+	//		Index of the first functional dependency of the chunk.
+	//
+	// "last":
+	//		Index one past the last functional dependency of the chunk.
+	// =========================================================================
+	std::shared_ptr<const FuncDepChunk> SnapshotPublisher::MakeChunk(
+		std::size_t first, std::size_t last) {
+
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+		std::shared_ptr<FuncDepChunk> chunk = std::make_shared<FuncDepChunk>();
+
+		chunk->func_deps.assign(func_dep_table.begin() + first, func_dep_table.begin() + last);
+		chunk->packed = PackedFuncDepTable(chunk->func_deps, db.GetAttributeTable().size());
+
+		chunks_copied++;
+
+		return chunk;
+
+	}
+
+	// =========================================================================
+	// Publishes a snapshot of the Database's current state, sharing every
+	// table and chunk that did not change since the last snapshot.
+	// =========================================================================
+	DatabaseSnapshotPtr SnapshotPublisher::Publish() {
+
+		// Only the writer replaces "current", so it can be read plainly.
+		const DatabaseSnapshot * last = current.get();
+		std::shared_ptr<DatabaseSnapshot> next = std::make_shared<DatabaseSnapshot>();
+		const FuncDepTable & func_dep_table = db.GetFuncDepTable();
+
+		chunks_copied = 0;
+		next->version = last ? last->version + 1 : 1;
+
+		if (last && *last->name == db.GetName())
+			next->name = last->name;
+		else
+			next->name = std::make_shared<const std::string>(db.GetName());
+
+		if (last && SameAttributeTable(*last->attribute_table, db.GetAttributeTable()))
+			next->attribute_table = last->attribute_table;
+		else
+			next->attribute_table = std::make_shared<const AttributeTable>(db.GetAttributeTable());
+
+		for (std::size_t first = 0; first < func_dep_table.size(); first += FUNC_DEP_CHUNK_SIZE) {
+
+			std::size_t chunk_index = first / FUNC_DEP_CHUNK_SIZE;
+			std::size_t last_index = std::min(first + FUNC_DEP_CHUNK_SIZE, func_dep_table.size());
+			bool same = last && chunk_index < last->func_dep_chunks.size()
+				&& last->func_dep_chunks[chunk_index]->func_deps.size() == last_index - first;
+
+			for (std::size_t i = first; same && i < last_index; i++)
+				same = last->func_dep_chunks[chunk_index]->func_deps[i - first] == func_dep_table[i];
+
+			if (same)
+				next->func_dep_chunks.push_back(last->func_dep_chunks[chunk_index]);
+			else
+				next->func_dep_chunks.push_back(MakeChunk(first, last_index));
+
+		}
+
+		next->num_func_deps = func_dep_table.size();
+
+		if (last && SameRelationTable(*last->relation_table, db.GetRelationTable()))
+			next->relation_table = last->relation_table;
+		else
+			next->relation_table = std::make_shared<const RelationTable>(db.GetRelationTable());
+
+		DatabaseSnapshotPtr published = next;
+		std::atomic_store(&current, published);
+
+		return published;
+
+	}
+
+}
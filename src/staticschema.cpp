@@ -0,0 +1,51 @@
+#include <array>
+#include <string_view>
+
+#include "staticschema.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// StaticSchema is header-only, so this translation unit normalizes
+	// sample schemas at compile time. The build fails if the constexpr path
+	// breaks or stops producing the expected relation tables.
+	// =========================================================================
+	namespace {
+
+		// emp_proj.txt: ssn,pnumber -> hrs is the key dependency and the
+		// other two are partial dependencies, so 2NF splits off r1 and r2.
+		constexpr std::array<std::string_view, 6> emp_proj_attributes{
+			"ssn", "name", "pnumber", "pname", "ploc", "hrs" };
+		constexpr std::array<std::string_view, 3> emp_proj_func_deps{
+			"ssn->name", "pnumber->pname,ploc", "ssn,pnumber->hrs" };
+		constexpr auto emp_proj = StaticSchema(emp_proj_attributes,
+			emp_proj_func_deps).NormalizeTo2nf();
+
+		static_assert(emp_proj.GetNumRelations() == 3);
+		static_assert(emp_proj.IsIn2nf());
+		static_assert(emp_proj.IsIn3nf());
+		static_assert(emp_proj.GetAttributeSet("ssn,pnumber") 
+			== emp_proj.GetRelation(0).primary_key
+			|| emp_proj.GetAttributeSet("ssn,pnumber") 
+			== emp_proj.GetRelation(1).primary_key
+			|| emp_proj.GetAttributeSet("ssn,pnumber") 
+			== emp_proj.GetRelation(2).primary_key);
+
+		// emp -> dept -> dept_name is transitive: the single-attribute key
+		// leaves no partial dependency, so the relation is in 2NF but not
+		// in 3NF.
+		constexpr std::array<std::string_view, 3> emp_dept_attributes{
+			"emp", "dept", "dept_name" };
+		constexpr std::array<std::string_view, 2> emp_dept_func_deps{
+			"emp->dept", "dept->dept_name" };
+		constexpr auto emp_dept = StaticSchema(emp_dept_attributes,
+			emp_dept_func_deps).NormalizeTo2nf();
+
+		static_assert(emp_dept.GetNumRelations() == 1);
+		static_assert(emp_dept.IsIn2nf());
+		static_assert(!emp_dept.IsIn3nf());
+		static_assert(!emp_dept.IsInBcnf());
+
+	}
+
+}
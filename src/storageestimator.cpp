@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "storageestimator.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a StorageEstimator with one global row and no distinct
+	// counts.
+	// =========================================================================
+	StorageEstimator::StorageEstimator(const Database & _db, StorageModel _model)
+		: db(_db), distinct(_db.GetAttributeTable().size(), 0.0),
+		global_rows(1.0), model(_model) {}
+
+	// =========================================================================
+	// Returns the bytes a value of an attribute takes.
+	//
+	// "attr":
+	//		Index of the attribute in the attribute table.
+	// =========================================================================
+	double StorageEstimator::AttributeBytes(AttributeTblIndex attr) {
+
+		switch (db.GetAttributeTable()[attr].type) {
+		case Int:
+			return model.int_bytes;
+		case Float:
+			return model.float_bytes;
+		default:
+			return model.string_bytes;
+		}
+
+	}
+
+	// =========================================================================
+	// Estimates the storage of the global relation and of every relation in
+	// the relation table.
+	// =========================================================================
+	StorageReport StorageEstimator::Estimate() {
+
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+		const RelationTable & relation_table = db.GetRelationTable();
+		StorageReport report;
+
+		report.global.name = db.GetName();
+		report.global.rows = global_rows;
+		report.global.row_bytes = model.row_overhead_bytes;
+
+		for (AttributeTblIndex attr = 0; attr < attribute_table.size(); attr++)
+			report.global.row_bytes += AttributeBytes(attr);
+
+		report.global.total_bytes = report.global.rows * report.global.row_bytes;
+
+		// Number of relations every attribute appears in.
+		std::vector<std::size_t> occurrences(attribute_table.size(), 0);
+
+		for (const Relation & relation : relation_table) {
+
+			for (AttributeTblIndex attr : relation.attributes)
+				occurrences[attr]++;
+
+		}
+
+		for (const Relation & relation : relation_table) {
+
+			RelationStorage storage;
+			double join_row_bytes = 0.0;
+
+			storage.name = relation.name;
+			storage.rows = EstimateRows(relation);
+			storage.row_bytes = model.row_overhead_bytes;
+
+			for (AttributeTblIndex attr : relation.attributes) {
+
+				storage.row_bytes += AttributeBytes(attr);
+
+				if (occurrences[attr] > 1)
+					join_row_bytes += AttributeBytes(attr);
+
+			}
+
+			storage.total_bytes = storage.rows * storage.row_bytes;
+			storage.join_column_bytes = storage.rows * join_row_bytes;
+
+			report.normalized_bytes += storage.total_bytes;
+			report.join_column_bytes += storage.join_column_bytes;
+			report.relations.push_back(storage);
+
+		}
+
+		report.saved_bytes = report.global.total_bytes - report.normalized_bytes;
+		report.joins = relation_table.empty() ? 0 : relation_table.size() - 1;
+
+		return report;
+
+	}
+
+	// =========================================================================
+	// Estimates the rows of a relation.
+	// =========================================================================
+	double StorageEstimator::EstimateRows(const Relation & relation) const {
+
+		auto given = relation_rows.find(relation.name);
+
+		if (given != relation_rows.end())
+			return given->second;
+
+		if (relation.primary_key.empty())
+			return global_rows;
+
+		double key_values = 1.0;
+
+		for (AttributeTblIndex attr : relation.primary_key) {
+
+			if (distinct[attr] <= 0.0)
+				return global_rows;
+
+			key_values *= distinct[attr];
+
+		}
+
+		return std::min(key_values, global_rows);
+
+	}
+
+	// =========================================================================
+	// Reads a statistics file.
+	// =========================================================================
+	void StorageEstimator::LoadStatistics(const std::string & path) {
+
+		std::ifstream stream(path);
+
+		if (!stream)
+			throw std::runtime_error("Could not open statistics file '" + path + "'!");
+
+		ReadStatistics(stream);
+
+	}
+
+	// =========================================================================
+	// Prints a report.
+	// =========================================================================
+	void StorageEstimator::Print(const StorageReport & report) {
+
+		// Rows and bytes are printed whole, never in scientific notation.
+		auto whole = [](double value) {
+
+			std::ostringstream text;
+			text << std::fixed << std::setprecision(0) << value;
+
+			return text.str();
+
+		};
+
+		auto print_relation = [&](const RelationStorage & storage) {
+
+			std::cout << storage.name << ": " << whole(storage.rows) << " rows x "
+				<< whole(storage.row_bytes) << " bytes = " << whole(storage.total_bytes)
+				<< " bytes\n";
+
+		};
+
+		double ratio = report.global.total_bytes == 0.0 ? 1.0
+			: report.normalized_bytes / report.global.total_bytes;
+		std::ostringstream percent;
+
+		percent << std::fixed << std::setprecision(1) << ratio * 100;
+
+		std::cout << "Storage Estimate:\n\nGlobal relation:\n";
+		print_relation(report.global);
+
+		std::cout << "\nRelations:\n";
+
+		for (const RelationStorage & storage : report.relations)
+			print_relation(storage);
+
+		std::cout << "\nNormalized bytes: " << whole(report.normalized_bytes) << " ("
+			<< percent.str() << "% of global)\n"
+			<< "Saved bytes: " << whole(report.saved_bytes) << "\n"
+			<< "Join column bytes: " << whole(report.join_column_bytes) << "\n"
+			<< "Joins to reassemble: " << report.joins << "\n";
+
+	}
+
+	// =========================================================================
+	// Reads statistics.
+	// =========================================================================
+	void StorageEstimator::ReadStatistics(std::istream & stream) {
+
+		std::string line;
+
+		while (std::getline(stream, line)) {
+
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::istringstream fields(line);
+			std::string kind;
+			std::string name;
+			double count;
+
+			bool valid = static_cast<bool>(fields >> kind);
+
+			if (valid && kind != "rows")
+				valid = static_cast<bool>(fields >> name);
+
+			valid = valid && (fields >> count) && count >= 0;
+
+			if (valid && kind == "rows")
+				SetRows(count);
+			else if (valid && kind == "distinct")
+				SetDistinct(name, count);
+			else if (valid && kind == "relation")
+				SetRelationRows(name, count);
+			else if (valid && kind == "bytes" && name == "int")
+				model.int_bytes = count;
+			else if (valid && kind == "bytes" && name == "float")
+				model.float_bytes = count;
+			else if (valid && kind == "bytes" && name == "string")
+				model.string_bytes = count;
+			else if (valid && kind == "bytes" && name == "row")
+				model.row_overhead_bytes = count;
+			else
+				throw std::invalid_argument("Malformed statistics line '" + line + "'!");
+
+		}
+
+	}
+
+	// =========================================================================
+	// Sets the number of distinct values of an attribute.
+	// =========================================================================
+	void StorageEstimator::SetDistinct(const std::string & attr_name,
+		double _distinct) {
+
+		const AttributeTable & attribute_table = db.GetAttributeTable();
+
+		for (AttributeTblIndex attr = 0; attr < attribute_table.size(); attr++) {
+
+			if (attribute_table[attr].name == attr_name) {
+				distinct[attr] = _distinct;
+				return;
+			}
+
+		}
+
+		throw std::invalid_argument("Unknown attribute '" + attr_name + "'!");
+
+	}
+
+	// =========================================================================
+	// Sets the number of rows of a relation of the relation table.
+	// =========================================================================
+	void StorageEstimator::SetRelationRows(const std::string & relation_name,
+		double rows) {
+
+		relation_rows[relation_name] = rows;
+
+	}
+
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "tracer.h"
+
+namespace DbNormalizerCpp {
+
+	// =========================================================================
+	// Constructs a Tracer. Event times are relative to its construction, and
+	// the constructing thread is thread 1, named "main".
+	// =========================================================================
+	Tracer::Tracer() : start(std::chrono::steady_clock::now()) {
+
+		ThreadId();
+
+	}
+
+	// =========================================================================
+	// Records an event that spans an interval.
+	// =========================================================================
+	void Tracer::Complete(const char * name, const char * category,
+		std::int64_t start_us, const char * arg_name, std::int64_t arg_value) {
+
+		std::int64_t end_us = NowMicros();
+
+		Record(TraceEvent{ name, category, 'X', start_us, end_us - start_us, 0,
+			arg_name, arg_value });
+
+	}
+
+	// =========================================================================
+	// Records an event that happens at one point in time.
+	// =========================================================================
+	void Tracer::Instant(const char * name, const char * category,
+		const char * arg_name, std::int64_t arg_value) {
+
+		Record(TraceEvent{ name, category, 'i', NowMicros(), 0, 0, arg_name,
+			arg_value });
+
+	}
+
+	// =========================================================================
+	// Returns the microseconds elapsed since the Tracer was constructed.
+	// =========================================================================
+	std::int64_t Tracer::NowMicros() const {
+
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start).count();
+
+	}
+
+	// =========================================================================
+	// Records an event for the calling thread.
+	// =========================================================================
+	void Tracer::Record(TraceEvent event) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		event.thread_id = ThreadIdLocked();
+		events.push_back(event);
+
+	}
+
+	// =========================================================================
+	// Returns the trace id of the calling thread.
+	// =========================================================================
+	std::uint32_t Tracer::ThreadId() {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		return ThreadIdLocked();
+
+	}
+
+	// =========================================================================
+	// Returns the trace id of the calling thread, assigning one if needed.
+	//
+	// Precondition: "mutex" is held.
+	// =========================================================================
+	std::uint32_t Tracer::ThreadIdLocked() {
+
+		std::uint32_t next_id = static_cast<std::uint32_t>(thread_ids.size() + 1);
+
+		return thread_ids.insert(std::make_pair(std::this_thread::get_id(),
+			next_id)).first->second;
+
+	}
+
+	// =========================================================================
+	// Writes every recorded event as Chrome trace-event JSON. Events are
+	// sorted by start time, and every thread is named after its trace id.
+	// =========================================================================
+	void Tracer::Write(std::ostream & stream) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<TraceEvent> sorted = events;
+		std::vector<std::uint32_t> ids;
+
+		std::stable_sort(sorted.begin(), sorted.end(),
+			[](const TraceEvent & a, const TraceEvent & b) {
+			return a.start_us < b.start_us;
+		});
+
+		for (const std::pair<const std::thread::id, std::uint32_t> & entry : thread_ids)
+			ids.push_back(entry.second);
+
+		std::sort(ids.begin(), ids.end());
+
+		stream << "{\"traceEvents\":[\n";
+
+		bool first = true;
+
+		for (std::uint32_t id : ids) {
+
+			stream << (first ? "" : ",\n")
+				<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id
+				<< ",\"args\":{\"name\":\"" << (id == 1 ? "main" : "thread " + std::to_string(id))
+				<< "\"}}";
+			first = false;
+
+		}
+
+		for (const TraceEvent & event : sorted) {
+
+			stream << (first ? "" : ",\n")
+				<< "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+				<< "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.start_us;
+
+			if (event.phase == 'X')
+				stream << ",\"dur\":" << event.duration_us;
+			else
+				stream << ",\"s\":\"t\"";
+
+			stream << ",\"pid\":1,\"tid\":" << event.thread_id;
+
+			if (event.arg_name)
+				stream << ",\"args\":{\"" << event.arg_name << "\":" << event.arg_value << "}";
+
+			stream << "}";
+			first = false;
+
+		}
+
+		stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	}
+
+	// =========================================================================
+	// Writes every recorded event as Chrome trace-event JSON to a file.
+	// =========================================================================
+	void Tracer::Write(const std::string & path) {
+
+		std::ofstream stream(path);
+
+		if (!stream)
+			throw std::runtime_error("Could not open trace file '" + path + "'!");
+
+		Write(stream);
+
+		if (!stream)
+			throw std::runtime_error("Could not write trace file '" + path + "'!");
+
+	}
+
+}
@@ -38,6 +38,43 @@ namespace DbNormalizerCpp {
 		db.SetName(line);
 	}
 	
+	// =========================================================================
+	// Processes one attribute of an AttrSet, written as "name" or as
+	// "name:type" with type "int", "float", or "string". Untyped attributes
+	// are strings.
+	//
+	// "db":
+	//		Database to insert the attribute into.
+	//
+	// "token":
+	//		Raw string that contains the attribute.
+	// =========================================================================
+	void TxtParser::ProcessAttr(Database &db, const std::string &token) {
+
+		std::size_t colon = token.find(':');
+
+		if (colon == std::string::npos) {
+			db.InsertAttribute(token);
+			return;
+		}
+
+		std::string type_name = token.substr(colon + 1);
+		AttributeType type;
+
+		if (type_name == "int")
+			type = Int;
+		else if (type_name == "float")
+			type = Float;
+		else if (type_name == "string")
+			type = String;
+		else
+			throw std::runtime_error("Unknown type '" + type_name + "' of attribute '" 
+				+ token.substr(0, colon) + "'!");
+
+		db.InsertAttribute(token.substr(0, colon), type);
+
+	}
+
 	// =========================================================================
 	// Processes an AttrSet.
 	//
@@ -54,7 +91,7 @@ namespace DbNormalizerCpp {
 		for (char token : line) {
 
 			if (token == ',') {
-				db.InsertAttribute(attr_name);
+				ProcessAttr(db, attr_name);
 				attr_name.clear();
 			}
 			else {
@@ -63,7 +100,10 @@ namespace DbNormalizerCpp {
 		}
 
 		try {
-			db.InsertAttribute(attr_name);
+			ProcessAttr(db, attr_name);
+		}
+		catch (const std::runtime_error &) {
+			throw;
 		}
 		catch (std::exception) {
 			throw std::runtime_error(std::string("Could not add last attribute in universal attribute set!"));
@@ -73,7 +113,8 @@ namespace DbNormalizerCpp {
 	}
 	
 	// =========================================================================
-	// Processes a FuncDep.
+	// Processes a FuncDep, e.g., 'A,B->C', or a multivalued dependency, e.g.,
+	// 'A->>B,C'.
 	//
 	// "db":
 	//		Database to process the functional dependency for.
@@ -84,6 +125,7 @@ namespace DbNormalizerCpp {
 	// =========================================================================
 	void TxtParser::ProcessFuncDep(Database &db, const std::string &line) {
 
+		bool multivalued = false;
 		bool processing_left = true;
 		SimpleFuncDep func_dep;
 		std::string attr_name;
@@ -99,12 +141,10 @@ namespace DbNormalizerCpp {
 				char next_token;
 				it++;
 
-				try {
-					next_token = *it;
-				}
-				catch (std::exception) {
+				if (it == line.end())
 					throw std::runtime_error("Expected '>' but reached end of line!");
-				}
+
+				next_token = *it;
 
 				if (next_token == '>') {
 					// Add attribute to left side of func_dep.
@@ -112,6 +152,12 @@ namespace DbNormalizerCpp {
 					AddAttributeNameToFuncDep(func_dep, attr_name);
 					attr_name.clear();
 					processing_left = false;
+
+					if (std::next(it) != line.end() && *std::next(it) == '>') {
+						// '->>' denotes a multivalued dependency.
+						it++;
+						multivalued = true;
+					}
 				}
 				else {
 					throw std::runtime_error(std::string("Expected '>' but got '") + next_token + "'!");
@@ -130,7 +176,10 @@ namespace DbNormalizerCpp {
 			throw std::runtime_error(std::string("Could not add last attribute to functional dependency!"));
 		}
 
-		db.InsertFuncDep(func_dep);
+		if (multivalued)
+			db.InsertMultiValuedDep(func_dep);
+		else
+			db.InsertFuncDep(func_dep);
 
 	}
 